@@ -133,6 +133,22 @@ extern "C" {
 #define LPC_SPI_BASE              0x40100000
 #define LPC_SGPIO_BASE            0x40101000
 
+#if defined(HOST_BUILD)
+/* Host builds route every peripheral block into a RAM image of the
+   0x40000000 - 0x40101FFF APB/AHB window, defined in Sources/host */
+#define LPC_PERIPH_WINDOW_BASE    0x40000000
+#define LPC_PERIPH_WINDOW_SIZE    0x00102000
+extern uint32_t Host_PeriphRegs[LPC_PERIPH_WINDOW_SIZE / sizeof(uint32_t)];
+#define LPC_PERIPH_ADDR(base)     ((uintptr_t) Host_PeriphRegs + ((base) - LPC_PERIPH_WINDOW_BASE))
+void Host_ResetPeriphRegs(void);
+/* Behaviour model of the GPDMA and SSPs, see Sources/host/host_model.c */
+void Host_ResetModel(void);
+void Host_Tick(uint32_t cycles);
+uint64_t Host_Cycles(void);
+#else
+#define LPC_PERIPH_ADDR(base)     (base)
+#endif
+
 /* Normalize types */
 typedef IP_SCT_001_T LPC_SCT_T;
 typedef IP_GPDMA_001_T LPC_GPDMA_T;
@@ -163,55 +179,55 @@ typedef IP_SPI_001_T LPC_SPI_T;
 typedef IP_SGPIO_001_T LPC_SGPIO_T;
 typedef IP_LCD_001_T LPC_LCD_T;
 
-#define LPC_SCT                   ((IP_SCT_001_T              *) LPC_SCT_BASE)
-#define LPC_GPDMA                 ((IP_GPDMA_001_T            *) LPC_GPDMA_BASE)
-#define LPC_SDMMC                 ((IP_SDMMC_001_T            *) LPC_SDMMC_BASE)
-#define LPC_EMC                   ((IP_EMC_001_T              *) LPC_EMC_BASE)
-#define LPC_USB0                  ((IP_USBHS_001_T            *) LPC_USB0_BASE)
-#define LPC_USB1                  ((IP_USBHS_001_T            *) LPC_USB1_BASE)
-#define LPC_LCD                   ((IP_LCD_001_T              *) LPC_LCD_BASE)
-#define LPC_ETHERNET              ((IP_ENET_001_T             *) LPC_ETHERNET_BASE)
-#define LPC_ATIMER                ((IP_ATIMER_001_T           *) LPC_ATIMER_BASE)
-#define LPC_REGFILE               ((IP_REGFILE_001_T             *) LPC_REGFILE_BASE)
-#define LPC_PMC                   ((IP_PMC_001_T              *) LPC_PMC_BASE)
-#define LPC_EVRT                  ((LPC_EVRT_T                *) LPC_EVRT_BASE)
-#define LPC_RTC                   ((IP_RTC_001_T                 *) LPC_RTC_BASE)
-#define LPC_CGU                   ((LPC_CGU_T                    *) LPC_CGU_BASE)
-#define LPC_CCU1                  ((LPC_CCU1_T                *) LPC_CCU1_BASE)
-#define LPC_CCU2                  ((LPC_CCU2_T                *) LPC_CCU2_BASE)
-#define LPC_CREG                  ((LPC_CREG_T                   *) LPC_CREG_BASE)
-#define LPC_RGU                   ((LPC_RGU_T                    *) LPC_RGU_BASE)
-#define LPC_WWDT                  ((IP_WWDT_001_T             *) LPC_WWDT_BASE)
-#define LPC_USART0                ((IP_USART_001_T            *) LPC_USART0_BASE)
-#define LPC_USART2                ((IP_USART_001_T            *) LPC_USART2_BASE)
-#define LPC_USART3                ((IP_USART_001_T            *) LPC_USART3_BASE)
-#define LPC_UART1                 ((IP_USART_001_T            *) LPC_UART1_BASE)
-#define LPC_SSP0                  ((IP_SSP_001_T              *) LPC_SSP0_BASE)
-#define LPC_SSP1                  ((IP_SSP_001_T              *) LPC_SSP1_BASE)
-#define LPC_TIMER0                ((IP_TIMER_001_T            *) LPC_TIMER0_BASE)
-#define LPC_TIMER1                ((IP_TIMER_001_T            *) LPC_TIMER1_BASE)
-#define LPC_TIMER2                ((IP_TIMER_001_T            *) LPC_TIMER2_BASE)
-#define LPC_TIMER3                ((IP_TIMER_001_T            *) LPC_TIMER3_BASE)
-#define LPC_SCU                   ((LPC_SCU_T                 *) LPC_SCU_BASE)
-#define LPC_GPIO_PIN_INT          ((IP_GPIOPININT_001_T       *) LPC_GPIO_PIN_INT_BASE)
-#define LPC_GPIO_GROUP_INT0       ((IP_GPIOGROUPINT_001_T     *) LPC_GPIO_GROUP_INT0_BASE)
-#define LPC_GPIO_GROUP_INT1       ((IP_GPIOGROUPINT_001_T     *) LPC_GPIO_GROUP_INT1_BASE)
-#define LPC_MCPWM                 ((IP_MCPWM_001_T            *) LPC_MCPWM_BASE)
-#define LPC_I2C0                  ((IP_I2C_001_T              *) LPC_I2C0_BASE)
-#define LPC_I2C1                  ((IP_I2C_001_T              *) LPC_I2C1_BASE)
-#define LPC_I2S0                  ((IP_I2S_001_T              *) LPC_I2S0_BASE)
-#define LPC_I2S1                  ((IP_I2S_001_T              *) LPC_I2S1_BASE)
-#define LPC_C_CAN1                ((IP_CCAN_001_T             *) LPC_C_CAN1_BASE)
-#define LPC_RITIMER               ((IP_RITIMER_001_T          *) LPC_RITIMER_BASE)
-#define LPC_QEI                   ((IP_QEI_001_T              *) LPC_QEI_BASE)
-#define LPC_GIMA                  ((IP_GIMA_001_T             *) LPC_GIMA_BASE)
-#define LPC_DAC                   ((IP_DAC_001_T              *) LPC_DAC_BASE)
-#define LPC_C_CAN0                ((IP_CCAN_001_T             *) LPC_C_CAN0_BASE)
-#define LPC_ADC0                  ((IP_ADC_001_T              *) LPC_ADC0_BASE)
-#define LPC_ADC1                  ((IP_ADC_001_T              *) LPC_ADC1_BASE)
-#define LPC_GPIO_PORT             ((IP_GPIO_001_T             *) LPC_GPIO_PORT_BASE)
-#define LPC_SPI                   ((IP_SPI_001_T              *) LPC_SPI_BASE)
-#define LPC_SGPIO                 ((IP_SGPIO_001_T            *) LPC_SGPIO_BASE)
+#define LPC_SCT                   ((IP_SCT_001_T              *) LPC_PERIPH_ADDR(LPC_SCT_BASE))
+#define LPC_GPDMA                 ((IP_GPDMA_001_T            *) LPC_PERIPH_ADDR(LPC_GPDMA_BASE))
+#define LPC_SDMMC                 ((IP_SDMMC_001_T            *) LPC_PERIPH_ADDR(LPC_SDMMC_BASE))
+#define LPC_EMC                   ((IP_EMC_001_T              *) LPC_PERIPH_ADDR(LPC_EMC_BASE))
+#define LPC_USB0                  ((IP_USBHS_001_T            *) LPC_PERIPH_ADDR(LPC_USB0_BASE))
+#define LPC_USB1                  ((IP_USBHS_001_T            *) LPC_PERIPH_ADDR(LPC_USB1_BASE))
+#define LPC_LCD                   ((IP_LCD_001_T              *) LPC_PERIPH_ADDR(LPC_LCD_BASE))
+#define LPC_ETHERNET              ((IP_ENET_001_T             *) LPC_PERIPH_ADDR(LPC_ETHERNET_BASE))
+#define LPC_ATIMER                ((IP_ATIMER_001_T           *) LPC_PERIPH_ADDR(LPC_ATIMER_BASE))
+#define LPC_REGFILE               ((IP_REGFILE_001_T             *) LPC_PERIPH_ADDR(LPC_REGFILE_BASE))
+#define LPC_PMC                   ((IP_PMC_001_T              *) LPC_PERIPH_ADDR(LPC_PMC_BASE))
+#define LPC_EVRT                  ((LPC_EVRT_T                *) LPC_PERIPH_ADDR(LPC_EVRT_BASE))
+#define LPC_RTC                   ((IP_RTC_001_T                 *) LPC_PERIPH_ADDR(LPC_RTC_BASE))
+#define LPC_CGU                   ((LPC_CGU_T                    *) LPC_PERIPH_ADDR(LPC_CGU_BASE))
+#define LPC_CCU1                  ((LPC_CCU1_T                *) LPC_PERIPH_ADDR(LPC_CCU1_BASE))
+#define LPC_CCU2                  ((LPC_CCU2_T                *) LPC_PERIPH_ADDR(LPC_CCU2_BASE))
+#define LPC_CREG                  ((LPC_CREG_T                   *) LPC_PERIPH_ADDR(LPC_CREG_BASE))
+#define LPC_RGU                   ((LPC_RGU_T                    *) LPC_PERIPH_ADDR(LPC_RGU_BASE))
+#define LPC_WWDT                  ((IP_WWDT_001_T             *) LPC_PERIPH_ADDR(LPC_WWDT_BASE))
+#define LPC_USART0                ((IP_USART_001_T            *) LPC_PERIPH_ADDR(LPC_USART0_BASE))
+#define LPC_USART2                ((IP_USART_001_T            *) LPC_PERIPH_ADDR(LPC_USART2_BASE))
+#define LPC_USART3                ((IP_USART_001_T            *) LPC_PERIPH_ADDR(LPC_USART3_BASE))
+#define LPC_UART1                 ((IP_USART_001_T            *) LPC_PERIPH_ADDR(LPC_UART1_BASE))
+#define LPC_SSP0                  ((IP_SSP_001_T              *) LPC_PERIPH_ADDR(LPC_SSP0_BASE))
+#define LPC_SSP1                  ((IP_SSP_001_T              *) LPC_PERIPH_ADDR(LPC_SSP1_BASE))
+#define LPC_TIMER0                ((IP_TIMER_001_T            *) LPC_PERIPH_ADDR(LPC_TIMER0_BASE))
+#define LPC_TIMER1                ((IP_TIMER_001_T            *) LPC_PERIPH_ADDR(LPC_TIMER1_BASE))
+#define LPC_TIMER2                ((IP_TIMER_001_T            *) LPC_PERIPH_ADDR(LPC_TIMER2_BASE))
+#define LPC_TIMER3                ((IP_TIMER_001_T            *) LPC_PERIPH_ADDR(LPC_TIMER3_BASE))
+#define LPC_SCU                   ((LPC_SCU_T                 *) LPC_PERIPH_ADDR(LPC_SCU_BASE))
+#define LPC_GPIO_PIN_INT          ((IP_GPIOPININT_001_T       *) LPC_PERIPH_ADDR(LPC_GPIO_PIN_INT_BASE))
+#define LPC_GPIO_GROUP_INT0       ((IP_GPIOGROUPINT_001_T     *) LPC_PERIPH_ADDR(LPC_GPIO_GROUP_INT0_BASE))
+#define LPC_GPIO_GROUP_INT1       ((IP_GPIOGROUPINT_001_T     *) LPC_PERIPH_ADDR(LPC_GPIO_GROUP_INT1_BASE))
+#define LPC_MCPWM                 ((IP_MCPWM_001_T            *) LPC_PERIPH_ADDR(LPC_MCPWM_BASE))
+#define LPC_I2C0                  ((IP_I2C_001_T              *) LPC_PERIPH_ADDR(LPC_I2C0_BASE))
+#define LPC_I2C1                  ((IP_I2C_001_T              *) LPC_PERIPH_ADDR(LPC_I2C1_BASE))
+#define LPC_I2S0                  ((IP_I2S_001_T              *) LPC_PERIPH_ADDR(LPC_I2S0_BASE))
+#define LPC_I2S1                  ((IP_I2S_001_T              *) LPC_PERIPH_ADDR(LPC_I2S1_BASE))
+#define LPC_C_CAN1                ((IP_CCAN_001_T             *) LPC_PERIPH_ADDR(LPC_C_CAN1_BASE))
+#define LPC_RITIMER               ((IP_RITIMER_001_T          *) LPC_PERIPH_ADDR(LPC_RITIMER_BASE))
+#define LPC_QEI                   ((IP_QEI_001_T              *) LPC_PERIPH_ADDR(LPC_QEI_BASE))
+#define LPC_GIMA                  ((IP_GIMA_001_T             *) LPC_PERIPH_ADDR(LPC_GIMA_BASE))
+#define LPC_DAC                   ((IP_DAC_001_T              *) LPC_PERIPH_ADDR(LPC_DAC_BASE))
+#define LPC_C_CAN0                ((IP_CCAN_001_T             *) LPC_PERIPH_ADDR(LPC_C_CAN0_BASE))
+#define LPC_ADC0                  ((IP_ADC_001_T              *) LPC_PERIPH_ADDR(LPC_ADC0_BASE))
+#define LPC_ADC1                  ((IP_ADC_001_T              *) LPC_PERIPH_ADDR(LPC_ADC1_BASE))
+#define LPC_GPIO_PORT             ((IP_GPIO_001_T             *) LPC_PERIPH_ADDR(LPC_GPIO_PORT_BASE))
+#define LPC_SPI                   ((IP_SPI_001_T              *) LPC_PERIPH_ADDR(LPC_SPI_BASE))
+#define LPC_SGPIO                 ((IP_SGPIO_001_T            *) LPC_PERIPH_ADDR(LPC_SGPIO_BASE))
 
 /**
  * @}
@@ -260,6 +260,17 @@ void Chip_Clock_Disable(CHIP_CCU_CLK_T clk);
  */
 uint32_t Chip_Clock_GetRate(CHIP_CCU_CLK_T clk);
 
+/**
+ * @brief	Returns the clock generation, a count of clock rate changes
+ * @return	A value that changes with every call that may change a clock rate
+ * @note	Drivers caching settings derived from a clock rate store the
+ *			generation with them and recompute once it differs, instead of
+ *			querying the clock tree on every use. Calls that change rates are
+ *			the main PLL, audio/USB PLL, divider and base clock setups and
+ *			Chip_Clock_EnableOpts().
+ */
+uint32_t Chip_Clock_GetGeneration(void);
+
 /**
  * @brief	Start the power down sequence by disabling the branch output
  *          clocks with wake up mechanism (Only the clocks which
@@ -0,0 +1,109 @@
+/*
+ * @brief Host (non-ARM) stand-ins for the CMSIS core intrinsics
+ *
+ * @note
+ * Used only when the library is built with HOST_BUILD defined (see the
+ * 'host' target in the Makefile). Barriers map onto the host compiler's
+ * full memory fence, interrupt masking is tracked in a PRIMASK image and
+ * the sleep hints are no-ops, so driver code that uses these intrinsics
+ * can run unchanged on a development machine. The core peripherals (NVIC,
+ * SCB, SysTick, DWT, CoreDebug, ...) are remapped by core_cm4.h into a RAM
+ * image of the private peripheral bus.
+ */
+
+#ifndef __CMSIS_HOST_H_
+#define __CMSIS_HOST_H_
+
+#include <stdint.h>
+
+/* Simulated PRIMASK, defined in Sources/host/host_periph.c */
+extern volatile uint32_t Host_PRIMASK;
+
+/* RAM image of the 0xE0000000 - 0xE0040FFF private peripheral bus, from
+   the ITM up to the TPI, defined in Sources/host/host_periph.c */
+#define HOST_CORE_WINDOW_BASE     0xE0000000UL
+#define HOST_CORE_WINDOW_SIZE     0x00041000UL
+extern uint32_t Host_CoreRegs[HOST_CORE_WINDOW_SIZE / sizeof(uint32_t)];
+#define HOST_CORE_ADDR(base)      ((uintptr_t) Host_CoreRegs + ((base) - HOST_CORE_WINDOW_BASE))
+
+/* Core instruction access */
+__STATIC_INLINE void __NOP(void) {}
+__STATIC_INLINE void __WFI(void) {}
+__STATIC_INLINE void __WFE(void) {}
+__STATIC_INLINE void __SEV(void) {}
+
+__STATIC_INLINE void __ISB(void)
+{
+	__sync_synchronize();
+}
+
+__STATIC_INLINE void __DSB(void)
+{
+	__sync_synchronize();
+}
+
+__STATIC_INLINE void __DMB(void)
+{
+	__sync_synchronize();
+}
+
+__STATIC_INLINE uint32_t __REV(uint32_t value)
+{
+	return __builtin_bswap32(value);
+}
+
+__STATIC_INLINE uint32_t __REV16(uint32_t value)
+{
+	return ((value & 0xFF00FF00UL) >> 8) | ((value & 0x00FF00FFUL) << 8);
+}
+
+__STATIC_INLINE int32_t __REVSH(int32_t value)
+{
+	return (int32_t) (int16_t) __builtin_bswap16((uint16_t) value);
+}
+
+__STATIC_INLINE uint32_t __ROR(uint32_t op1, uint32_t op2)
+{
+	op2 &= 31;
+	return (op2 == 0) ? op1 : ((op1 >> op2) | (op1 << (32 - op2)));
+}
+
+__STATIC_INLINE uint32_t __RBIT(uint32_t value)
+{
+	uint32_t result = 0;
+	int i;
+
+	for (i = 0; i < 32; i++) {
+		result = (result << 1) | (value & 1);
+		value >>= 1;
+	}
+	return result;
+}
+
+__STATIC_INLINE uint8_t __CLZ(uint32_t value)
+{
+	return (value == 0) ? 32 : (uint8_t) __builtin_clz(value);
+}
+
+/* Core register access */
+__STATIC_INLINE void __enable_irq(void)
+{
+	Host_PRIMASK = 0;
+}
+
+__STATIC_INLINE void __disable_irq(void)
+{
+	Host_PRIMASK = 1;
+}
+
+__STATIC_INLINE uint32_t __get_PRIMASK(void)
+{
+	return Host_PRIMASK;
+}
+
+__STATIC_INLINE void __set_PRIMASK(uint32_t priMask)
+{
+	Host_PRIMASK = priMask & 1;
+}
+
+#endif /* __CMSIS_HOST_H_ */
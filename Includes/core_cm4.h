@@ -1355,11 +1355,20 @@ typedef struct
  */
 
 /* Memory mapping of Cortex-M4 Hardware */
+#if defined ( HOST_BUILD )
+/* Host simulation build: the private peripheral bus is a RAM image */
+#define SCS_BASE            (HOST_CORE_ADDR(0xE000E000UL))            /*!< System Control Space Base Address  */
+#define ITM_BASE            (HOST_CORE_ADDR(0xE0000000UL))            /*!< ITM Base Address                   */
+#define DWT_BASE            (HOST_CORE_ADDR(0xE0001000UL))            /*!< DWT Base Address                   */
+#define TPI_BASE            (HOST_CORE_ADDR(0xE0040000UL))            /*!< TPI Base Address                   */
+#define CoreDebug_BASE      (HOST_CORE_ADDR(0xE000EDF0UL))            /*!< Core Debug Base Address            */
+#else
 #define SCS_BASE            (0xE000E000UL)                            /*!< System Control Space Base Address  */
 #define ITM_BASE            (0xE0000000UL)                            /*!< ITM Base Address                   */
 #define DWT_BASE            (0xE0001000UL)                            /*!< DWT Base Address                   */
 #define TPI_BASE            (0xE0040000UL)                            /*!< TPI Base Address                   */
 #define CoreDebug_BASE      (0xE000EDF0UL)                            /*!< Core Debug Base Address            */
+#endif
 #define SysTick_BASE        (SCS_BASE +  0x0010UL)                    /*!< SysTick Base Address               */
 #define NVIC_BASE           (SCS_BASE +  0x0100UL)                    /*!< NVIC Base Address                  */
 #define SCB_BASE            (SCS_BASE +  0x0D00UL)                    /*!< System Control Block Base Address  */
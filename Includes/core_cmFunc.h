@@ -304,6 +304,12 @@ __STATIC_INLINE void __set_FPSCR(uint32_t fpscr)
 #include <cmsis_ccs.h>
 
 
+#elif defined ( HOST_BUILD ) /*-------------- Host simulation build -----------*/
+/* Host (non-ARM) stand-ins */
+
+#include "cmsis_host.h"
+
+
 #elif defined ( __GNUC__ ) /*------------------ GNU Compiler ---------------------*/
 /* GNU gcc specific functions */
 
@@ -276,6 +276,12 @@ __attribute__((section(".revsh_text"))) __STATIC_INLINE __ASM int32_t __REVSH(in
 #include <cmsis_ccs.h>
 
 
+#elif defined ( HOST_BUILD ) /*-------------- Host simulation build -----------*/
+/* Host (non-ARM) stand-ins */
+
+#include "cmsis_host.h"
+
+
 #elif defined ( __GNUC__ ) /*------------------ GNU Compiler ---------------------*/
 /* GNU gcc specific functions */
 
@@ -106,6 +106,60 @@ extern "C" {
 #define SRC_PER_CONTROLLER 1	/*!< Flow control is Source peripheral controller*/
 #define DST_PER_CONTROLLER 2	/*!< Flow control is Destination peripheral controller*/
 
+/**
+ * @brief Largest number of transfers one descriptor (or control word) can move
+ */
+#define GPDMA_MAX_XFER_SIZE 0xFFF
+
+/**
+ * @brief Number of descriptors in the pool used to split large transfers,
+ * may be overridden in sys_config.h
+ */
+#ifndef GPDMA_DESC_POOL_SIZE
+#define GPDMA_DESC_POOL_SIZE 64
+#endif
+
+/**
+ * @brief Default smallest block Chip_DMA_Memcpy()/Chip_DMA_Memset() give to the
+ * GPDMA, smaller ones are done by the CPU. May be overridden in sys_config.h.
+ */
+#ifndef GPDMA_MEM_DMA_THRESHOLD
+#define GPDMA_MEM_DMA_THRESHOLD 256
+#endif
+
+/**
+ * @brief Channel number returned when no GPDMA channel is free
+ */
+#define GPDMA_CHANNEL_NONE 0xFF
+
+/**
+ * @brief GPDMA channel allocation priority
+ */
+typedef enum {
+	GPDMA_PRIO_HIGH,	/*!< Lowest free channel, wins arbitration over higher ones */
+	GPDMA_PRIO_LOW		/*!< Highest free channel, leaves the fast ones for others */
+} GPDMA_PRIO_T;
+
+/**
+ * @brief GPDMA channel completion callback, called from Chip_GPDMA_Interrupt_Handler()
+ * with SUCCESS on a terminal count or ERROR on a bus error
+ */
+typedef void (*GPDMA_CALLBACK_T)(uint8_t ChannelNum, Status result, void *pUserData);
+
+/**
+ * @brief GPDMA channel release callback, see Chip_DMA_AddReleaseWaiter()
+ */
+typedef void (*GPDMA_RELEASE_FUNC_T)(void *pUserData);
+
+/**
+ * @brief GPDMA channel release waiter, owned by the driver while registered
+ */
+typedef struct DMA_ReleaseWaiter {
+	GPDMA_RELEASE_FUNC_T callback;		/*!< Called when channels may have been freed */
+	void *pUserData;					/*!< Passed back to the callback */
+	struct DMA_ReleaseWaiter *next;		/*!< Used by the driver */
+} DMA_ReleaseWaiter_t;
+
 /**
  * @brief DMA channel handle structure
  */
@@ -123,6 +177,72 @@ typedef struct DMA_TransferDescriptor {
 	uint32_t ctrl;	/*!< Control word that has transfer size, type etc. */
 } DMA_TransferDescriptor_t;
 
+/**
+ * @brief Prepared transfer, the register values of one channel computed once
+ * by Chip_DMA_PrepareTransfer() so Chip_DMA_StartPrepared() only writes them.
+ * src and dst may be changed between starts (e.g. to swap buffers), and lli
+ * pointed at a descriptor list.
+ */
+typedef struct {
+	uint8_t ChannelNum;		/*!< Channel used for the transfer */
+	uint32_t src;			/*!< Source address register value */
+	uint32_t dst;			/*!< Destination address register value */
+	uint32_t lli;			/*!< Linked list item register value, 0 for none */
+	uint32_t ctrl;			/*!< Control register value */
+	uint32_t config;		/*!< Channel configuration register value, without enable */
+	uint32_t dmamuxMask;	/*!< DMAMUX bits of the request lines used */
+	uint32_t dmamuxVal;		/*!< DMAMUX value of those bits */
+} DMA_PreparedTransfer_t;
+
+/**
+ * @brief Virtual DMA channel request, owned by the driver from
+ * Chip_DMA_VSubmit() until its callback runs
+ */
+typedef struct DMA_VRequest {
+	uint32_t src;							/*!< Source, as for Chip_DMA_Transfer() */
+	uint32_t dst;							/*!< Destination, as for Chip_DMA_Transfer() */
+	IP_GPDMA_FLOW_CONTROL_T TransferType;	/*!< Transfer type, as for Chip_DMA_Transfer() */
+	uint32_t Size;							/*!< Size, as for Chip_DMA_Transfer() */
+	GPDMA_CALLBACK_T callback;				/*!< Completion callback, may be NULL */
+	void *pUserData;						/*!< Passed back to the callback */
+	struct DMA_VRequest *next;				/*!< Used by the driver */
+} DMA_VRequest_t;
+
+/**
+ * @brief Virtual DMA channel, a logical stream whose requests run in order
+ * on whichever physical channel is free, or on a reserved one
+ */
+typedef struct DMA_VChannel {
+	DMA_VRequest_t *head;				/*!< Queued requests, the first one may be running */
+	DMA_VRequest_t *tail;				/*!< Last queued request */
+	struct DMA_VChannel *nextWaiting;	/*!< Next virtual channel waiting for a physical one */
+	bool waiting;						/*!< Waiting for a physical channel */
+	uint8_t priority;					/*!< GPDMA_PRIO_T used to pick physical channels */
+	uint8_t active;						/*!< Physical channel running a request, or GPDMA_CHANNEL_NONE */
+	uint8_t reserved;					/*!< Reserved physical channel, or GPDMA_CHANNEL_NONE */
+} DMA_VChannel_t;
+
+typedef struct DMA_Stream DMA_Stream_t;
+
+/**
+ * @brief Stream callback, called each time one half of the stream is done
+ * with. half is 0 for bufA and 1 for bufB; result is ERROR when the
+ * GPDMA reported an error, the stream is stopped then.
+ */
+typedef void (*GPDMA_STREAM_CALLBACK_T)(DMA_Stream_t *pStream, uint8_t half, Status result);
+
+/**
+ * @brief Continuous two buffer (ping-pong) peripheral stream
+ */
+struct DMA_Stream {
+	DMA_TransferDescriptor_t desc[2];	/*!< Self looping descriptor ring, one per buffer */
+	GPDMA_STREAM_CALLBACK_T callback;	/*!< Half completion callback */
+	void *pUserData;					/*!< Free for the callback */
+	uint8_t ChannelNum;					/*!< Physical channel, or GPDMA_CHANNEL_NONE when stopped */
+	uint8_t next;						/*!< Half expected to complete next */
+	uint32_t lost;						/*!< Halves overwritten before they could be reported */
+};
+
 /**
  * @brief	Read the status from different registers according to the type
  * @param	pGPDMA	: The base of GPDMA on the chip
@@ -203,10 +323,78 @@ Status Chip_DMA_Interrupt(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum);
  * @brief	Get a free GPDMA channel for one DMA connection
  * @param	pGPDMA					: The base of GPDMA on the chip
  * @param	PeripheralConnection_ID	: Some chip fix each peripheral DMA connection on a specified channel ( have not used in 18xx/43xx )
- * @return	The channel number which is selected
+ * @return	The channel number which is selected, or GPDMA_CHANNEL_NONE if all are in use
+ * @note	The channel is freed again by Chip_DMA_Stop(). Virtual channels
+ *			waiting for a channel only get it on the next GPDMA interrupt or
+ *			Chip_DMA_ReleaseChannel(), which may be used instead of
+ *			Chip_DMA_Stop() to hand it over at once.
  */
 uint8_t Chip_DMA_GetFreeChannel(LPC_GPDMA_T *pGPDMA, uint32_t PeripheralConnection_ID);
 
+/**
+ * @brief	Allocate a GPDMA channel
+ * @param	pGPDMA		: The base of GPDMA on the chip
+ * @param	priority	: GPDMA_PRIO_HIGH for the lowest free channel (first served by
+ *						  the arbiter), GPDMA_PRIO_LOW for the highest free channel
+ * @return	The allocated channel, or GPDMA_CHANNEL_NONE if all are in use
+ * @note	The channel stays allocated across Chip_DMA_Stop() until it is
+ *			given back with Chip_DMA_ReleaseChannel(). Safe to call from
+ *			interrupt context.
+ */
+uint8_t Chip_DMA_AllocChannel(LPC_GPDMA_T *pGPDMA, GPDMA_PRIO_T priority);
+
+/**
+ * @brief	Stop a GPDMA channel, clear its callback and free it
+ * @param	pGPDMA		: The base of GPDMA on the chip
+ * @param	ChannelNum	: Channel to release
+ * @return	Nothing
+ */
+void Chip_DMA_ReleaseChannel(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum);
+
+/**
+ * @brief	Set the completion callback of a GPDMA channel
+ * @param	pGPDMA		: The base of GPDMA on the chip
+ * @param	ChannelNum	: Channel the callback is for
+ * @param	callback	: Callback, or NULL to ignore the channel's interrupts
+ * @param	pUserData	: Passed back to the callback
+ * @return	Nothing
+ */
+void Chip_DMA_SetCallback(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum,
+						  GPDMA_CALLBACK_T callback, void *pUserData);
+
+/**
+ * @brief	Register to be called when GPDMA channels may have been freed
+ * @param	pGPDMA	: The base of GPDMA on the chip
+ * @param	pWaiter	: Waiter with its callback set, registered once however
+ *					  often this is called
+ * @return	Nothing
+ * @note	The callbacks run in registration order from Chip_DMA_ReleaseChannel()
+ *			and at the end of Chip_GPDMA_Interrupt_Handler(), after waiting
+ *			virtual channels are served, so drivers can retry work that found no
+ *			free channel. A channel freed by a callback does not run them again
+ *			from inside. Chip_GPDMA_Init() drops all waiters.
+ */
+void Chip_DMA_AddReleaseWaiter(LPC_GPDMA_T *pGPDMA, DMA_ReleaseWaiter_t *pWaiter);
+
+/**
+ * @brief	Unregister a channel release waiter
+ * @param	pGPDMA	: The base of GPDMA on the chip
+ * @param	pWaiter	: Waiter registered with Chip_DMA_AddReleaseWaiter()
+ * @return	Nothing
+ */
+void Chip_DMA_RemoveReleaseWaiter(LPC_GPDMA_T *pGPDMA, DMA_ReleaseWaiter_t *pWaiter);
+
+/**
+ * @brief	GPDMA interrupt service routine (chip layer)
+ * @param	pGPDMA	: The base of GPDMA on the chip
+ * @return	Nothing
+ * @note	Reads and clears the terminal count and error status of all
+ *			channels once, then calls the callback of each channel that
+ *			raised an interrupt, lowest channel first. Call it from
+ *			DMA_IRQHandler instead of polling Chip_DMA_Interrupt() per channel.
+ */
+void Chip_GPDMA_Interrupt_Handler(LPC_GPDMA_T *pGPDMA);
+
 /**
  * @brief	Do a DMA transfer M2M, M2P,P2M or P2P
  * @param	pGPDMA		: The base of GPDMA on the chip
@@ -222,8 +410,14 @@ uint8_t Chip_DMA_GetFreeChannel(LPC_GPDMA_T *pGPDMA, uint32_t PeripheralConnecti
  *                               - GPDMA_TRANSFERTYPE_M2P_CONTROLLER_PERIPHERAL
  *                               - GPDMA_TRANSFERTYPE_P2M_CONTROLLER_PERIPHERAL
  *                               - GPDMA_TRANSFERTYPE_P2P_CONTROLLER_SrcPERIPHERAL
- * @param	Size		: The number of DMA transfers
+ * @param	Size		: The number of DMA transfers (bytes for memory to memory)
  * @return	ERROR on error, SUCCESS on success
+ * @note	Memory to memory copies use the widest width the addresses and size
+ *			allow. Transfers of more than GPDMA_MAX_XFER_SIZE are split into a
+ *			descriptor chain taken from a pool of GPDMA_DESC_POOL_SIZE entries,
+ *			ERROR is returned if the pool cannot hold it. The chain goes back to
+ *			the pool on Chip_DMA_Stop() or, with Chip_GPDMA_Interrupt_Handler(),
+ *			when the channel completes.
  */
 Status Chip_DMA_Transfer(LPC_GPDMA_T *pGPDMA,
 						 uint8_t ChannelNum,
@@ -239,12 +433,37 @@ Status Chip_DMA_Transfer(LPC_GPDMA_T *pGPDMA,
  * @param	DMADescriptor	: First node in the linked list of descriptors
  * @param	TransferType	: Select the transfer controller and the type of transfer. (See, #IP_GPDMA_FLOW_CONTROL_T)
  * @return	ERROR on error, SUCCESS on success
+ * @note	The descriptors must be set up with Chip_DMA_PrepareDescriptor(). The
+ *			list may loop back on itself for a continuous (circular) transfer.
+ *			The connections are found from the peripheral addresses in the first
+ *			descriptor, taking the first match. The I2S connections share their
+ *			FIFO addresses and the SCT ones have none, use
+ *			Chip_DMA_SGTransferConn() for those.
  */
 Status Chip_DMA_SGTransfer(LPC_GPDMA_T *pGPDMA,
 						   uint8_t ChannelNum,
 						   const DMA_TransferDescriptor_t *DMADescriptor,
 						   IP_GPDMA_FLOW_CONTROL_T TransferType);
 
+/**
+ * @brief	Do a DMA transfer using linked list of descriptors and given connections
+ * @param	pGPDMA			: The base of GPDMA on the chip
+ * @param	ChannelNum		: Channel used for transfer *must be obtained using Chip_DMA_GetFreeChannel()*
+ * @param	DMADescriptor	: First node in the linked list of descriptors
+ * @param	SrcConn			: GPDMA_CONN_* of the source peripheral, GPDMA_CONN_MEMORY for memory
+ * @param	DstConn			: GPDMA_CONN_* of the destination peripheral, GPDMA_CONN_MEMORY for memory
+ * @param	TransferType	: Select the transfer controller and the type of transfer. (See, #IP_GPDMA_FLOW_CONTROL_T)
+ * @return	ERROR on error, SUCCESS on success
+ * @note	Like Chip_DMA_SGTransfer(), with the request lines taken from the
+ *			connections the descriptors were prepared with.
+ */
+Status Chip_DMA_SGTransferConn(LPC_GPDMA_T *pGPDMA,
+							   uint8_t ChannelNum,
+							   const DMA_TransferDescriptor_t *DMADescriptor,
+							   uint32_t SrcConn,
+							   uint32_t DstConn,
+							   IP_GPDMA_FLOW_CONTROL_T TransferType);
+
 /**
  * @brief	Prepare a single DMA descriptor
  * @param	pGPDMA			: The base of GPDMA on the chip
@@ -287,6 +506,217 @@ int Chip_DMA_InitChannelCfg(LPC_GPDMA_T *pGPDMA,
 							uint32_t Size,
 							IP_GPDMA_FLOW_CONTROL_T TransferType);
 
+/**
+ * @brief	Prepare a transfer for fast, repeated starts
+ * @param	pGPDMA		: The base of GPDMA on the chip
+ * @param	pXfer		: Prepared transfer to fill in
+ * @param	ChannelNum	: Channel used for transfer
+ * @param	src			: Address of Memory or PeripheralConnection_ID which is the source
+ * @param	dst			: Address of Memory or PeripheralConnection_ID which is the destination
+ * @param	TransferType: Select the transfer controller and the type of transfer. (See, #IP_GPDMA_FLOW_CONTROL_T)
+ * @param	Size		: The number of DMA transfers (bytes for memory to memory),
+ *						  at most GPDMA_MAX_XFER_SIZE transfers
+ * @return	ERROR on error, SUCCESS on success
+ * @note	Does the same work as Chip_DMA_Transfer() without touching the channel.
+ */
+Status Chip_DMA_PrepareTransfer(LPC_GPDMA_T *pGPDMA,
+								DMA_PreparedTransfer_t *pXfer,
+								uint8_t ChannelNum,
+								uint32_t src,
+								uint32_t dst,
+								IP_GPDMA_FLOW_CONTROL_T TransferType,
+								uint32_t Size);
+
+/**
+ * @brief	Start a prepared transfer
+ * @param	pGPDMA	: The base of GPDMA on the chip
+ * @param	pXfer	: Transfer set up with Chip_DMA_PrepareTransfer()
+ * @return	ERROR if the channel is still enabled, SUCCESS otherwise
+ * @note	Sets the DMAMUX, clears the channel's pending interrupts and writes
+ *			the channel registers, with no table lookups or control word
+ *			computation. Suited to re-arming recurring transfers from an ISR.
+ */
+Status Chip_DMA_StartPrepared(LPC_GPDMA_T *pGPDMA, const DMA_PreparedTransfer_t *pXfer);
+
+/**
+ * @brief	Set up a virtual DMA channel
+ * @param	pGPDMA		: The base of GPDMA on the chip
+ * @param	pVch		: Virtual channel to set up
+ * @param	priority	: Priority used to pick physical channels
+ * @param	reserve		: true to reserve a physical channel for this virtual
+ *						  channel alone, for latency critical streams
+ * @return	SUCCESS, or ERROR if a reservation was asked for and no channel is free
+ * @note	Virtual channels without a reservation share the channels not
+ *			otherwise allocated. When all are busy their requests wait, and a
+ *			channel that completes a request is handed to the virtual channel
+ *			that waited longest. Completions must come through
+ *			Chip_GPDMA_Interrupt_Handler().
+ */
+Status Chip_DMA_VChannelInit(LPC_GPDMA_T *pGPDMA, DMA_VChannel_t *pVch,
+							 GPDMA_PRIO_T priority, bool reserve);
+
+/**
+ * @brief	Release the reserved physical channel of an idle virtual channel
+ * @param	pGPDMA	: The base of GPDMA on the chip
+ * @param	pVch	: Virtual channel
+ * @return	SUCCESS, or ERROR if requests are still queued
+ */
+Status Chip_DMA_VChannelDeInit(LPC_GPDMA_T *pGPDMA, DMA_VChannel_t *pVch);
+
+/**
+ * @brief	Queue a transfer on a virtual DMA channel
+ * @param	pGPDMA	: The base of GPDMA on the chip
+ * @param	pVch	: Virtual channel
+ * @param	pReq	: Request, kept by the driver until its callback runs
+ * @return	SUCCESS
+ * @note	Requests of one virtual channel run one at a time, in order. A
+ *			request that fails to start completes with ERROR. Safe to call
+ *			from a request callback.
+ */
+Status Chip_DMA_VSubmit(LPC_GPDMA_T *pGPDMA, DMA_VChannel_t *pVch, DMA_VRequest_t *pReq);
+
+/**
+ * @brief	Start a continuous ping-pong stream between a peripheral and two buffers
+ * @param	pGPDMA			: The base of GPDMA on the chip
+ * @param	pStream			: Stream, kept by the driver until Chip_DMA_StreamStop()
+ * @param	peripheral		: GPDMA_CONN_* of the peripheral
+ * @param	TransferType	: GPDMA_TRANSFERTYPE_M2P_* to feed the peripheral
+ *							  (DAC, I2S, SSP slave transmit) or GPDMA_TRANSFERTYPE_P2M_*
+ *							  to drain it (ADC, I2S, SSP slave receive)
+ * @param	bufA			: First buffer
+ * @param	bufB			: Second buffer
+ * @param	len				: Transfers per buffer, at most GPDMA_MAX_XFER_SIZE
+ * @param	callback		: Called each time a buffer is done with
+ * @param	pUserData		: Stored in pStream->pUserData
+ * @return	SUCCESS, or ERROR on bad parameters or no free channel
+ * @note	The two descriptors point at each other and both raise a terminal
+ *			count interrupt, so the GPDMA keeps alternating between the buffers
+ *			without being re-armed. The callback has until the other buffer is
+ *			done with to refill or consume the one it is given. A half is never
+ *			reported while the GPDMA is working on it: when the interrupt is
+ *			served too late to hand a half over before it is reused, that half
+ *			is skipped and counted in pStream->lost. Completions must come
+ *			through Chip_GPDMA_Interrupt_Handler().
+ */
+Status Chip_DMA_StreamStart(LPC_GPDMA_T *pGPDMA,
+							DMA_Stream_t *pStream,
+							uint32_t peripheral,
+							IP_GPDMA_FLOW_CONTROL_T TransferType,
+							uint32_t bufA,
+							uint32_t bufB,
+							uint32_t len,
+							GPDMA_STREAM_CALLBACK_T callback,
+							void *pUserData);
+
+/**
+ * @brief	Stop a stream and release its channel
+ * @param	pGPDMA	: The base of GPDMA on the chip
+ * @param	pStream	: Stream started with Chip_DMA_StreamStart()
+ * @return	Nothing
+ */
+void Chip_DMA_StreamStop(LPC_GPDMA_T *pGPDMA, DMA_Stream_t *pStream);
+
+/**
+ * @brief	Copy memory, with the GPDMA for large blocks
+ * @param	pGPDMA		: The base of GPDMA on the chip
+ * @param	dst			: Destination address
+ * @param	src			: Source address, the blocks must not overlap
+ * @param	len			: Number of bytes
+ * @param	callback	: Called on completion, may be NULL
+ * @param	pUserData	: Passed back to the callback
+ * @return	SUCCESS
+ * @note	Blocks smaller than the threshold (see Chip_DMA_MemCalibrate()), or
+ *			when no channel is free, are copied by the CPU before returning and
+ *			the callback is called with GPDMA_CHANNEL_NONE. Larger ones are
+ *			copied by the GPDMA at the widest width the relative alignment
+ *			allows, with the unaligned head and tail bytes done by the CPU;
+ *			the callback then runs from Chip_GPDMA_Interrupt_Handler(). The
+ *			channel is free again by then and the callback always gets
+ *			GPDMA_CHANNEL_NONE.
+ */
+Status Chip_DMA_Memcpy(LPC_GPDMA_T *pGPDMA, void *dst, const void *src, uint32_t len,
+					   GPDMA_CALLBACK_T callback, void *pUserData);
+
+/**
+ * @brief	Fill memory, with the GPDMA for large blocks
+ * @param	pGPDMA		: The base of GPDMA on the chip
+ * @param	dst			: Destination address
+ * @param	value		: Byte value to fill with
+ * @param	len			: Number of bytes
+ * @param	callback	: Called on completion, may be NULL
+ * @param	pUserData	: Passed back to the callback
+ * @return	SUCCESS
+ * @note	Dispatched between CPU and GPDMA like Chip_DMA_Memcpy().
+ */
+Status Chip_DMA_Memset(LPC_GPDMA_T *pGPDMA, void *dst, uint8_t value, uint32_t len,
+					   GPDMA_CALLBACK_T callback, void *pUserData);
+
+/**
+ * @brief	Set the smallest block Chip_DMA_Memcpy()/Chip_DMA_Memset() give to the GPDMA
+ * @param	bytes	: Threshold in bytes
+ * @return	Nothing
+ */
+void Chip_DMA_SetMemThreshold(uint32_t bytes);
+
+/**
+ * @brief	Measure the block size from which the GPDMA copies faster than the CPU
+ * @param	pGPDMA	: The base of GPDMA on the chip
+ * @param	dst		: Scratch destination of at least maxLen bytes
+ * @param	src		: Source of at least maxLen bytes
+ * @param	maxLen	: Largest block size to try
+ * @return	The new threshold, also applied to Chip_DMA_Memcpy()/Chip_DMA_Memset()
+ * @note	Times both with the DWT cycle counter for sizes doubling from 16
+ *			bytes. The crossover depends on the memories involved (SRAM, EMC
+ *			SDRAM), so calibrate with buffers where the real copies happen.
+ *			Blocks until done, and needs a free GPDMA channel. A GPDMA copy
+ *			is waited for no longer than the CPU copy of the same size took.
+ */
+uint32_t Chip_DMA_MemCalibrate(LPC_GPDMA_T *pGPDMA, void *dst, const void *src, uint32_t maxLen);
+
+/**
+ * @brief	Copy a rectangle of pixels, one GPDMA descriptor per scanline
+ * @param	pGPDMA		: The base of GPDMA on the chip
+ * @param	src			: First pixel of the source rectangle
+ * @param	dst			: First pixel of the destination rectangle
+ * @param	width		: Rectangle width in pixels
+ * @param	height		: Rectangle height in lines
+ * @param	srcStride	: Bytes from one source line to the next
+ * @param	dstStride	: Bytes from one destination line to the next
+ * @param	pixelSize	: Bytes per pixel, 1, 2 or 4
+ * @param	callback	: Called when done, may be NULL
+ * @param	pUserData	: Passed back to the callback
+ * @return	SUCCESS, or ERROR on bad parameters
+ * @note	Meant for compositing into LCD frame buffers in EMC SDRAM. Lines
+ *			are chained from the descriptor pool a batch at a time, so any
+ *			height works; a line is at most GPDMA_MAX_XFER_SIZE transfers of
+ *			the widest width the addresses, strides and line length allow.
+ *			Without a free channel the copy is done by the CPU before
+ *			returning. The callback always gets GPDMA_CHANNEL_NONE.
+ */
+Status Chip_DMA_BlitCopy(LPC_GPDMA_T *pGPDMA, const void *src, void *dst,
+						 uint32_t width, uint32_t height, uint32_t srcStride, uint32_t dstStride,
+						 uint32_t pixelSize, GPDMA_CALLBACK_T callback, void *pUserData);
+
+/**
+ * @brief	Fill a rectangle of pixels, one GPDMA descriptor per scanline
+ * @param	pGPDMA		: The base of GPDMA on the chip
+ * @param	dst			: First pixel of the rectangle
+ * @param	color		: Pixel value
+ * @param	width		: Rectangle width in pixels
+ * @param	height		: Rectangle height in lines
+ * @param	dstStride	: Bytes from one line to the next
+ * @param	pixelSize	: Bytes per pixel, 1, 2 or 4
+ * @param	callback	: Called when done, may be NULL
+ * @param	pUserData	: Passed back to the callback
+ * @return	SUCCESS, or ERROR on bad parameters
+ * @note	Works as Chip_DMA_BlitCopy(). When the alignment of dst or
+ *			dstStride only allows a transfer narrower than a pixel and the
+ *			parts of the colour differ, the fill is done by the CPU.
+ */
+Status Chip_DMA_BlitFill(LPC_GPDMA_T *pGPDMA, void *dst, uint32_t color,
+						 uint32_t width, uint32_t height, uint32_t dstStride,
+						 uint32_t pixelSize, GPDMA_CALLBACK_T callback, void *pUserData);
+
 /**
  * @}
  */
@@ -32,6 +32,8 @@
 #ifndef I2C_18XX_43XX_H_
 #define I2C_18XX_43XX_H_
 
+#include "ring_buffer.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -41,6 +43,123 @@ extern "C" {
  * @{
  */
 
+typedef struct I2C_XFER I2C_XFER_T;
+
+/**
+ * @brief I2C queued transaction completion callback
+ */
+typedef void (*I2C_XFER_CALLBACK_T)(I2C_XFER_T *pXfer, Status result);
+
+/**
+ * @brief I2C queued transaction, owned by the driver from Chip_I2C_Queue_Submit() until its callback runs
+ * @note	A transaction with both tx_length and rx_length set writes first and
+ *			then reads after a repeated start condition.
+ */
+struct I2C_XFER {
+	uint8_t slaveAddr;				/**< Slave address in 7-bit mode */
+	const uint8_t *tx_data;			/**< Bytes to send, or NULL */
+	uint16_t tx_length;				/**< Number of bytes to send */
+	uint8_t *rx_data;				/**< Buffer for received bytes, or NULL */
+	uint16_t rx_length;				/**< Number of bytes to receive */
+	I2C_XFER_CALLBACK_T callback;	/**< Completion callback, may be NULL */
+	void *pUserData;				/**< Free for the callback */
+	uint32_t timeout;				/**< Ticks allowed, checked by Chip_I2C_Queue_Step() or Chip_I2C_Queue_CheckTimeout(), 0 for no limit */
+	uint16_t tx_count;				/**< Bytes sent, updated by the driver */
+	uint16_t rx_count;				/**< Bytes received, updated by the driver */
+	uint8_t status;					/**< I2C status code the transaction ended on */
+	I2C_XFER_T *next;				/**< Used by the driver */
+};
+
+/**
+ * @brief I2C line used for bus recovery
+ */
+typedef struct {
+	uint8_t scuPort;				/**< SCU pin group */
+	uint8_t scuPin;					/**< SCU pin number */
+	uint8_t i2cFunc;				/**< SCU function selecting the I2C signal */
+	uint8_t gpioFunc;				/**< SCU function selecting the GPIO */
+	uint8_t gpioPort;				/**< GPIO port of the pin */
+	uint8_t gpioBit;				/**< GPIO bit of the pin */
+	uint16_t mode;					/**< SCU mode for both functions, must enable the input buffer */
+} I2C_RECOVERY_PIN_T;
+
+/**
+ * @brief I2C bus recovery pins, for busses whose pins can be switched to GPIO
+ */
+typedef struct {
+	I2C_RECOVERY_PIN_T scl;			/**< Clock line */
+	I2C_RECOVERY_PIN_T sda;			/**< Data line */
+	uint32_t delay;					/**< Busy loop count for half an SCL period */
+} I2C_RECOVERY_T;
+
+/** Largest register block a poll plan reads */
+#ifndef I2C_POLL_MAXLEN
+#define I2C_POLL_MAXLEN 8
+#endif
+
+typedef struct I2C_POLL_PLAN I2C_POLL_PLAN_T;
+
+/**
+ * @brief I2C poll plan, a register block read periodically into a double buffered snapshot
+ */
+struct I2C_POLL_PLAN {
+	uint8_t slaveAddr;						/**< Slave address in 7-bit mode */
+	uint8_t regAddr;						/**< First register to read */
+	uint8_t length;							/**< Bytes to read, 1 to I2C_POLL_MAXLEN */
+	uint32_t period;						/**< Ticks between reads */
+	uint32_t timeout;						/**< Ticks allowed for one read, 0 for no limit */
+	uint32_t due;							/**< Tick of the next read, used by the scheduler */
+	uint32_t stamp;							/**< Tick the current snapshot was requested at */
+	uint32_t started;						/**< Tick the read in flight was requested at */
+	volatile uint32_t seq;					/**< Completed reads, bumped after the snapshot is swapped */
+	volatile uint32_t errors;				/**< Failed reads */
+	volatile bool busy;						/**< Read in flight, used by the scheduler */
+	uint8_t front;							/**< Buffer holding the snapshot, used by the scheduler */
+	uint8_t data[2][I2C_POLL_MAXLEN];		/**< Snapshot and read buffers */
+	I2C_XFER_T xfer;						/**< Used by the scheduler */
+	I2C_POLL_PLAN_T *next;					/**< Used by the scheduler */
+};
+
+/**
+ * @brief I2C poll scheduler of one bus
+ */
+typedef struct {
+	LPC_I2C_T *pI2C;						/**< Bus the plans are read on */
+	I2C_POLL_PLAN_T *plans;					/**< Registered plans */
+} I2C_POLL_T;
+
+/** Registers latched for one atomic read burst of the slave register file */
+#ifndef I2C_SLAVE_SHADOW_LEN
+#define I2C_SLAVE_SHADOW_LEN 8
+#endif
+
+/**
+ * @brief I2C slave register write, as queued for the application
+ */
+typedef struct {
+	uint8_t reg;					/**< Register written */
+	uint8_t value;					/**< Register value after the write */
+} I2C_SLAVE_WRITE_T;
+
+/**
+ * @brief I2C slave register file, served from Chip_I2C_Interrupt_SlaveHandler()
+ * @note	The first byte the master writes sets the register pointer, later
+ *			bytes are written from there, and reads continue from the pointer.
+ *			The pointer increments after each byte and wraps at size.
+ */
+typedef struct {
+	uint8_t *regs;					/**< Register values */
+	const uint8_t *rwMask;			/**< Bits the master may write, per register, or NULL for all */
+	uint16_t size;					/**< Number of registers, 1 to 256 */
+	RINGBUFF_T *pWrites;			/**< Ring of I2C_SLAVE_WRITE_T items, or NULL */
+	uint32_t overruns;				/**< Writes lost to a full ring */
+	uint16_t ptr;					/**< Register pointer, used by the driver */
+	uint8_t shadowPos;				/**< Next shadow byte to send, used by the driver */
+	uint8_t shadowLen;				/**< Bytes in the shadow, used by the driver */
+	bool addrPhase;					/**< Next written byte sets the pointer, used by the driver */
+	uint8_t shadow[I2C_SLAVE_SHADOW_LEN];	/**< Registers latched at SLA+R, used by the driver */
+} I2C_SLAVE_REGS_T;
+
 /**
  * @brief	Initializes the LPC_I2C peripheral with specified parameter.
  * @param	pI2C	: I2C peripheral selected, should be LPC_I2C0 or LPC_I2C1
@@ -141,6 +260,132 @@ uint32_t Chip_I2C_MasterReadReg(LPC_I2C_T *pI2C,
  */
 void Chip_I2C_Interrupt_MasterHandler (LPC_I2C_T *pI2C);
 
+/**
+ * @brief	Queue a master transaction on an I2C bus
+ * @param	pI2C	: I2C peripheral selected, should be LPC_I2C0 or LPC_I2C1
+ * @param	pXfer	: Transaction
+ * @return	SUCCESS, or ERROR when the transaction has nothing to transfer
+ * @note	Transactions run in submission order from Chip_I2C_Interrupt_MasterHandler(),
+ *			which must be called from the I2C interrupt, with the peripheral enabled
+ *			in master mode. A finished transaction is followed by the next one
+ *			without a trip through the application. Safe to call from a transaction
+ *			callback. Do not mix with Chip_I2C_MasterTransferData() on the same bus
+ *			while transactions are queued.
+ */
+Status Chip_I2C_Queue_Submit(LPC_I2C_T *pI2C, I2C_XFER_T *pXfer);
+
+/**
+ * @brief	Check for queued master transactions
+ * @param	pI2C	: I2C peripheral selected, should be LPC_I2C0 or LPC_I2C1
+ * @return	true when a transaction is running or waiting
+ */
+bool Chip_I2C_Queue_Busy(LPC_I2C_T *pI2C);
+
+/**
+ * @brief	Step queued master transactions without the I2C interrupt
+ * @param	pI2C	: I2C peripheral selected, should be LPC_I2C0 or LPC_I2C1
+ * @param	now		: Current tick, in the unit of the transaction timeouts
+ * @return	true while transactions remain
+ * @note	Cooperative alternative to Chip_I2C_Interrupt_MasterHandler(), with the
+ *			I2C interrupt disabled. Each call handles at most one bus event and
+ *			does not wait for the bus, so it can be called from a main loop or
+ *			scheduler. A transaction running longer than its timeout completes
+ *			with ERROR and the bus is recovered before the next one starts, which
+ *			takes as long as described for Chip_I2C_Queue_CheckTimeout().
+ */
+bool Chip_I2C_Queue_Step(LPC_I2C_T *pI2C, uint32_t now);
+
+/**
+ * @brief	Check the timeout of the running transaction in interrupt mode
+ * @param	pI2C	: I2C peripheral selected, should be LPC_I2C0 or LPC_I2C1
+ * @param	now		: Current tick, in the unit of the transaction timeouts
+ * @return	Nothing
+ * @note	Call it periodically when the queue runs from
+ *			Chip_I2C_Interrupt_MasterHandler(). A transaction is timed from the
+ *			first call that sees it running; once its timeout has passed it
+ *			completes with ERROR, the bus is recovered and the next transaction
+ *			starts, all from this call. Without recovery pins that is a
+ *			controller reset. With pins set by Chip_I2C_Queue_SetRecovery() the
+ *			bus is clocked from GPIO: at worst 20 busy loops of the pins' delay
+ *			(nine SCL clocks, START and STOP, ten SCL periods, 100 us at
+ *			100 kHz), plus the callbacks. Call it from a handler that can take
+ *			that, e.g. a low priority SysTick, or from thread context.
+ */
+void Chip_I2C_Queue_CheckTimeout(LPC_I2C_T *pI2C, uint32_t now);
+
+/**
+ * @brief	Abort all queued master transactions of a bus
+ * @param	pI2C	: I2C peripheral selected, should be LPC_I2C0 or LPC_I2C1
+ * @return	SUCCESS when the bus was recovered, ERROR if recovery failed or
+ *			was already running for a timeout
+ * @note	The running and all waiting transactions are taken off the bus,
+ *			the bus is recovered with Chip_I2C_BusRecover() and the pins set
+ *			with Chip_I2C_Queue_SetRecovery(), then each transaction completes
+ *			with ERROR, in queue order. Transactions submitted meanwhile, or from
+ *			those callbacks, run afterwards.
+ */
+Status Chip_I2C_Queue_Abort(LPC_I2C_T *pI2C);
+
+/**
+ * @brief	Set the pins used to recover a bus after a queued transaction times out
+ * @param	pI2C	: I2C peripheral selected, should be LPC_I2C0 or LPC_I2C1
+ * @param	pRec	: Recovery pins, or NULL to only reset the controller
+ * @return	Nothing
+ */
+void Chip_I2C_Queue_SetRecovery(LPC_I2C_T *pI2C, const I2C_RECOVERY_T *pRec);
+
+/**
+ * @brief	Recover an I2C bus held by a slave
+ * @param	pI2C	: I2C peripheral selected, should be LPC_I2C0 or LPC_I2C1
+ * @param	pRec	: Recovery pins, or NULL to only reset the controller
+ * @return	SUCCESS when both lines are released, ERROR otherwise
+ * @note	SCL is pulsed from GPIO until the slave releases SDA, nine clocks at
+ *			most, and a STOP condition is sent. The controller is then reset with
+ *			IP_I2C_Reset() before the pins go back to I2C. I2C0 has dedicated
+ *			pins, pass NULL to only reset the controller.
+ */
+Status Chip_I2C_BusRecover(LPC_I2C_T *pI2C, const I2C_RECOVERY_T *pRec);
+
+/**
+ * @brief	Initialize an I2C poll scheduler
+ * @param	pPoll	: Scheduler
+ * @param	pI2C	: I2C peripheral selected, should be LPC_I2C0 or LPC_I2C1
+ * @return	Nothing
+ */
+void Chip_I2C_Poll_Init(I2C_POLL_T *pPoll, LPC_I2C_T *pI2C);
+
+/**
+ * @brief	Register a poll plan with a scheduler
+ * @param	pPoll	: Scheduler
+ * @param	pPlan	: Plan with slaveAddr, regAddr, length, period and timeout set
+ * @param	now		: Current tick, the first read is due right away
+ * @return	SUCCESS, or ERROR on a bad length or period
+ */
+Status Chip_I2C_Poll_AddPlan(I2C_POLL_T *pPoll, I2C_POLL_PLAN_T *pPlan, uint32_t now);
+
+/**
+ * @brief	Start the reads that are due
+ * @param	pPoll	: Scheduler
+ * @param	now		: Current tick, in the unit of the plan periods
+ * @return	Number of reads started
+ * @note	Call from a periodic timer or the main loop. All due reads are queued
+ *			together with Chip_I2C_Queue_Submit() so they run as one burst on the
+ *			bus. A plan still reading when it becomes due again skips that read.
+ */
+uint32_t Chip_I2C_Poll_Run(I2C_POLL_T *pPoll, uint32_t now);
+
+/**
+ * @brief	Copy the latest snapshot of a poll plan
+ * @param	pPlan	: Plan
+ * @param	buffer	: Buffer for pPlan->length bytes
+ * @param	pStamp	: Receives the tick of the snapshot, may be NULL
+ * @return	Number of reads completed so far, 0 when there is no snapshot yet
+ * @note	The copy is retried when a read completes meanwhile. Call it from
+ *			code the I2C interrupt can preempt, not from a higher priority
+ *			interrupt.
+ */
+uint32_t Chip_I2C_Poll_Read(I2C_POLL_PLAN_T *pPlan, uint8_t *buffer, uint32_t *pStamp);
+
 /**
  * @brief	Get status of Master Transfer
  * @param	pI2C	: I2C peripheral selected, should be LPC_I2C0 or LPC_I2C1
@@ -185,6 +430,32 @@ Status Chip_I2C_SlaveReceiveData(LPC_I2C_T *pI2C, I2C_S_SETUP_T *TransferCfg, IP
  */
 void Chip_I2C_Interrupt_SlaveHandler (LPC_I2C_T *pI2C);
 
+/**
+ * @brief	Serve a register file in slave mode
+ * @param	pI2C	: I2C peripheral selected, should be LPC_I2C0 or LPC_I2C1
+ * @param	pRegs	: Register file with regs, rwMask, size and pWrites set, or NULL to stop
+ * @return	SUCCESS, or ERROR when regs is NULL or size is not 1 to 256
+ * @note	The slave is enabled and acknowledges its own address set with
+ *			Chip_I2C_SetOwnSlaveAddr(). Chip_I2C_Interrupt_SlaveHandler() then
+ *			serves every master access without re-arming. Reads start with
+ *			I2C_SLAVE_SHADOW_LEN registers latched at once, so multi-byte values
+ *			updated with Chip_I2C_SlaveRegs_Update() are never read torn. Each
+ *			accepted write is queued into pWrites. General call bytes are
+ *			acknowledged and ignored.
+ */
+Status Chip_I2C_SlaveRegs_Attach(LPC_I2C_T *pI2C, I2C_SLAVE_REGS_T *pRegs);
+
+/**
+ * @brief	Update registers of a slave register file from the application
+ * @param	pRegs	: Register file
+ * @param	reg		: First register
+ * @param	data	: New values
+ * @param	len		: Number of registers
+ * @return	Nothing
+ * @note	The update is atomic against master reads.
+ */
+void Chip_I2C_SlaveRegs_Update(I2C_SLAVE_REGS_T *pRegs, uint8_t reg, const uint8_t *data, uint32_t len);
+
 /**
  * @brief	Get status of Slave Transfer
  * @param	pI2C	: I2C peripheral selected, should be LPC_I2C0 or LPC_I2C1
@@ -194,6 +194,7 @@ typedef struct {				/*!< I2C0 Structure         */
 #define I2C_SETUP_STATUS_ARBF   (1 << 8)	/**< Arbitration false */
 #define I2C_SETUP_STATUS_NOACKF (1 << 9)	/**< No ACK returned */
 #define I2C_SETUP_STATUS_DONE   (1 << 10)	/**< Status DONE */
+#define I2C_SETUP_STATUS_TIMEOUT (1 << 11)	/**< Timed out, the controller was reset */
 
 /**
  * @brief I2C state handle return values
@@ -308,6 +309,16 @@ void IP_I2C_DeInit(IP_I2C_001_T *pI2C);
  */
 void IP_I2C_SetClockRate(IP_I2C_001_T *pI2C, uint32_t SCLValue);
 
+/**
+ * @brief	Reset the I2C controller state machine
+ * @param	pI2C	: Pointer to selected I2Cx peripheral
+ * @return	Nothing
+ * @note	The controller is disabled and enabled again with START, SI and AA
+ *			cleared, which releases the lines it drives. The AA (slave
+ *			acknowledge) setting is kept. Used to give up a bus held by a slave.
+ */
+void IP_I2C_Reset(IP_I2C_001_T *pI2C);
+
 /**
  * @brief	Enable I2C operation for master mode
  * @param	pI2C	: Pointer to selected I2C peripheral
@@ -33,45 +33,86 @@
 #define __RING_BUFFER_H_
 
 #include "lpc_types.h"
+#include "cmsis.h"
 
 /** @defgroup Ring_Buffer CHIP: Simple ring buffer implementation
  * @ingroup CHIP_Common
  * @{
  */
 
+/**
+ * @brief Ring buffer full handling
+ */
+typedef enum {
+	RINGBUFF_MODE_REJECT = 0,	/*!< Inserts into a full ring buffer fail and return ERROR */
+	RINGBUFF_MODE_OVERWRITE,	/*!< Inserts into a full ring buffer drop the oldest items */
+} RINGBUFF_MODE_T;
+
 /**
  * @brief Ring buffer structure
+ * @note	The head index is only written by the producer (RingBuffer_Insert*)
+ *			and the tail index only by the consumer (RingBuffer_Pop*), so one
+ *			producer and one consumer, e.g. a UART ISR and the main loop, can
+ *			share a ring buffer without masking interrupts. Both indices run
+ *			freely and are masked with (count - 1) on access.
+ *			In RINGBUFF_MODE_OVERWRITE the producer also advances the tail
+ *			when it drops items, so the consumer must then not be preempted
+ *			by the producer while popping.
  */
 typedef struct {
-	uint8_t *bufferBase, *bufferLast;
-	uint8_t *bufferIn, *bufferOut;
-	int count, used, itemSize;
+	uint8_t *data;			/*!< Pointer to the ring buffer storage */
+	int count;				/*!< Number of items, must be a power of 2 */
+	int itemSize;			/*!< Size of each item in bytes */
+	RINGBUFF_MODE_T mode;	/*!< Handling of inserts when full */
+	__IO uint32_t head;		/*!< Insert index, written by the producer only */
+	__IO uint32_t tail;		/*!< Pop index, written by the consumer only */
 } RINGBUFF_T;
 
+/** Current head (insert) item index of the ring buffer */
+#define RB_INDH(rb)             ((rb)->head & ((rb)->count - 1))
+/** Current tail (pop) item index of the ring buffer */
+#define RB_INDT(rb)             ((rb)->tail & ((rb)->count - 1))
+
 /**
  * @brief	Initialize ring buffer
  * @param	RingBuff	: Pointer to ring buffer to initialize
  * @param	buffer		: Pointer to buffer to associate with RingBuff
- * @param	itemSize	: Size of each buffer item size (1, 2 or 4 bytes)
- * @param	count		: Size of ring buffer
+ * @param	itemSize	: Size of each buffer item in bytes
+ * @param	count		: Size of ring buffer in items, must be a power of 2
+ * @return	SUCCESS, or ERROR if count is not a power of 2
+ * @note	The ring buffer starts in RINGBUFF_MODE_REJECT.
+ */
+Status RingBuffer_Init(RINGBUFF_T *RingBuff, void *buffer, int itemSize, int count);
+
+/**
+ * @brief	Select how inserts into a full ring buffer are handled
+ * @param	RingBuff	: Pointer to ring buffer
+ * @param	mode		: RINGBUFF_MODE_REJECT or RINGBUFF_MODE_OVERWRITE
  * @return	Nothing
+ * @note	Applies to RingBuffer_Insert() and all RingBuffer_InsertMult*()
+ *			calls. RingBuffer_Insert8/16/32() never check for space.
  */
-void RingBuffer_Init(RINGBUFF_T *RingBuff, void *buffer, int itemSize, int count);
+STATIC INLINE void RingBuffer_SetMode(RINGBUFF_T *RingBuff, RINGBUFF_MODE_T mode)
+{
+	RingBuff->mode = mode;
+}
 
 /**
  * @brief	Resets the ring buffer to empty
  * @param	RingBuff	: Pointer to ring buffer
  * @return	Nothing
+ * @note	Discards all queued items by moving the tail up to the head, so
+ *			this must be called from the consumer side.
  */
 STATIC INLINE void RingBuffer_Flush(RINGBUFF_T *RingBuff)
 {
-	RingBuffer_Init(RingBuff, RingBuff->bufferBase, RingBuff->itemSize, RingBuff->count);
+	RingBuff->tail = RingBuff->head;
 }
 
 /**
  * @brief	Return size the ring buffer
  * @param	RingBuff	: Pointer to ring buffer
- * @return	Size of the ring buffer in bytes
+ * @return	Size of the ring buffer in items
  */
 STATIC INLINE int RingBuffer_GetSize(RINGBUFF_T *RingBuff)
 {
@@ -85,7 +126,7 @@ STATIC INLINE int RingBuffer_GetSize(RINGBUFF_T *RingBuff)
  */
 STATIC INLINE int RingBuffer_GetCount(RINGBUFF_T *RingBuff)
 {
-	return RingBuff->used;
+	return (int) (RingBuff->head - RingBuff->tail);
 }
 
 /**
@@ -95,7 +136,7 @@ STATIC INLINE int RingBuffer_GetCount(RINGBUFF_T *RingBuff)
  */
 STATIC INLINE int RingBuffer_GetFree(RINGBUFF_T *RingBuff)
 {
-	return RingBuff->count - RingBuff->used;
+	return RingBuff->count - RingBuffer_GetCount(RingBuff);
 }
 
 /**
@@ -105,7 +146,7 @@ STATIC INLINE int RingBuffer_GetFree(RINGBUFF_T *RingBuff)
  */
 STATIC INLINE bool RingBuffer_IsFull(RINGBUFF_T *RingBuff)
 {
-	return (bool) (RingBuff->used >= RingBuff->count);
+	return (bool) (RingBuffer_GetCount(RingBuff) >= RingBuff->count);
 }
 
 /**
@@ -115,7 +156,7 @@ STATIC INLINE bool RingBuffer_IsFull(RINGBUFF_T *RingBuff)
  */
 STATIC INLINE bool RingBuffer_IsEmpty(RINGBUFF_T *RingBuff)
 {
-	return (bool) (RingBuff->used == 0);
+	return (bool) (RingBuff->head == RingBuff->tail);
 }
 
 /**
@@ -125,9 +166,30 @@ STATIC INLINE bool RingBuffer_IsEmpty(RINGBUFF_T *RingBuff)
  */
 STATIC INLINE bool RingBuffer_NotEmpty(RINGBUFF_T *RingBuff)
 {
-	return (bool) (RingBuff->used != 0);
+	return (bool) (RingBuff->head != RingBuff->tail);
 }
 
+/**
+ * @brief	Insert a single item in ring buffer
+ * @param	RingBuff	: Pointer to ring buffer
+ * @param	data		: Pointer to the itemSize bytes of the item
+ * @return	SUCCESS, or ERROR if the ring buffer is full in RINGBUFF_MODE_REJECT
+ * @note	In RINGBUFF_MODE_OVERWRITE the oldest item is dropped to make room.
+ */
+Status RingBuffer_Insert(RINGBUFF_T *RingBuff, const void *data);
+
+/**
+ * @brief	Insert a block of items in ring buffer
+ * @param	RingBuff	: Pointer to ring buffer
+ * @param	data		: Pointer to num items of itemSize bytes each
+ * @param	num			: Number of items to insert
+ * @return	Number of items inserted
+ * @note	In RINGBUFF_MODE_REJECT only the items that fit are inserted. In
+ *			RINGBUFF_MODE_OVERWRITE all are inserted and the oldest ones are
+ *			dropped as needed.
+ */
+int RingBuffer_InsertMult(RINGBUFF_T *RingBuff, const void *data, int num);
+
 /**
  * @brief	Insert a single 8-bit value in ring buffer
  * @param	RingBuff	: Pointer to ring buffer
@@ -146,14 +208,12 @@ void RingBuffer_Insert8(RINGBUFF_T *RingBuff, uint8_t data8);
  * @param	RingBuff	: Pointer to ring buffer
  * @param	block8		: Pointer to block of 8-bit data
  * @param	num			: Number of 8-bit data values to insert
- * @return	Nothing
- * @note	Ring buffer will overflow(wraP) without an error
- *			if data is pushed into the ring buffer beyond the
- *			ring buffer size. Use RingBuffer_IsFull() or
- *			RingBuffer_GetCount() to determine if the ring
- *			buffer is full prior to this call if needed.
+ * @return	Number of 8-bit values inserted
+ * @note	Full handling follows the RingBuffer_SetMode() setting. The
+ *			data is copied in at most two blocks (before and after the
+ *			wrap point) and the head is advanced once.
  */
-void RingBuffer_InsertMult8(RINGBUFF_T *RingBuff, const uint8_t *block8, int num);
+int RingBuffer_InsertMult8(RINGBUFF_T *RingBuff, const uint8_t *block8, int num);
 
 /**
  * @brief	Insert 16-bit value in ring buffer
@@ -173,14 +233,12 @@ void RingBuffer_Insert16(RINGBUFF_T *RingBuff, uint16_t data16);
  * @param	RingBuff	: Pointer to ring buffer
  * @param	block16		: Pointer to block of 16-bit data
  * @param	num			: Number of 16-bit data values to insert
- * @return	Nothing
- * @note	Ring buffer will overflow(wraP) without an error
- *			if data is pushed into the ring buffer beyond the
- *			ring buffer size. Use RingBuffer_IsFull() or
- *			RingBuffer_GetCount() to determine if the ring
- *			buffer is full prior to this call if needed.
+ * @return	Number of 16-bit values inserted
+ * @note	Full handling follows the RingBuffer_SetMode() setting. The
+ *			data is copied in at most two blocks (before and after the
+ *			wrap point) and the head is advanced once.
  */
-void RingBuffer_InsertMult16(RINGBUFF_T *RingBuff, const uint16_t *block16, int num);
+int RingBuffer_InsertMult16(RINGBUFF_T *RingBuff, const uint16_t *block16, int num);
 
 /**
  * @brief	Insert 32-bit value in ring buffer
@@ -200,14 +258,29 @@ void RingBuffer_Insert32(RINGBUFF_T *RingBuff, uint32_t data32);
  * @param	RingBuff	: Pointer to ring buffer
  * @param	block32		: Pointer to block of 32-bit data
  * @param	num			: Number of 32-bit data values to insert
- * @return	Nothing
- * @note	Ring buffer will overflow(wraP) without an error
- *			if data is pushed into the ring buffer beyond the
- *			ring buffer size. Use RingBuffer_IsFull() or
- *			RingBuffer_GetCount() to determine if the ring
- *			buffer is full prior to this call if needed.
+ * @return	Number of 32-bit values inserted
+ * @note	Full handling follows the RingBuffer_SetMode() setting. The
+ *			data is copied in at most two blocks (before and after the
+ *			wrap point) and the head is advanced once.
  */
-void RingBuffer_InsertMult32(RINGBUFF_T *RingBuff, const uint32_t *block32, int num);
+int RingBuffer_InsertMult32(RINGBUFF_T *RingBuff, const uint32_t *block32, int num);
+
+/**
+ * @brief	Pop a single item from the ring buffer
+ * @param	RingBuff	: Pointer to ring buffer
+ * @param	data		: Pointer to itemSize bytes to fill
+ * @return	SUCCESS, or ERROR if the ring buffer is empty
+ */
+Status RingBuffer_Pop(RINGBUFF_T *RingBuff, void *data);
+
+/**
+ * @brief	Pop a block of items from the ring buffer
+ * @param	RingBuff	: Pointer to ring buffer
+ * @param	data		: Pointer to room for num items of itemSize bytes each
+ * @param	num			: Maximum number of items to pop
+ * @return	Number of items placed into the buffer
+ */
+int RingBuffer_PopMult(RINGBUFF_T *RingBuff, void *data, int num);
 
 /**
  * @brief	Pop a 8-bit value from the ring buffer
@@ -227,11 +300,8 @@ uint8_t RingBuffer_Pop8(RINGBUFF_T *RingBuff);
  * @param	block8		: Pointer to 8-bit buffer to fill
  * @param	num			: Size of the passed 8-bit buffer in bytes
  * @return	Number of 8-bit values placed into the buffer
- * @note	Ring buffer will overflow(wrap) without an error
- *			if data is popped from the ring buffer beyond the
- *			ring buffer size. Use RingBuffer_IsFull() or
- *			RingBuffer_GetCount() to determine if the ring
- *			buffer is full prior to this call if needed.
+ * @note	The data is copied out in at most two blocks (before and
+ *			after the wrap point) and the tail is advanced once.
  */
 int RingBuffer_PopMult8(RINGBUFF_T *RingBuff, uint8_t *block8, int num);
 
@@ -253,11 +323,8 @@ uint16_t RingBuffer_Pop16(RINGBUFF_T *RingBuff);
  * @param	block16		: Pointer to 16-bit buffer to fill
  * @param	num			: Size of the passed 16-bit buffer in bytes
  * @return	Number of 16-bit values placed into the buffer
- * @note	Ring buffer will overflow(wrap) without an error
- *			if data is popped from the ring buffer beyond the
- *			ring buffer size. Use RingBuffer_IsFull() or
- *			RingBuffer_GetCount() to determine if the ring
- *			buffer is full prior to this call if needed.
+ * @note	The data is copied out in at most two blocks (before and
+ *			after the wrap point) and the tail is advanced once.
  */
 int RingBuffer_PopMult16(RINGBUFF_T *RingBuff, uint16_t *block16, int num);
 
@@ -279,14 +346,59 @@ uint32_t RingBuffer_Pop32(RINGBUFF_T *RingBuff);
  * @param	block32		: Pointer to 32-bit buffer to fill
  * @param	num			: Size of the passed 32-bit buffer in bytes
  * @return	Number of 32-bit values placed into the buffer
- * @note	Ring buffer will overflow(wrap) without an error
- *			if data is popped from the ring buffer beyond the
- *			ring buffer size. Use RingBuffer_IsFull() or
- *			RingBuffer_GetCount() to determine if the ring
- *			buffer is full prior to this call if needed.
+ * @note	The data is copied out in at most two blocks (before and
+ *			after the wrap point) and the tail is advanced once.
  */
 int RingBuffer_PopMult32(RINGBUFF_T *RingBuff, uint32_t *block32, int num);
 
+/**
+ * @brief	Get the contiguous free region at the head of the ring buffer
+ * @param	RingBuff	: Pointer to ring buffer
+ * @param	data		: Returns a pointer to the first free item
+ * @return	Number of free items that can be written contiguously at *data
+ * @note	The region is handed out in place so a DMA engine or a
+ *			parser can fill it directly. Items only become visible to
+ *			the consumer once published with RingBuffer_CommitWrite().
+ *			When the free space wraps, a second call after the commit
+ *			returns the part at the start of the buffer.
+ */
+int RingBuffer_GetWriteSpan(RINGBUFF_T *RingBuff, void **data);
+
+/**
+ * @brief	Publish items written into a region from RingBuffer_GetWriteSpan()
+ * @param	RingBuff	: Pointer to ring buffer
+ * @param	num			: Number of items written, must not exceed the span
+ * @return	Nothing
+ */
+STATIC INLINE void RingBuffer_CommitWrite(RINGBUFF_T *RingBuff, int num)
+{
+	__DMB();
+	RingBuff->head += num;
+}
+
+/**
+ * @brief	Get the contiguous filled region at the tail of the ring buffer
+ * @param	RingBuff	: Pointer to ring buffer
+ * @param	data		: Returns a pointer to the oldest item
+ * @return	Number of items that can be read contiguously at *data
+ * @note	The items stay owned by the ring buffer until released with
+ *			RingBuffer_Consume(). When the data wraps, a second call after
+ *			consuming returns the part at the start of the buffer.
+ */
+int RingBuffer_GetReadSpan(RINGBUFF_T *RingBuff, void **data);
+
+/**
+ * @brief	Release items read from a region from RingBuffer_GetReadSpan()
+ * @param	RingBuff	: Pointer to ring buffer
+ * @param	num			: Number of items consumed, must not exceed the span
+ * @return	Nothing
+ */
+STATIC INLINE void RingBuffer_Consume(RINGBUFF_T *RingBuff, int num)
+{
+	__DMB();
+	RingBuff->tail += num;
+}
+
 /**
  * @}
  */
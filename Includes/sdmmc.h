@@ -479,6 +479,10 @@ int32_t Chip_SDMMC_GetDeviceBlocks(LPC_SDMMC_T *pSDMMC);
  * @param	start_block	: Start block number
  * @param	num_blocks	: Number of block to read
  * @return	Bytes read, or 0 on error
+ * @note	Transfers larger than the DMA descriptors can describe, 64K unless
+ *			a pool is set with Chip_SDMMC_SetDmaPool(), are split into several
+ *			multiple block reads. The count of bytes read before a failing
+ *			read is returned.
  */
 int32_t Chip_SDMMC_ReadBlocks(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_block, int32_t num_blocks);
 
@@ -489,9 +493,25 @@ int32_t Chip_SDMMC_ReadBlocks(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_b
  * @param	start_block	: Start block number
  * @param	num_blocks	: Number of block to write
  * @return	Number of bytes actually written, or 0 on error
+ * @note	Split like Chip_SDMMC_ReadBlocks(). Every part is a multiple block
+ *			write of its own, ended by a STOP and the card's programming time.
+ *			Recording at the card's full rate needs a pool set with
+ *			Chip_SDMMC_SetDmaPool() that covers the whole buffer.
  */
 int32_t Chip_SDMMC_WriteBlocks(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_block, int32_t num_blocks);
 
+/**
+ * @brief	Supply DMA descriptors for large transfers
+ * @param	pSDMMC	: SDMMC peripheral selected
+ * @param	pPool	: Descriptors, 16 byte aligned, or NULL for the built-in 64K set
+ * @param	num		: Number of descriptors, each moves 4K
+ * @return	None
+ * @note	A read or write up to num * 4K bytes then runs as a single multiple
+ *			block command. Takes effect for the acquired card and the cards
+ *			acquired later.
+ */
+void Chip_SDMMC_SetDmaPool(LPC_SDMMC_T *pSDMMC, pSDMMC_DMA_T *pPool, uint32_t num);
+
 /**
  * @}
  */
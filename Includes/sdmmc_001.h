@@ -104,6 +104,7 @@ typedef struct {				/*!< SDMMC Structure        */
 #define MCI_DMADES1_BS1(x)      (x)				/*!< Size of buffer 1 */
 #define MCI_DMADES1_BS2(x)      ((x) << 13)		/*!< Size of buffer 2 */
 #define MCI_DMADES1_MAXTR       4096			/*!< Max transfer size per buffer */
+#define MCI_DMADES_NUM          (1 + (0x10000 / MCI_DMADES1_MAXTR))	/*!< Built-in descriptors, for 64K */
 
 /** @brief  SDIO control register defines
  */
@@ -254,7 +255,9 @@ typedef struct {
  */
 typedef struct _sdif_device {
 	// MCI_IRQ_CB_FUNC_T irq_cb;
-	pSDMMC_DMA_T mci_dma_dd[1 + (0x10000 / MCI_DMADES1_MAXTR)];
+	pSDMMC_DMA_T mci_dma_dd[MCI_DMADES_NUM];
+	pSDMMC_DMA_T *dma_pool;						/*!< Descriptors used instead of mci_dma_dd, or NULL */
+	uint32_t dma_pool_num;						/*!< Number of descriptors in dma_pool */
 	// uint32_t sdio_clk_rate;
 	// uint32_t sdif_slot_clk_rate;
 	// int32_t clock_enabled;
@@ -389,11 +392,18 @@ void IP_SDMMC_SetIntMask(IP_SDMMC_001_T *pSDMMC, uint32_t iVal);
  * @param	pSDMMC		: Pointer to IP_SDMMC_001_T structure
  * @param	psdif_dev	: SD interface device
  * @param	addr		: Address of buffer (source or destination)
- * @param	size		: size of buffer in bytes (64K max)
+ * @param	size		: size of buffer in bytes, IP_SDMMC_DmaMaxSize() max
  * @return	None
  */
 void IP_SDMMC_DmaSetup(IP_SDMMC_001_T *pSDMMC, sdif_device *psdif_dev, uint32_t addr, uint32_t size);
 
+/**
+ * @brief	Largest transfer the DMA descriptors of a device can describe
+ * @param	psdif_dev	: SD interface device
+ * @return	Size in bytes, 64K with the built-in descriptors
+ */
+uint32_t IP_SDMMC_DmaMaxSize(sdif_device *psdif_dev);
+
 /* Sets the transfer block size */
 void IP_SDMMC_SetBlockSize(IP_SDMMC_001_T *pSDMMC, uint32_t blk_size);
 
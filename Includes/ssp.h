@@ -119,6 +119,79 @@ typedef struct {
 	uint32_t  length;	/**< Length of transfer data */
 } Chip_SSP_DATA_SETUP_T;
 
+/** Number of GPDMA descriptors per direction of a DMA transfer */
+#define SSP_DMA_DESC_NUM 4
+
+/** Most frames a DMA transfer can move, 4095 per descriptor */
+#define SSP_DMA_MAXLEN (SSP_DMA_DESC_NUM * 0xFFF)
+
+/**
+ * @brief SSP DMA transfer completion callback, result is ERROR on a GPDMA error
+ */
+typedef void (*SSP_DMA_CALLBACK_T)(LPC_SSP_T *pSSP, Status result, void *pUserData);
+
+/**
+ * @brief SSP clock profile, the prescaler settings for one bit rate
+ */
+typedef struct {
+	uint32_t clkRate;	/**< SSP base clock it was computed for, 0 when not computed */
+	uint32_t clkGen;	/**< Chip_Clock_GetGeneration() when it was computed */
+	uint8_t scr;		/**< CR0 serial clock rate, clocks per bit minus one */
+	uint8_t cpsr;		/**< Clock prescaler, even */
+} SSP_CLOCK_PROFILE_T;
+
+/** Transactions of the current device a bus may run ahead of others waiting */
+#ifndef SSP_BUS_BATCH
+#define SSP_BUS_BATCH 8
+#endif
+
+/**
+ * @brief Device on a shared SSP bus
+ */
+typedef struct {
+	uint32_t bitRate;						/**< SCK rate */
+	CHIP_SSP_BITS_T bits;					/**< Bits per frame */
+	CHIP_SSP_CLOCK_FORMAT_T clockFormat;	/**< CPOL/CPHA */
+	SPI_Address_t cs;						/**< GPIO port and pin of the active low chip select */
+	SSP_CLOCK_PROFILE_T profile;			/**< Used by the bus, computed on first use and after clock changes */
+} SSP_BUS_DEVICE_T;
+
+typedef struct SSP_BUS_XFER SSP_BUS_XFER_T;
+
+/**
+ * @brief Bus transaction completion callback
+ */
+typedef void (*SSP_BUS_CALLBACK_T)(SSP_BUS_XFER_T *pXfer, Status result);
+
+/**
+ * @brief Bus transaction, owned by the bus from Chip_SSP_Bus_Submit() until its callback runs
+ */
+struct SSP_BUS_XFER {
+	SSP_BUS_DEVICE_T *pDev;			/**< Device to talk to */
+	const void *tx_data;			/**< Frames to send, or NULL */
+	void *rx_data;					/**< Buffer for received frames, or NULL */
+	uint32_t frames;				/**< Number of frames, 1 to SSP_DMA_MAXLEN */
+	bool keepCS;					/**< Keep the chip select asserted, the bus then only runs this device */
+	SSP_BUS_CALLBACK_T callback;	/**< Completion callback, may be NULL */
+	void *pUserData;				/**< Free for the callback */
+	SSP_BUS_XFER_T *next;			/**< Used by the bus */
+};
+
+/**
+ * @brief SSP bus shared by several devices
+ */
+typedef struct {
+	LPC_SSP_T *pSSP;					/**< SSP running the bus */
+	SSP_BUS_DEVICE_T *pCurDev;			/**< Device the SSP is set up for */
+	SSP_BUS_XFER_T *head;				/**< Queued transactions */
+	SSP_BUS_XFER_T *tail;				/**< Last queued transaction */
+	SSP_BUS_XFER_T *active;				/**< Running transaction */
+	uint8_t batch;						/**< Transactions run ahead of the queue head */
+	bool csHeld;						/**< Chip select of pCurDev kept asserted */
+	bool stalled;						/**< Active transaction is waiting for GPDMA channels */
+	DMA_ReleaseWaiter_t dmaWaiter;		/**< Retries a stalled transaction on channel release */
+} SSP_BUS_T;
+
 /** SSP configuration parameter defines */
 /** Clock phase control bit */
 #define SSP_CPHA_FIRST          SSP_CR0_CPHA_FIRST
@@ -253,6 +326,11 @@ Status Chip_SSP_Int_RWFrames16Bits(LPC_SSP_T *pSSP, Chip_SSP_DATA_SETUP_T *xf_se
  * This function can be used in both master and slave mode. It starts with writing phase and after that,
  * a reading phase is generated to read any data available in RX_FIFO. All needed information is prepared
  * through xf_setup param.
+ *
+ * Up to a FIFO depth (8) of frames are kept in flight and the RX FIFO is drained in bursts. A NULL
+ * tx_data clocks out 0xFF/0xFFFF, a NULL rx_data drops the received frames. tx_cnt and rx_cnt are the
+ * progress of each direction: a call resumes from them and updates them, also when it returns ERROR
+ * on a receive overrun.
  */
 uint32_t Chip_SSP_RWFrames_Blocking(LPC_SSP_T *pSSP, Chip_SSP_DATA_SETUP_T *xf_setup);
 
@@ -280,6 +358,71 @@ uint32_t Chip_SSP_WriteFrames_Blocking(LPC_SSP_T *pSSP, uint8_t *buffer, uint32_
  */
 uint32_t Chip_SSP_ReadFrames_Blocking(LPC_SSP_T *pSSP, uint8_t *buffer, uint32_t buffer_len);
 
+/**
+ * @brief   Transfer frames with the GPDMA, both directions at once
+ * @param	pSSP			: The base SSP peripheral on the chip
+ * @param	tx_data			: Frames to send, or NULL to clock out 0xFF/0xFFFF
+ * @param	rx_data			: Buffer for the received frames, or NULL to drop them
+ * @param	frames			: Number of frames, 1 to SSP_DMA_MAXLEN
+ * @param	callback		: Called once the last frame is received, may be NULL
+ * @param	pUserData		: Passed back to the callback
+ * @return	SUCCESS, or ERROR when busy, on bad parameters or without two free GPDMA channels
+ * @note	Frames of up to 8 bits are bytes in memory, wider ones halfwords. The
+ *			receive channel always runs, into a one frame sink when rx_data is NULL,
+ *			so completion means every frame has been clocked and the receive FIFO
+ *			never overruns. Completions must come through Chip_GPDMA_Interrupt_Handler().
+ */
+Status Chip_SSP_DMA_Transfer(LPC_SSP_T *pSSP, const void *tx_data, void *rx_data, uint32_t frames,
+							 SSP_DMA_CALLBACK_T callback, void *pUserData);
+
+/**
+ * @brief   Abort a GPDMA transfer started with Chip_SSP_DMA_Transfer()
+ * @param	pSSP			: The base SSP peripheral on the chip
+ * @return	Nothing
+ * @note	The callback is not called.
+ */
+void Chip_SSP_DMA_Abort(LPC_SSP_T *pSSP);
+
+/**
+ * @brief   Set up a bus of devices sharing an SSP
+ * @param	pBus			: Bus to set up
+ * @param	pSSP			: The base SSP peripheral on the chip, initialized as master
+ * @return	Nothing
+ */
+void Chip_SSP_Bus_Init(SSP_BUS_T *pBus, LPC_SSP_T *pSSP);
+
+/**
+ * @brief   Stop using a bus
+ * @param	pBus			: Idle bus
+ * @return	Nothing
+ * @note	Stops the bus from waiting on GPDMA channel releases.
+ */
+void Chip_SSP_Bus_DeInit(SSP_BUS_T *pBus);
+
+/**
+ * @brief   Set up the chip select of a bus device, deasserted
+ * @param	pDev			: Device
+ * @return	Nothing
+ * @note	The pin must be muxed to GPIO. Also drops the cached clock profile,
+ *			call it again after changing bitRate or the SSP base clock.
+ */
+void Chip_SSP_Bus_AddDevice(SSP_BUS_DEVICE_T *pDev);
+
+/**
+ * @brief   Queue a transaction on a bus
+ * @param	pBus			: Bus
+ * @param	pXfer			: Transaction
+ * @return	SUCCESS, or ERROR on a bad frame count
+ * @note	Transactions of one device run in order. Those of the device the SSP
+ *			is set up for may go ahead of others, SSP_BUS_BATCH at most, so the
+ *			format and rate are reprogrammed only when the device changes.
+ *			Transactions run with Chip_SSP_DMA_Transfer(); when no GPDMA channels
+ *			are free the next one waits, and is retried on the next submit or
+ *			channel release (Chip_DMA_AddReleaseWaiter()). Safe to call from a
+ *			transaction callback.
+ */
+Status Chip_SSP_Bus_Submit(SSP_BUS_T *pBus, SSP_BUS_XFER_T *pXfer);
+
 /**
  * @brief   Initialize the SSP
  * @param	pSSP			: The base SSP peripheral on the chip
@@ -310,6 +453,42 @@ void Chip_SSP_Set_Master(LPC_SSP_T *pSSP, bool master);
  */
 void Chip_SSP_Set_BitRate(LPC_SSP_T *pSSP, uint32_t bit_rate);
 
+/**
+ * @brief   Compute the clock profile for a bit rate
+ * @param	pSSP			: The base SSP peripheral on the chip
+ * @param	bit_rate		: The SSP bit rate
+ * @param	pProfile		: Profile to fill
+ * @return	Nothing
+ * @note	Gives the same settings Chip_SSP_Set_BitRate() would, the fastest rate
+ *			not above bit_rate with the smallest prescaler. Compute profiles once
+ *			and switch rates with Chip_SSP_Set_ClockProfile().
+ */
+void Chip_SSP_Calc_ClockProfile(LPC_SSP_T *pSSP, uint32_t bit_rate, SSP_CLOCK_PROFILE_T *pProfile);
+
+/**
+ * @brief   Tell whether a clock profile still matches the clocks
+ * @param	pProfile		: Profile from Chip_SSP_Calc_ClockProfile()
+ * @return	false when it was never computed or a clock rate may have changed since
+ * @note	Only compares the clock generation, the clock tree is not queried.
+ */
+STATIC INLINE bool Chip_SSP_ClockProfileValid(const SSP_CLOCK_PROFILE_T *pProfile)
+{
+	return (pProfile->clkRate != 0) && (pProfile->clkGen == Chip_Clock_GetGeneration());
+}
+
+/**
+ * @brief   Apply a clock profile
+ * @param	pSSP			: The base SSP peripheral on the chip
+ * @param	pProfile		: Profile from Chip_SSP_Calc_ClockProfile()
+ * @return	Nothing
+ * @note	Only writes CPSR and CR0. Recompute the profile once
+ *			Chip_SSP_ClockProfileValid() says it is stale.
+ */
+STATIC INLINE void Chip_SSP_Set_ClockProfile(LPC_SSP_T *pSSP, const SSP_CLOCK_PROFILE_T *pProfile)
+{
+	IP_SSP_Set_ClockRate(pSSP, pProfile->scr, pProfile->cpsr);
+}
+
 /**
  * @brief   Set up the SSP frame format
  * @param	pSSP			: The base SSP peripheral on the chip
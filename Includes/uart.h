@@ -32,6 +32,9 @@
 #ifndef __UART_18XX_43XX_H_
 #define __UART_18XX_43XX_H_
 
+#include "ring_buffer.h"
+#include "gpdma.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -41,6 +44,57 @@ extern "C" {
  * @{
  */
 
+/**
+ * @brief UART receive DMA notification, called from interrupt context with
+ * the number of new bytes made available in the receive ring buffer
+ */
+typedef void (*UART_DMA_RX_FUNC_T)(LPC_USART_T *pUART, uint32_t count);
+
+/** Number of GPDMA descriptors in a transmit request */
+#define UART_DMA_TX_DESC_NUM 4
+
+/** Largest buffer a transmit request can send, 4095 bytes per descriptor */
+#define UART_DMA_TX_MAXLEN (UART_DMA_TX_DESC_NUM * 0xFFF)
+
+typedef struct UART_DMA_TX_REQ UART_DMA_TX_REQ_T;
+
+/**
+ * @brief UART transmit DMA completion, called from interrupt context once the
+ * buffer of a request has been handed to the UART (or on a GPDMA error)
+ */
+typedef void (*UART_DMA_TX_FUNC_T)(LPC_USART_T *pUART, UART_DMA_TX_REQ_T *pReq, Status result);
+
+/**
+ * @brief UART transmit DMA request, owned by the driver from Chip_UART_SendDMA()
+ * until its callback runs
+ */
+struct UART_DMA_TX_REQ {
+	const uint8_t *data;			/*!< Data to send, sent in place (no copy) */
+	uint32_t len;					/*!< Number of bytes, 1 to UART_DMA_TX_MAXLEN */
+	UART_DMA_TX_FUNC_T callback;	/*!< Completion callback, may be NULL */
+	UART_DMA_TX_REQ_T *next;		/*!< Next request in the queue, or NULL */
+	uint32_t numDesc;				/*!< Used by the driver */
+	DMA_TransferDescriptor_t desc[UART_DMA_TX_DESC_NUM];	/*!< Used by the driver */
+};
+
+/**
+ * @brief UART interrupt mode ring buffer context, one per UART port
+ */
+typedef struct {
+	RINGBUFF_T txRB;			/*!< Transmit ring buffer */
+	RINGBUFF_T rxRB;			/*!< Receive ring buffer */
+	__IO FlagStatus TxIntStat;	/*!< Transmit interrupt enable state */
+	DMA_TransferDescriptor_t rxDmaDesc[2];	/*!< Circular receive descriptors, one per half of rxRB */
+	__IO int8_t rxDmaCh;		/*!< GPDMA channel filling rxRB, or -1 when receive is interrupt driven */
+	UART_DMA_RX_FUNC_T rxDmaCallback;	/*!< Receive DMA notification, may be NULL */
+	uint32_t rxDmaBound;		/*!< Used by the driver */
+	__IO uint32_t rxDmaOverrun;	/*!< Received bytes the GPDMA overwrote before they were read */
+	__IO int8_t txDmaCh;		/*!< GPDMA channel for Chip_UART_SendDMA(), or -1 if unused */
+	UART_DMA_TX_REQ_T *txDmaActive;		/*!< Requests chained on the running channel */
+	UART_DMA_TX_REQ_T *txDmaPend;		/*!< Requests waiting for the next chain */
+	UART_DMA_TX_REQ_T *txDmaPendTail;	/*!< Last waiting request */
+} UART_RB_CTX_T;
+
 /**
  * @brief	Configure data width, parity mode and stop bits
  * @param	pUART		: Pointer to selected pUART peripheral
@@ -251,33 +305,130 @@ IP_UART_INT_STATUS_T Chip_UART_GetIntStatus(LPC_USART_T *pUART);
  * @brief	Uart interrupt service routine (chip layer)
  * @param	pUART	: Pointer to selected pUART peripheral
  * @return	Nothing
+ * @note	Moves data between the UART and the ring buffers attached to
+ *			this port with Chip_UART_InitRingBuffer(). Call it from the
+ *			IRQ handler of each UART used in interrupt mode.
  */
 void Chip_UART_Interrupt_Handler (LPC_USART_T *pUART);
 
 /**
  * @brief	UART transmit function for interrupt mode (using ring buffers)
- * @param	pUART	: Selected UART peripheral used to send data, should be UART0
+ * @param	pUART	: Selected UART peripheral used to send data
  * @param	txbuf	: Pointer to Transmit buffer
  * @param	buflen	: Length of Transmit buffer
  * @return	Number of bytes actually sent to the ring buffer
  */
-uint32_t Chip_UART_Interrupt_Transmit(LPC_USART_T *pUART, uint8_t *txbuf, uint8_t buflen);
+uint32_t Chip_UART_Interrupt_Transmit(LPC_USART_T *pUART, const uint8_t *txbuf, uint32_t buflen);
 
 /**
  * @brief	UART read function for interrupt mode (using ring buffers)
- * @param	pUART	: Selected UART peripheral used to send data, should be UART0
+ * @param	pUART	: Selected UART peripheral used to receive data
  * @param	rxbuf	: Pointer to Received buffer
  * @param	buflen	: Length of Received buffer
  * @return	Number of bytes actually read from the ring buffer
  */
-uint32_t Chip_UART_Interrupt_Receive(LPC_USART_T *pUART, uint8_t *rxbuf, uint8_t buflen);
+uint32_t Chip_UART_Interrupt_Receive(LPC_USART_T *pUART, uint8_t *rxbuf, uint32_t buflen);
+
+/**
+ * @brief	Attach Tx and Rx ring buffers to a UART port and reset them
+ * @param	pUART	: Pointer to selected UART peripheral
+ * @param	pCtx	: Pointer to the ring buffer context for this port
+ * @param	txBuf	: Pointer to transmit ring buffer storage
+ * @param	txSize	: Size of txBuf in bytes, must be a power of 2
+ * @param	rxBuf	: Pointer to receive ring buffer storage
+ * @param	rxSize	: Size of rxBuf in bytes, must be a power of 2
+ * @return	SUCCESS, or ERROR if a size is not a power of 2
+ * @note	Each port needs its own context and storage, which must stay
+ *			valid for as long as the port is used in interrupt mode.
+ */
+Status Chip_UART_InitRingBuffer(LPC_USART_T *pUART, UART_RB_CTX_T *pCtx,
+								uint8_t *txBuf, int txSize, uint8_t *rxBuf, int rxSize);
+
+/**
+ * @brief	Receive into the ring buffer of a UART port with the GPDMA
+ * @param	pUART		: Pointer to selected UART peripheral
+ * @param	ChannelNum	: GPDMA channel to use, obtained with Chip_DMA_GetFreeChannel()
+ * @param	rxCallback	: Called with the number of new bytes, may be NULL
+ * @return	SUCCESS, or ERROR if no ring buffer is attached, the receive ring
+ *			is larger than 4096 bytes or the channel could not be started
+ * @note	The receive ring attached with Chip_UART_InitRingBuffer() is split
+ *			into two halves that the GPDMA fills forever through a circular
+ *			pair of descriptors. New data is published to the ring on each half
+ *			and full completion (GPDMA interrupt) and on the
+ *			character time-out interrupt (Chip_UART_Interrupt_Handler(), with
+ *			the RBR interrupt enabled), and is read back with
+ *			Chip_UART_Interrupt_Receive(). The UART FIFOs must be configured
+ *			with FIFO_DMAMode = ENABLE, and the GPDMA initialized. Data that is
+ *			not read within one ring lap is overwritten, oldest first, and
+ *			counted in the rxDmaOverrun field of the port context.
+ */
+Status Chip_UART_DMA_RxStart(LPC_USART_T *pUART, uint8_t ChannelNum, UART_DMA_RX_FUNC_T rxCallback);
+
+/**
+ * @brief	Stop receiving with the GPDMA and go back to interrupt receive
+ * @param	pUART	: Pointer to selected UART peripheral
+ * @return	Nothing
+ * @note	Data already received stays in the receive ring buffer.
+ */
+void Chip_UART_DMA_RxStop(LPC_USART_T *pUART);
+
+/**
+ * @brief	Publish the data the GPDMA has written so far to the receive ring
+ * @param	pUART	: Pointer to selected UART peripheral
+ * @return	Number of new bytes in the receive ring buffer
+ * @note	Called by the interrupt handlers, it may also be used to poll
+ *			from the interrupt context of the UART or GPDMA.
+ */
+uint32_t Chip_UART_DMA_RxSync(LPC_USART_T *pUART);
+
+/**
+ * @brief	GPDMA interrupt service for the receive channel of a UART port
+ * @param	pUART	: Pointer to selected UART peripheral
+ * @return	Nothing
+ * @note	Only needed when DMA_IRQHandler does not call
+ *			Chip_GPDMA_Interrupt_Handler(), which services the channel itself.
+ */
+void Chip_UART_DMA_RxInterrupt(LPC_USART_T *pUART);
+
+/**
+ * @brief	Assign a GPDMA channel to Chip_UART_SendDMA() on a UART port
+ * @param	pUART		: Pointer to selected UART peripheral
+ * @param	ChannelNum	: GPDMA channel to use, obtained with Chip_DMA_GetFreeChannel()
+ * @return	SUCCESS, or ERROR if no ring buffer context is attached
+ * @note	The UART FIFOs must be configured with FIFO_DMAMode = ENABLE, and
+ *			the GPDMA initialized. Chip_UART_Interrupt_Transmit() must not be
+ *			used on the same port at the same time.
+ */
+Status Chip_UART_DMA_TxInit(LPC_USART_T *pUART, uint8_t ChannelNum);
+
+/**
+ * @brief	Queue buffers for transmission with the GPDMA (zero-copy)
+ * @param	pUART	: Pointer to selected UART peripheral
+ * @param	pReq	: First of one or more requests linked through their next field
+ * @return	SUCCESS, or ERROR if no channel is assigned or a length is out of range
+ * @note	Returns at once. Each buffer is sent in place, in queue order, and
+ *			its callback is called when the GPDMA is done with it, after which
+ *			the request and buffer belong to the caller again. Requests queued
+ *			while the channel runs are chained and started together as soon as
+ *			the running chain ends.
+ */
+Status Chip_UART_SendDMA(LPC_USART_T *pUART, UART_DMA_TX_REQ_T *pReq);
+
+/**
+ * @brief	Abort GPDMA transmission, queued requests complete with ERROR
+ * @param	pUART	: Pointer to selected UART peripheral
+ * @return	Nothing
+ */
+void Chip_UART_DMA_TxStop(LPC_USART_T *pUART);
 
 /**
- * @brief	Reset Tx and Rx ring buffer (head and tail)
+ * @brief	GPDMA interrupt service for the transmit channel of a UART port
  * @param	pUART	: Pointer to selected UART peripheral
  * @return	Nothing
+ * @note	Only needed when DMA_IRQHandler does not call
+ *			Chip_GPDMA_Interrupt_Handler(), which services the channel itself.
  */
-void Chip_UART_InitRingBuffer(LPC_USART_T *pUART);
+void Chip_UART_DMA_TxInterrupt(LPC_USART_T *pUART);
 
 /**
  * @brief	Start/Stop Auto Baudrate activity
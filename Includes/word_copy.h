@@ -0,0 +1,26 @@
+/*
+ * @brief Block copy shared by the library modules
+ *
+ * @note
+ * Internal to the library, not included from chip.h and not part of the
+ * driver API. The ring buffer moves its items with it, and the GPDMA
+ * driver uses it for the copies it leaves to the CPU.
+ */
+
+#ifndef __WORD_COPY_H_
+#define __WORD_COPY_H_
+
+#include "lpc_types.h"
+
+/**
+ * @brief	Copy a block of bytes
+ * @param	dst		: Destination
+ * @param	src		: Source, must not overlap dst
+ * @param	bytes	: Number of bytes
+ * @return	Nothing
+ * @note	Moves four words per pass (LDM/STM) when both ends are word
+ *			aligned, bytes otherwise.
+ */
+void WordCopy(void *dst, const void *src, int bytes);
+
+#endif /* __WORD_COPY_H_ */
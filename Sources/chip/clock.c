@@ -68,6 +68,9 @@ static const CLK_PERIPH_TO_BASE_T periph_to_base[] = {
 #endif
 };
 
+/* Bumped by every call that may change a clock rate */
+static volatile uint32_t ClockGeneration;
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -244,6 +247,7 @@ uint32_t Chip_Clock_SetupMainPLLMult(CHIP_CGU_CLKIN_T Input, uint32_t mult)
 		return 0;
 	}
 	LPC_CGU->PLL1_CTRL = PLLReg & ~(1 << 0);
+	ClockGeneration++;
 
 	return freq;
 }
@@ -284,6 +288,7 @@ void Chip_Clock_DisableMainPLL(void)
 {
 	/* power down main PLL */
 	LPC_CGU->PLL1_CTRL |= 1;
+	ClockGeneration++;
 }
 
 /* Disables the main PLL */
@@ -291,6 +296,7 @@ void Chip_Clock_EnableMainPLL(void)
 {
 	/* power down main PLL */
 	LPC_CGU->PLL1_CTRL &= ~1;
+	ClockGeneration++;
 }
 
 /* Returns the lock status of the main PLL */
@@ -317,6 +323,7 @@ void Chip_Clock_SetDivider(CHIP_CGU_IDIV_T Divider, CHIP_CGU_CLKIN_T Input, uint
 	else {
 		LPC_CGU->IDIV_CTRL[Divider] = reg | 1;	/* Power down this divider */
 	}
+	ClockGeneration++;
 }
 
 /* Gets a CGU clock divider source */
@@ -457,6 +464,7 @@ void Chip_Clock_SetBaseClock(CHIP_CGU_BASE_CLK_T BaseClock, CHIP_CGU_CLKIN_T Inp
 	else {
 		LPC_CGU->BASE_CLK[BaseClock] = reg | 1;	/* Power down this base clock */
 	}
+	ClockGeneration++;
 }
 
 /* Reads CGU Base Clock clock source information */
@@ -554,6 +562,7 @@ void Chip_Clock_EnableOpts(CHIP_CCU_CLK_T clk, bool autoen, bool wakeupen, int d
 	else {
 		LPC_CCU1->CLKCCU[clk].CFG = reg;
 	}
+	ClockGeneration++;
 }
 
 /* Enables a peripheral clock */
@@ -656,18 +665,27 @@ void Chip_Clock_SetupPLL(CHIP_CGU_CLKIN_T Input, CHIP_CGU_USB_AUDIO_PLL_T pllnum
 	if (pllnum == pllnum) {
 		LPC_CGU->PLL0AUDIO_FRAC = pPLLSetup->fract;
 	}
+	ClockGeneration++;
 }
 
 /* Enables the audio or USB PLL */
 void Chip_Clock_EnablePLL(CHIP_CGU_USB_AUDIO_PLL_T pllnum)
 {
 	LPC_CGU->PLL[pllnum].PLL_CTRL &= ~1;
+	ClockGeneration++;
 }
 
 /* Disables the audio or USB PLL */
 void Chip_Clock_DisablePLL(CHIP_CGU_USB_AUDIO_PLL_T pllnum)
 {
 	LPC_CGU->PLL[pllnum].PLL_CTRL |= 1;
+	ClockGeneration++;
+}
+
+/* Count of clock rate changes */
+uint32_t Chip_Clock_GetGeneration(void)
+{
+	return ClockGeneration;
 }
 
 /* Returns the PLL status */
@@ -30,13 +30,74 @@
  */
 
 #include "chip.h"
+#include "word_copy.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
  ****************************************************************************/
 
-/* Channel array to monitor free channel */
-static DMA_ChannelHandle_t ChannelHandlerArray[GPDMA_NUMBER_CHANNELS];
+/* Allocated channels, one bit per channel */
+static __IO uint32_t ChannelAllocMask;
+
+/* Channels allocated with Chip_DMA_AllocChannel(), which only
+   Chip_DMA_ReleaseChannel() frees */
+static __IO uint32_t ChannelOwnedMask;
+
+/* Completion callback of each channel */
+static GPDMA_CALLBACK_T ChannelCallback[GPDMA_NUMBER_CHANNELS];
+static void *ChannelUserData[GPDMA_NUMBER_CHANNELS];
+
+/* Memory copy/fill running on a channel: caller's callback and the fill
+   pattern the GPDMA reads from */
+typedef struct {
+	GPDMA_CALLBACK_T callback;
+	void *pUserData;
+	uint32_t fill;
+} GPDMA_MEMOP_T;
+
+static GPDMA_MEMOP_T ChannelMemOp[GPDMA_NUMBER_CHANNELS];
+
+/* Rectangle copy/fill running on a channel: the next line still to do,
+   the scanline control word and the fill pattern the GPDMA reads from */
+typedef struct {
+	GPDMA_CALLBACK_T callback;
+	void *pUserData;
+	uint32_t src;
+	uint32_t dst;
+	uint32_t srcStride;
+	uint32_t dstStride;
+	uint32_t lines;
+	uint32_t ctrl;
+	uint32_t fill;
+} GPDMA_BLITOP_T;
+
+static GPDMA_BLITOP_T ChannelBlitOp[GPDMA_NUMBER_CHANNELS];
+
+/* Most scanlines chained per batch, leaves the pool to other users too */
+#define GPDMA_BLIT_LINES 16
+
+/* Smallest memory copy/fill handed to the GPDMA */
+static uint32_t MemDmaThreshold = GPDMA_MEM_DMA_THRESHOLD;
+
+/* Virtual channels waiting for a free physical channel, in arrival order */
+static DMA_VChannel_t *VChannelWaitHead;
+static DMA_VChannel_t *VChannelWaitTail;
+
+/* Called when channels may have been freed, in registration order, and
+   their reentry guard */
+static DMA_ReleaseWaiter_t *ReleaseWaiters;
+static bool ReleaseWaitersBusy;
+
+/* Transfers per descriptor when splitting, a whole number of 32 transfer bursts */
+#define GPDMA_CHUNK_SIZE 0xFE0
+
+/* Descriptor pool for split transfers and its allocation bitmap */
+static DMA_TransferDescriptor_t DescPool[GPDMA_DESC_POOL_SIZE];
+static uint32_t DescUsedMask[(GPDMA_DESC_POOL_SIZE + 31) / 32];
+
+/* Pool descriptors chained on each channel, first index (-1 for none) and count */
+static int16_t ChannelChainFirst[GPDMA_NUMBER_CHANNELS];
+static uint16_t ChannelChainNum[GPDMA_NUMBER_CHANNELS];
 
 /* Optimized Peripheral Source and Destination burst size (18xx,43xx) */
 static const uint8_t GPDMA_LUTPerBurst[] = {
@@ -140,6 +201,81 @@ volatile static const void *GPDMA_LUTPerAddr[] = {
 	(&LPC_I2S0->RXFIFO)				/* I2S channel 0      */
 };
 
+/* Connections where the peripheral is the source of the data (read by the DMA) */
+#define GPDMA_CONN_SRC_MASK ((1UL << GPDMA_CONN_UART0_Rx) | (1UL << GPDMA_CONN_UART1_Rx) | \
+							 (1UL << GPDMA_CONN_UART2_Rx) | (1UL << GPDMA_CONN_UART3_Rx) | \
+							 (1UL << GPDMA_CONN_SSP0_Rx) | (1UL << GPDMA_CONN_SSP1_Rx) | \
+							 (1UL << GPDMA_CONN_I2S_Rx_Channel_1) | (1UL << GPDMA_CONN_ADC_0) | \
+							 (1UL << GPDMA_CONN_ADC_1) | (1UL << GPDMA_CONN_I2S_Rx_Channel_0))
+
+/* Lookup Table of Connection Type matched with (18xx,43xx) GPDMA request line */
+static const uint8_t GPDMA_LUTPerReq[] = {
+	0,	/* MEMORY             */
+	1,	/* MAT0.0             */
+	1,	/* UART0 Tx           */
+	2,	/* MAT0.1             */
+	2,	/* UART0 Rx           */
+	3,	/* MAT1.0             */
+	3,	/* UART1 Tx           */
+	4,	/* MAT1.1             */
+	4,	/* UART1 Rx           */
+	5,	/* MAT2.0             */
+	5,	/* UART2 Tx           */
+	6,	/* MAT2.1             */
+	6,	/* UART2 Rx           */
+	7,	/* MAT3.0             */
+	7,	/* UART3 Tx           */
+	7,	/* SCT timer channel 0*/
+	8,	/* MAT3.1             */
+	8,	/* UART3 Rx           */
+	8,	/* SCT timer channel 1*/
+	9,	/* SSP0 Rx            */
+	9,	/* I2S channel 0      */
+	10,	/* SSP0 Tx            */
+	10,	/* I2S channel 1      */
+	11,	/* SSP1 Rx            */
+	12,	/* SSP1 Tx            */
+	13,	/* ADC 0              */
+	14,	/* ADC 1              */
+	15,	/* DAC                */
+	10,	/* I2S channel 1      */
+	9	/* I2S channel 0      */
+};
+
+/* Lookup Table of Connection Type matched with (18xx,43xx) DMAMUX function of its request line */
+static const uint8_t GPDMA_LUTPerMux[] = {
+	0,	/* MEMORY             */
+	0,	/* MAT0.0             */
+	1,	/* UART0 Tx           */
+	0,	/* MAT0.1             */
+	1,	/* UART0 Rx           */
+	0,	/* MAT1.0             */
+	1,	/* UART1 Tx           */
+	0,	/* MAT1.1             */
+	1,	/* UART1 Rx           */
+	0,	/* MAT2.0             */
+	1,	/* UART2 Tx           */
+	0,	/* MAT2.1             */
+	1,	/* UART2 Rx           */
+	0,	/* MAT3.0             */
+	1,	/* UART3 Tx           */
+	2,	/* SCT timer channel 0*/
+	0,	/* MAT3.1             */
+	1,	/* UART3 Rx           */
+	2,	/* SCT timer channel 1*/
+	0,	/* SSP0 Rx            */
+	1,	/* I2S channel 0      */
+	0,	/* SSP0 Tx            */
+	1,	/* I2S channel 1      */
+	0,	/* SSP1 Rx            */
+	0,	/* SSP1 Tx            */
+	0,	/* ADC 0              */
+	0,	/* ADC 1              */
+	0,	/* DAC                */
+	1,	/* I2S channel 1      */
+	1	/* I2S channel 0      */
+};
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -151,158 +287,643 @@ volatile static const void *GPDMA_LUTPerAddr[] = {
 /* Control which set of peripherals is connected to the DMA controller */
 static uint8_t DMAMUX_Config(uint32_t gpdma_peripheral_connection_number)
 {
-	uint8_t function, channel;
+	uint8_t channel = GPDMA_LUTPerReq[gpdma_peripheral_connection_number];
 
-	switch (gpdma_peripheral_connection_number) {
-	case GPDMA_CONN_MAT0_0:
-		function = 0;
-		channel = 1;
-		break;
+	/* Set select function to dmamux register */
+	if (0 != gpdma_peripheral_connection_number) {
+		uint32_t temp;
+		temp = LPC_CREG->DMAMUX & (~(0x03 << (2 * channel)));
+		LPC_CREG->DMAMUX = temp | (GPDMA_LUTPerMux[gpdma_peripheral_connection_number] << (2 * channel));
+	}
+	return channel;
+}
 
-	case GPDMA_CONN_UART0_Tx:
-		function = 1;
-		channel = 1;
-		break;
+/* Find the connection of a peripheral data register address, as stored in a
+   prepared descriptor. Rx and Tx often share one register, so the direction
+   selects between them. Returns GPDMA_CONN_MEMORY if there is no match. */
+static uint32_t Chip_DMA_AddrToConn(uint32_t addr, bool isSrc)
+{
+	uint32_t conn;
 
-	case GPDMA_CONN_MAT0_1:
-		function = 0;
-		channel = 2;
-		break;
+	for (conn = 1; conn < (sizeof(GPDMA_LUTPerAddr) / sizeof(GPDMA_LUTPerAddr[0])); conn++) {
+		if (((uint32_t) (uintptr_t) GPDMA_LUTPerAddr[conn] == addr) &&
+			((((GPDMA_CONN_SRC_MASK >> conn) & 1) != 0) == isSrc)) {
+			return conn;
+		}
+	}
+	return GPDMA_CONN_MEMORY;
+}
 
-	case GPDMA_CONN_UART0_Rx:
-		function = 1;
-		channel = 2;
-		break;
+/* Take num consecutive descriptors from the pool, returns the first index or -1 */
+static int Chip_DMA_AllocDesc(uint32_t num)
+{
+	uint32_t i, run = 0, primask;
+	int first = -1;
 
-	case GPDMA_CONN_MAT1_0:
-		function = 0;
-		channel = 3;
-		break;
+	primask = __get_PRIMASK();
+	__disable_irq();
 
-	case GPDMA_CONN_UART1_Tx:
-		function = 1;
-		channel = 3;
-		break;
+	for (i = 0; (i < GPDMA_DESC_POOL_SIZE) && (num > 0); i++) {
+		if (DescUsedMask[i >> 5] & (1UL << (i & 31))) {
+			run = 0;
+		}
+		else if (++run == num) {
+			first = (int) (i + 1 - num);
+			break;
+		}
+	}
+	for (i = 0; (first >= 0) && (i < num); i++) {
+		DescUsedMask[(first + i) >> 5] |= 1UL << ((first + i) & 31);
+	}
 
-	case GPDMA_CONN_MAT1_1:
-		function = 0;
-		channel = 4;
-		break;
+	__set_PRIMASK(primask);
+	return first;
+}
 
-	case GPDMA_CONN_UART1_Rx:
-		function = 1;
-		channel = 4;
-		break;
+/* Give the pool descriptors chained on a channel back */
+static void Chip_DMA_FreeChain(uint8_t ChannelNum)
+{
+	uint32_t i, idx, primask;
 
-	case GPDMA_CONN_MAT2_0:
-		function = 0;
-		channel = 5;
-		break;
+	primask = __get_PRIMASK();
+	__disable_irq();
 
-	case GPDMA_CONN_UART2_Tx:
-		function = 1;
-		channel = 5;
-		break;
+	if (ChannelChainFirst[ChannelNum] >= 0) {
+		for (i = 0; i < ChannelChainNum[ChannelNum]; i++) {
+			idx = ChannelChainFirst[ChannelNum] + i;
+			DescUsedMask[idx >> 5] &= ~(1UL << (idx & 31));
+		}
+		ChannelChainFirst[ChannelNum] = -1;
+		ChannelChainNum[ChannelNum] = 0;
+	}
 
-	case GPDMA_CONN_MAT2_1:
-		function = 0;
-		channel = 6;
-		break;
+	__set_PRIMASK(primask);
+}
 
-	case GPDMA_CONN_UART2_Rx:
-		function = 1;
-		channel = 6;
-		break;
+/* Split a transfer too large for one control word. The first segment is
+   loaded straight into the channel, the rest are chained from the pool.
+   Returns the control word and next descriptor for the channel registers. */
+static Status Chip_DMA_BuildChain(uint8_t ChannelNum, const GPDMA_Channel_CFG_T *GPDMACfg,
+								  uint32_t ctrl, uint32_t *pFirstCtrl, uint32_t *pLLI)
+{
+	DMA_TransferDescriptor_t *dsc;
+	uint32_t src = GPDMACfg->SrcAddr, dst = GPDMACfg->DstAddr;
+	uint32_t left = GPDMACfg->TransferSize - GPDMA_CHUNK_SIZE;
+	uint32_t num = (left + GPDMA_CHUNK_SIZE - 1) / GPDMA_CHUNK_SIZE;
+	uint32_t srcStep = 0, dstStep = 0, seg, i;
+	int first;
+
+	first = Chip_DMA_AllocDesc(num);
+	if (first < 0) {
+		return ERROR;
+	}
+	ChannelChainFirst[ChannelNum] = (int16_t) first;
+	ChannelChainNum[ChannelNum] = (uint16_t) num;
+
+	/* Addresses advance by a segment of transfers of the source and
+	   destination widths (control bits 18 and 21) when incrementing */
+	ctrl &= ~(GPDMA_DMACCxControl_TransferSize(GPDMA_MAX_XFER_SIZE) | GPDMA_DMACCxControl_I);
+	if (ctrl & GPDMA_DMACCxControl_SI) {
+		srcStep = GPDMA_CHUNK_SIZE << ((ctrl >> 18) & 0x7);
+	}
+	if (ctrl & GPDMA_DMACCxControl_DI) {
+		dstStep = GPDMA_CHUNK_SIZE << ((ctrl >> 21) & 0x7);
+	}
 
-	case GPDMA_CONN_MAT3_0:
-		function = 0;
-		channel = 7;
-		break;
+	*pFirstCtrl = ctrl | GPDMA_DMACCxControl_TransferSize(GPDMA_CHUNK_SIZE);
+	*pLLI = (uint32_t) (uintptr_t) &DescPool[first];
 
-	case GPDMA_CONN_UART3_Tx:
-		function = 1;
-		channel = 7;
-		break;
+	for (i = 0; i < num; i++) {
+		src += srcStep;
+		dst += dstStep;
+		seg = (left > GPDMA_CHUNK_SIZE) ? GPDMA_CHUNK_SIZE : left;
+		left -= seg;
 
-	case GPDMA_CONN_SCT_0:
-		function = 2;
-		channel = 7;
-		break;
+		dsc = &DescPool[first + i];
+		dsc->src = src;
+		dsc->dst = dst;
+		dsc->ctrl = ctrl | GPDMA_DMACCxControl_TransferSize(seg);
+		dsc->lli = (i + 1 < num) ? (uint32_t) (uintptr_t) (dsc + 1) : 0;
+	}
 
-	case GPDMA_CONN_MAT3_1:
-		function = 0;
-		channel = 8;
-		break;
+	/* Interrupt once, at the end of the whole transfer */
+	DescPool[first + num - 1].ctrl |= GPDMA_DMACCxControl_I;
+	return SUCCESS;
+}
 
-	case GPDMA_CONN_UART3_Rx:
-		function = 1;
-		channel = 8;
-		break;
+/* Widest transfer width the memory addresses and byte count allow */
+static uint32_t Chip_DMA_MemWidth(uint32_t src, uint32_t dst, uint32_t Size)
+{
+	uint32_t align = src | dst | Size;
 
-	case GPDMA_CONN_SCT_1:
-		function = 2;
-		channel = 8;
-		break;
+	if ((align & 3) == 0) {
+		return GPDMA_WIDTH_WORD;
+	}
+	if ((align & 1) == 0) {
+		return GPDMA_WIDTH_HALFWORD;
+	}
+	return GPDMA_WIDTH_BYTE;
+}
 
-	case GPDMA_CONN_SSP0_Rx:
-		function = 0;
-		channel = 9;
-		break;
+/* CPU fill, four words per pass (STM) once the destination is word aligned */
+static void Chip_DMA_CpuFill(uint8_t *dst, uint32_t fill, uint32_t len)
+{
+	uint32_t *d32;
 
-	case GPDMA_CONN_I2S_Tx_Channel_0:
-	case GPDMA_CONN_I2S_Rx_Channel_0:
-		function = 1;
-		channel = 9;
-		break;
+	for (; (len > 0) && (((uintptr_t) dst & 3) != 0); len--) {
+		*dst++ = (uint8_t) fill;
+	}
 
-	case GPDMA_CONN_SSP0_Tx:
-		function = 0;
-		channel = 10;
-		break;
+	d32 = (uint32_t *) dst;
+	for (; len >= 16; len -= 16) {
+		d32[0] = fill;
+		d32[1] = fill;
+		d32[2] = fill;
+		d32[3] = fill;
+		d32 += 4;
+	}
+	for (; len >= 4; len -= 4) {
+		*d32++ = fill;
+	}
 
-	case GPDMA_CONN_I2S_Tx_Channel_1:
-	case GPDMA_CONN_I2S_Rx_Channel_1:
-		function = 1;
-		channel = 10;
-		break;
+	dst = (uint8_t *) d32;
+	while (len--) {
+		*dst++ = (uint8_t) fill;
+	}
+}
 
-	case GPDMA_CONN_SSP1_Rx:
-		function = 0;
-		channel = 11;
-		break;
+/* Allocate the first free channel in the given scan direction */
+static uint8_t Chip_DMA_ClaimChannel(LPC_GPDMA_T *pGPDMA, GPDMA_PRIO_T priority, bool owned)
+{
+	uint32_t free, primask;
+	uint8_t ch = GPDMA_CHANNEL_NONE;
 
-	case GPDMA_CONN_SSP1_Tx:
-		function = 0;
-		channel = 12;
-		break;
+	primask = __get_PRIMASK();
+	__disable_irq();
 
-	case GPDMA_CONN_ADC_0:
-		function = 0;
-		channel = 13;
-		break;
+	free = ~(ChannelAllocMask | pGPDMA->ENBLDCHNS) & ((1UL << GPDMA_NUMBER_CHANNELS) - 1);
+	if (free != 0) {
+		/* Lower channels win arbitration */
+		if (priority == GPDMA_PRIO_HIGH) {
+			ch = (uint8_t) __CLZ(__RBIT(free));
+		}
+		else {
+			ch = (uint8_t) (31 - __CLZ(free));
+		}
 
-	case GPDMA_CONN_ADC_1:
-		function = 0;
-		channel = 14;
-		break;
+		ChannelAllocMask |= 1UL << ch;
+		if (owned) {
+			ChannelOwnedMask |= 1UL << ch;
+		}
+	}
 
-	case GPDMA_CONN_DAC:
-		function = 0;
-		channel = 15;
-		break;
+	__set_PRIMASK(primask);
+	return ch;
+}
 
-	default:
-		function = 3;
-		channel = 15;
-		break;
+/* Start a memory to memory transfer of Size bytes, from a fixed source
+   address for a fill */
+static Status Chip_DMA_StartMem(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum,
+								uint32_t src, uint32_t dst, uint32_t Size, bool srcInc)
+{
+	GPDMA_Channel_CFG_T GPDMACfg;
+	uint32_t cwrd, lli = 0;
+
+	Chip_DMA_InitChannelCfg(pGPDMA, &GPDMACfg, ChannelNum, src, dst, Size,
+							GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA);
+	cwrd = IP_GPDMA_MakeCtrlWord(&GPDMACfg, 0, 0, 0, 0);
+	if (!srcInc) {
+		cwrd &= ~GPDMA_DMACCxControl_SI;
 	}
-	/* Set select function to dmamux register */
-	if (0 != gpdma_peripheral_connection_number) {
-		uint32_t temp;
-		temp = LPC_CREG->DMAMUX & (~(0x03 << (2 * channel)));
-		LPC_CREG->DMAMUX = temp | (function << (2 * channel));
+
+	Chip_DMA_FreeChain(ChannelNum);
+	if (GPDMACfg.TransferSize > GPDMA_MAX_XFER_SIZE) {
+		if (Chip_DMA_BuildChain(ChannelNum, &GPDMACfg, cwrd, &cwrd, &lli) == ERROR) {
+			return ERROR;
+		}
 	}
-	return channel;
+
+	if (IP_GPDMA_Setup(pGPDMA, &GPDMACfg, cwrd, lli, 0, 0) == ERROR) {
+		Chip_DMA_FreeChain(ChannelNum);
+		return ERROR;
+	}
+	IP_GPDMA_ChannelCmd(pGPDMA, ChannelNum, ENABLE);
+	return SUCCESS;
+}
+
+/* Channel callback of a memory copy/fill, frees the channel before
+   telling the caller, which may already have it again */
+static void Chip_DMA_MemDone(uint8_t ChannelNum, Status result, void *pUserData)
+{
+	GPDMA_MEMOP_T *pOp = (GPDMA_MEMOP_T *) pUserData;
+	GPDMA_CALLBACK_T callback = pOp->callback;
+	void *pCbData = pOp->pUserData;
+
+	Chip_DMA_ReleaseChannel(LPC_GPDMA, ChannelNum);
+	if (callback != NULL) {
+		callback(GPDMA_CHANNEL_NONE, result, pCbData);
+	}
+}
+
+/* Copy (src not NULL) or fill len bytes. The unaligned head and tail are
+   done by the CPU, the middle by the GPDMA at the widest common width
+   when it is large enough and a channel is free. */
+static Status Chip_DMA_MemOp(LPC_GPDMA_T *pGPDMA, uint8_t *dst, const uint8_t *src, uint32_t fill,
+							 uint32_t len, GPDMA_CALLBACK_T callback, void *pUserData)
+{
+	uint32_t unit = 4, head, body;
+	uint8_t ch = GPDMA_CHANNEL_NONE;
+
+	if (src != NULL) {
+		if ((((uintptr_t) dst ^ (uintptr_t) src) & 3) != 0) {
+			unit = ((((uintptr_t) dst ^ (uintptr_t) src) & 1) != 0) ? 1 : 2;
+		}
+	}
+	head = (uint32_t) (0 - (uintptr_t) dst) & (unit - 1);
+	if (head > len) {
+		head = len;
+	}
+	body = (len - head) & ~(unit - 1);
+
+	if (body >= MemDmaThreshold) {
+		ch = Chip_DMA_AllocChannel(pGPDMA, GPDMA_PRIO_LOW);
+	}
+	if (ch == GPDMA_CHANNEL_NONE) {
+		/* Small, or no channel free: done now */
+		head = len;
+		body = 0;
+	}
+
+	/* The CPU does the ends first, the callback must not run before
+	   they are written */
+	if (src != NULL) {
+		WordCopy(dst, src, head);
+		WordCopy(dst + head + body, src + head + body, len - head - body);
+	}
+	else {
+		Chip_DMA_CpuFill(dst, fill, head);
+		Chip_DMA_CpuFill(dst + head + body, fill, len - head - body);
+	}
+
+	if (ch != GPDMA_CHANNEL_NONE) {
+		ChannelMemOp[ch].callback = callback;
+		ChannelMemOp[ch].pUserData = pUserData;
+		ChannelMemOp[ch].fill = fill;
+		Chip_DMA_SetCallback(pGPDMA, ch, Chip_DMA_MemDone, &ChannelMemOp[ch]);
+
+		if (Chip_DMA_StartMem(pGPDMA, ch,
+							  (src != NULL) ? (uint32_t) (uintptr_t) (src + head) : (uint32_t) (uintptr_t) &ChannelMemOp[ch].fill,
+							  (uint32_t) (uintptr_t) (dst + head), body, src != NULL) == SUCCESS) {
+			return SUCCESS;
+		}
+
+		Chip_DMA_ReleaseChannel(pGPDMA, ch);
+		if (src != NULL) {
+			WordCopy(dst + head, src + head, body);
+		}
+		else {
+			Chip_DMA_CpuFill(dst + head, fill, body);
+		}
+	}
+
+	if (callback != NULL) {
+		callback(GPDMA_CHANNEL_NONE, SUCCESS, pUserData);
+	}
+	return SUCCESS;
+}
+
+/* Start the next batch of scanlines of a rectangle. The first line is
+   loaded into the channel, the following ones are chained from the pool,
+   fewer when the pool is short, and only the last one interrupts. */
+static Status Chip_DMA_BlitRun(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum)
+{
+	GPDMA_BLITOP_T *pOp = &ChannelBlitOp[ChannelNum];
+	GPDMA_Channel_CFG_T GPDMACfg;
+	DMA_TransferDescriptor_t *dsc;
+	uint32_t num, i, lli = 0;
+	int first = -1;
+
+	num = (pOp->lines > GPDMA_BLIT_LINES) ? GPDMA_BLIT_LINES : pOp->lines;
+	for (num = num - 1; num > 0; num >>= 1) {
+		first = Chip_DMA_AllocDesc(num);
+		if (first >= 0) {
+			break;
+		}
+	}
+
+	if (num > 0) {
+		ChannelChainFirst[ChannelNum] = (int16_t) first;
+		ChannelChainNum[ChannelNum] = (uint16_t) num;
+		lli = (uint32_t) (uintptr_t) &DescPool[first];
+		for (i = 0; i < num; i++) {
+			dsc = &DescPool[first + i];
+			dsc->src = pOp->src + ((i + 1) * pOp->srcStride);
+			dsc->dst = pOp->dst + ((i + 1) * pOp->dstStride);
+			dsc->ctrl = pOp->ctrl;
+			dsc->lli = (i + 1 < num) ? (uint32_t) (uintptr_t) (dsc + 1) : 0;
+		}
+		DescPool[first + num - 1].ctrl |= GPDMA_DMACCxControl_I;
+	}
+
+	GPDMACfg.ChannelNum = ChannelNum;
+	GPDMACfg.TransferType = GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA;
+	GPDMACfg.SrcAddr = pOp->src;
+	GPDMACfg.DstAddr = pOp->dst;
+	if (IP_GPDMA_Setup(pGPDMA, &GPDMACfg, (num > 0) ? pOp->ctrl : (pOp->ctrl | GPDMA_DMACCxControl_I),
+					   lli, 0, 0) == ERROR) {
+		Chip_DMA_FreeChain(ChannelNum);
+		return ERROR;
+	}
+
+	pOp->src += (num + 1) * pOp->srcStride;
+	pOp->dst += (num + 1) * pOp->dstStride;
+	pOp->lines -= num + 1;
+	IP_GPDMA_ChannelCmd(pGPDMA, ChannelNum, ENABLE);
+	return SUCCESS;
+}
+
+/* Channel callback of a rectangle copy/fill, the chain of the batch just
+   done has been given back already */
+static void Chip_DMA_BlitDone(uint8_t ChannelNum, Status result, void *pUserData)
+{
+	GPDMA_BLITOP_T *pOp = (GPDMA_BLITOP_T *) pUserData;
+	GPDMA_CALLBACK_T callback = pOp->callback;
+	void *pCbData = pOp->pUserData;
+
+	if ((result == SUCCESS) && (pOp->lines > 0)) {
+		result = Chip_DMA_BlitRun(LPC_GPDMA, ChannelNum);
+		if (result == SUCCESS) {
+			return;
+		}
+	}
+
+	Chip_DMA_ReleaseChannel(LPC_GPDMA, ChannelNum);
+	if (callback != NULL) {
+		callback(GPDMA_CHANNEL_NONE, result, pCbData);
+	}
+}
+
+/* Copy (src not NULL) or fill a rectangle of lineBytes wide lines */
+static Status Chip_DMA_BlitOp(LPC_GPDMA_T *pGPDMA, uint8_t *dst, const uint8_t *src, uint32_t fill,
+							  uint32_t lineBytes, uint32_t height, uint32_t srcStride,
+							  uint32_t dstStride, uint32_t pixelSize,
+							  GPDMA_CALLBACK_T callback, void *pUserData)
+{
+	GPDMA_Channel_CFG_T GPDMACfg;
+	uint32_t width, line, i;
+	bool cpu = false;
+	uint8_t ch;
+
+	if (((pixelSize != 1) && (pixelSize != 2) && (pixelSize != 4)) || (lineBytes == 0) || (height == 0)) {
+		return ERROR;
+	}
+
+	/* Every line start and the line length must suit the transfer width */
+	if (src != NULL) {
+		width = Chip_DMA_MemWidth((uint32_t) (uintptr_t) src | srcStride, (uint32_t) (uintptr_t) dst | dstStride, lineBytes);
+	}
+	else {
+		width = Chip_DMA_MemWidth((uint32_t) (uintptr_t) dst | dstStride, 0, lineBytes);
+	}
+	if ((lineBytes >> width) > GPDMA_MAX_XFER_SIZE) {
+		return ERROR;
+	}
+
+	/* A fill narrower than a pixel repeats the low part of the colour over
+	   every part of the pixel, only the CPU gets other colours right */
+	if ((src == NULL) && ((1UL << width) < pixelSize)) {
+		if (width == GPDMA_WIDTH_BYTE) {
+			cpu = fill != ((fill & 0xFF) * 0x01010101UL);
+		}
+		else {
+			cpu = fill != ((fill & 0xFFFF) * 0x00010001UL);
+		}
+	}
+
+	ch = cpu ? GPDMA_CHANNEL_NONE : Chip_DMA_AllocChannel(pGPDMA, GPDMA_PRIO_LOW);
+	if (ch == GPDMA_CHANNEL_NONE) {
+		for (line = 0; line < height; line++) {
+			if (src != NULL) {
+				WordCopy(dst + (line * dstStride), src + (line * srcStride), lineBytes);
+				continue;
+			}
+			for (i = line * dstStride; i < (line * dstStride) + lineBytes; i += pixelSize) {
+				if (pixelSize == 4) {
+					*(uint32_t *) (dst + i) = fill;
+				}
+				else if (pixelSize == 2) {
+					*(uint16_t *) (dst + i) = (uint16_t) fill;
+				}
+				else {
+					dst[i] = (uint8_t) fill;
+				}
+			}
+		}
+		if (callback != NULL) {
+			callback(GPDMA_CHANNEL_NONE, SUCCESS, pUserData);
+		}
+		return SUCCESS;
+	}
+
+	ChannelBlitOp[ch].callback = callback;
+	ChannelBlitOp[ch].pUserData = pUserData;
+	ChannelBlitOp[ch].fill = fill;
+	ChannelBlitOp[ch].src = (src != NULL) ? (uint32_t) (uintptr_t) src : (uint32_t) (uintptr_t) &ChannelBlitOp[ch].fill;
+	ChannelBlitOp[ch].dst = (uint32_t) (uintptr_t) dst;
+	ChannelBlitOp[ch].srcStride = srcStride;
+	ChannelBlitOp[ch].dstStride = dstStride;
+	ChannelBlitOp[ch].lines = height;
+
+	GPDMACfg.TransferType = GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA;
+	GPDMACfg.TransferSize = lineBytes >> width;
+	GPDMACfg.TransferWidth = width;
+	ChannelBlitOp[ch].ctrl = IP_GPDMA_MakeCtrlWord(&GPDMACfg, 0, 0, 0, 0) & ~GPDMA_DMACCxControl_I;
+	if (src == NULL) {
+		ChannelBlitOp[ch].ctrl &= ~GPDMA_DMACCxControl_SI;
+	}
+
+	Chip_DMA_FreeChain(ch);
+	Chip_DMA_SetCallback(pGPDMA, ch, Chip_DMA_BlitDone, &ChannelBlitOp[ch]);
+	if (Chip_DMA_BlitRun(pGPDMA, ch) == ERROR) {
+		Chip_DMA_ReleaseChannel(pGPDMA, ch);
+		return ERROR;
+	}
+	return SUCCESS;
+}
+
+/* Queue a virtual channel for the next free physical channel */
+static void Chip_DMA_VWait(DMA_VChannel_t *pVch)
+{
+	if (pVch->waiting) {
+		return;
+	}
+
+	pVch->waiting = true;
+	pVch->nextWaiting = NULL;
+	if (VChannelWaitTail != NULL) {
+		VChannelWaitTail->nextWaiting = pVch;
+	}
+	else {
+		VChannelWaitHead = pVch;
+	}
+	VChannelWaitTail = pVch;
+}
+
+/* Take the virtual channel that has waited longest */
+static DMA_VChannel_t *Chip_DMA_VUnwait(void)
+{
+	DMA_VChannel_t *pVch = VChannelWaitHead;
+
+	if (pVch != NULL) {
+		VChannelWaitHead = pVch->nextWaiting;
+		if (VChannelWaitHead == NULL) {
+			VChannelWaitTail = NULL;
+		}
+		pVch->waiting = false;
+	}
+	return pVch;
+}
+
+static void Chip_DMA_VDone(uint8_t ChannelNum, Status result, void *pUserData);
+
+/* Run the next queued request of a virtual channel on a physical channel,
+   a pooled channel is given back once the queue is empty */
+static void Chip_DMA_VRun(LPC_GPDMA_T *pGPDMA, DMA_VChannel_t *pVch, uint8_t ChannelNum)
+{
+	DMA_VRequest_t *pReq;
+
+	while ((pReq = pVch->head) != NULL) {
+		pVch->active = ChannelNum;
+		Chip_DMA_SetCallback(pGPDMA, ChannelNum, Chip_DMA_VDone, pVch);
+		if (Chip_DMA_Transfer(pGPDMA, ChannelNum, pReq->src, pReq->dst,
+							  pReq->TransferType, pReq->Size) == SUCCESS) {
+			return;
+		}
+
+		/* Could not be started, fail it and go on with the next one */
+		pVch->head = pReq->next;
+		if (pVch->head == NULL) {
+			pVch->tail = NULL;
+		}
+		if (pReq->callback != NULL) {
+			pReq->callback(ChannelNum, ERROR, pReq->pUserData);
+		}
+	}
+
+	pVch->active = GPDMA_CHANNEL_NONE;
+	if (pVch->reserved == GPDMA_CHANNEL_NONE) {
+		Chip_DMA_ReleaseChannel(pGPDMA, ChannelNum);
+	}
+}
+
+/* Completion of a virtual channel request. A pooled physical channel
+   goes to the virtual channel that waited longest, so a busy stream
+   cannot starve the others; a reserved one keeps serving its owner. */
+static void Chip_DMA_VDone(uint8_t ChannelNum, Status result, void *pUserData)
+{
+	DMA_VChannel_t *pVch = (DMA_VChannel_t *) pUserData, *pNext;
+	DMA_VRequest_t *pReq = pVch->head;
+
+	if (pReq != NULL) {
+		pVch->head = pReq->next;
+		if (pVch->head == NULL) {
+			pVch->tail = NULL;
+		}
+		if (pReq->callback != NULL) {
+			pReq->callback(ChannelNum, result, pReq->pUserData);
+		}
+	}
+
+	if ((pVch->reserved == GPDMA_CHANNEL_NONE) && (VChannelWaitHead != NULL)) {
+		pNext = Chip_DMA_VUnwait();
+		pVch->active = GPDMA_CHANNEL_NONE;
+		if (pVch->head != NULL) {
+			Chip_DMA_VWait(pVch);
+		}
+		Chip_DMA_VRun(LPC_GPDMA, pNext, ChannelNum);
+	}
+	else {
+		Chip_DMA_VRun(LPC_GPDMA, pVch, ChannelNum);
+	}
+}
+
+/* Hand free physical channels to waiting virtual channels */
+static void Chip_DMA_VDispatch(LPC_GPDMA_T *pGPDMA)
+{
+	uint8_t ch;
+	uint32_t primask;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	while (VChannelWaitHead != NULL) {
+		ch = Chip_DMA_AllocChannel(pGPDMA, (GPDMA_PRIO_T) VChannelWaitHead->priority);
+		if (ch == GPDMA_CHANNEL_NONE) {
+			break;
+		}
+		Chip_DMA_VRun(pGPDMA, Chip_DMA_VUnwait(), ch);
+	}
+
+	__set_PRIMASK(primask);
+}
+
+/* Channels may have been freed: serve waiting virtual channels, then let
+   the release waiters retry work that found none. A waiter that frees a
+   channel itself does not run them again from inside. */
+static void Chip_DMA_Released(LPC_GPDMA_T *pGPDMA)
+{
+	DMA_ReleaseWaiter_t *pWaiter, *pNext;
+	uint32_t primask;
+
+	Chip_DMA_VDispatch(pGPDMA);
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (ReleaseWaitersBusy) {
+		__set_PRIMASK(primask);
+		return;
+	}
+	ReleaseWaitersBusy = true;
+	pWaiter = ReleaseWaiters;
+	__set_PRIMASK(primask);
+
+	/* A waiter may remove itself from its callback */
+	while (pWaiter != NULL) {
+		pNext = pWaiter->next;
+		pWaiter->callback(pWaiter->pUserData);
+		pWaiter = pNext;
+	}
+	ReleaseWaitersBusy = false;
+}
+
+/* Terminal count of a stream half. The channel LLI register points at
+   the descriptor after the one running, so only the other half can be
+   handed over. A terminal count raised again since the dispatcher cleared
+   it may have moved the channel on after LLI was read; that half is left
+   to the pending interrupt, which reads LLI afresh. */
+static void Chip_DMA_StreamEvent(uint8_t ChannelNum, Status result, void *pUserData)
+{
+	DMA_Stream_t *pStream = (DMA_Stream_t *) pUserData;
+	uint8_t running;
+
+	if (result == ERROR) {
+		Chip_DMA_StreamStop(LPC_GPDMA, pStream);
+		pStream->callback(pStream, pStream->next, ERROR);
+		return;
+	}
+
+	running = (LPC_GPDMA->CH[ChannelNum].LLI == (uint32_t) (uintptr_t) &pStream->desc[0]) ? 1 : 0;
+	if (LPC_GPDMA->RAWINTTCSTAT & (1UL << ChannelNum)) {
+		return;
+	}
+
+	/* Both halves completed since the last report: the older one is being
+	   filled again and its data is gone */
+	if (pStream->next == running) {
+		pStream->lost++;
+	}
+	pStream->next = running;
+	pStream->callback(pStream, running ^ 1, SUCCESS);
 }
 
 /*****************************************************************************
@@ -317,8 +938,18 @@ void Chip_GPDMA_Init(LPC_GPDMA_T *pGPDMA)
 	Chip_Clock_EnableOpts(CLK_MX_DMA, true, true, 1);
 	IP_GPDMA_Init(pGPDMA);
 	/* Reset all channels are free */
+	ChannelAllocMask = ChannelOwnedMask = 0;
+	VChannelWaitHead = VChannelWaitTail = NULL;
+	ReleaseWaiters = NULL;
+	ReleaseWaitersBusy = false;
 	for (i = 0; i < GPDMA_NUMBER_CHANNELS; i++) {
-		ChannelHandlerArray[i].ChannelStatus = DISABLE;
+		ChannelCallback[i] = NULL;
+		ChannelUserData[i] = NULL;
+		ChannelChainFirst[i] = -1;
+		ChannelChainNum[i] = 0;
+	}
+	for (i = 0; i < (sizeof(DescUsedMask) / sizeof(DescUsedMask[0])); i++) {
+		DescUsedMask[i] = 0;
 	}
 }
 
@@ -341,7 +972,13 @@ void Chip_DMA_Stop(LPC_GPDMA_T *pGPDMA,
 		/* Clear terminate counter Interrupt pending */
 		Chip_GPDMA_ClearIntPending(pGPDMA, GPDMA_STATCLR_INTERR, ChannelNum);
 	}
-	ChannelHandlerArray[ChannelNum].ChannelStatus = DISABLE;
+	Chip_DMA_FreeChain(ChannelNum);
+
+	/* Channels from Chip_DMA_AllocChannel() stay allocated. A channel
+	   freed here is not handed to waiting virtual channels yet, the
+	   caller may still be tearing it down (callback, registers); that
+	   is left to Chip_DMA_ReleaseChannel() and the interrupt handler. */
+	ChannelAllocMask &= ~((1UL << ChannelNum) & ~ChannelOwnedMask);
 }
 
 /* The GPDMA stream interrupt status checking */
@@ -385,20 +1022,21 @@ int Chip_DMA_InitChannelCfg(LPC_GPDMA_T *pGPDMA,
 		GPDMACfg->SrcAddr = (uint32_t) src;
 		GPDMACfg->DstAddr = (uint32_t) dst;
 		rval = 3;
-		GPDMACfg->TransferWidth = GPDMA_WIDTH_WORD;
-		GPDMACfg->TransferSize = Size / 4;
+		/* Widest width that moves every byte */
+		GPDMACfg->TransferWidth = Chip_DMA_MemWidth(src, dst, Size);
+		GPDMACfg->TransferSize = Size >> GPDMACfg->TransferWidth;
 		break;
 
 	case GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA:
 	case GPDMA_TRANSFERTYPE_M2P_CONTROLLER_PERIPHERAL:
 		GPDMACfg->SrcAddr = (uint32_t) src;
 		rval = 1;
-		GPDMACfg->DstAddr = (uint32_t) GPDMA_LUTPerAddr[dst];
+		GPDMACfg->DstAddr = (uint32_t) (uintptr_t) GPDMA_LUTPerAddr[dst];
 		break;
 
 	case GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA:
 	case GPDMA_TRANSFERTYPE_P2M_CONTROLLER_PERIPHERAL:
-		GPDMACfg->SrcAddr = (uint32_t) GPDMA_LUTPerAddr[src];
+		GPDMACfg->SrcAddr = (uint32_t) (uintptr_t) GPDMA_LUTPerAddr[src];
 		GPDMACfg->DstAddr = (uint32_t) dst;
 		rval = 2;
 		break;
@@ -406,8 +1044,8 @@ int Chip_DMA_InitChannelCfg(LPC_GPDMA_T *pGPDMA,
 	case GPDMA_TRANSFERTYPE_P2P_CONTROLLER_DMA:
 	case GPDMA_TRANSFERTYPE_P2P_CONTROLLER_DestPERIPHERAL:
 	case GPDMA_TRANSFERTYPE_P2P_CONTROLLER_SrcPERIPHERAL:
-		GPDMACfg->SrcAddr = (uint32_t) GPDMA_LUTPerAddr[src];
-		GPDMACfg->DstAddr = (uint32_t) GPDMA_LUTPerAddr[dst];
+		GPDMACfg->SrcAddr = (uint32_t) (uintptr_t) GPDMA_LUTPerAddr[src];
+		GPDMACfg->DstAddr = (uint32_t) (uintptr_t) GPDMA_LUTPerAddr[dst];
 		rval = 0;
 		break;
 
@@ -427,7 +1065,7 @@ Status Chip_DMA_Transfer(LPC_GPDMA_T *pGPDMA,
 {
 	GPDMA_Channel_CFG_T GPDMACfg;
 	uint8_t SrcPeripheral = 0, DstPeripheral = 0;
-	uint32_t cwrd;
+	uint32_t cwrd, lli = 0;
 	int ret;
 
 	ret = Chip_DMA_InitChannelCfg(pGPDMA, &GPDMACfg, ChannelNum, src, dst, Size, TransferType);
@@ -455,7 +1093,17 @@ Status Chip_DMA_Transfer(LPC_GPDMA_T *pGPDMA,
 								 (uint32_t) GPDMA_LUTPerBurst[dst],
 								 (uint32_t) GPDMA_LUTPerWid[src],
 								 (uint32_t) GPDMA_LUTPerWid[dst]);
-	if (IP_GPDMA_Setup(pGPDMA, &GPDMACfg, cwrd, 0, SrcPeripheral, DstPeripheral) == ERROR) {
+
+	/* A chain left from a previous transfer on this channel is done */
+	Chip_DMA_FreeChain(ChannelNum);
+	if (GPDMACfg.TransferSize > GPDMA_MAX_XFER_SIZE) {
+		if (Chip_DMA_BuildChain(ChannelNum, &GPDMACfg, cwrd, &cwrd, &lli) == ERROR) {
+			return ERROR;
+		}
+	}
+
+	if (IP_GPDMA_Setup(pGPDMA, &GPDMACfg, cwrd, lli, SrcPeripheral, DstPeripheral) == ERROR) {
+		Chip_DMA_FreeChain(ChannelNum);
 		return ERROR;
 	}
 
@@ -491,7 +1139,7 @@ Status Chip_DMA_PrepareDescriptor(LPC_GPDMA_T *pGPDMA,
 
 	DMADescriptor->src  = GPDMACfg.SrcAddr;
 	DMADescriptor->dst  = GPDMACfg.DstAddr;
-	DMADescriptor->lli  = (uint32_t) NextDescriptor;
+	DMADescriptor->lli  = (uint32_t) (uintptr_t) NextDescriptor;
 	DMADescriptor->ctrl = IP_GPDMA_MakeCtrlWord(&GPDMACfg,
 												(uint32_t) GPDMA_LUTPerBurst[src],
 												(uint32_t) GPDMA_LUTPerBurst[dst],
@@ -511,53 +1159,533 @@ Status Chip_DMA_SGTransfer(LPC_GPDMA_T *pGPDMA,
 						   uint8_t ChannelNum,
 						   const DMA_TransferDescriptor_t *DMADescriptor,
 						   IP_GPDMA_FLOW_CONTROL_T TransferType)
+{
+	/* Peripheral addresses in the descriptor are mapped back to their
+	   connection, the first match for the direction wins */
+	return Chip_DMA_SGTransferConn(pGPDMA, ChannelNum, DMADescriptor,
+								   Chip_DMA_AddrToConn(DMADescriptor->src, true),
+								   Chip_DMA_AddrToConn(DMADescriptor->dst, false),
+								   TransferType);
+}
+
+/* Do a DMA scatter-gather transfer with explicit connections */
+Status Chip_DMA_SGTransferConn(LPC_GPDMA_T *pGPDMA,
+							   uint8_t ChannelNum,
+							   const DMA_TransferDescriptor_t *DMADescriptor,
+							   uint32_t SrcConn,
+							   uint32_t DstConn,
+							   IP_GPDMA_FLOW_CONTROL_T TransferType)
 {
 	const DMA_TransferDescriptor_t *dsc = DMADescriptor;
 	GPDMA_Channel_CFG_T GPDMACfg;
 	uint8_t SrcPeripheral = 0, DstPeripheral = 0;
-	uint32_t src = DMADescriptor->src, dst = DMADescriptor->dst;
 	int ret;
 
-	ret = Chip_DMA_InitChannelCfg(pGPDMA, &GPDMACfg, ChannelNum, src, dst, 0, TransferType);
+	ret = Chip_DMA_InitChannelCfg(pGPDMA, &GPDMACfg, ChannelNum, GPDMA_CONN_MEMORY, GPDMA_CONN_MEMORY, 0, TransferType);
 	if (ret < 0) {
 		return ERROR;
 	}
 
-	/* Adjust src/dst index if they are memory */
+	/* The descriptor already holds the final addresses, the connections
+	   only select the request lines of the peripheral sides */
+	GPDMACfg.SrcAddr = dsc->src;
+	GPDMACfg.DstAddr = dsc->dst;
+	if ((ret & 1) == 0) {
+		if ((SrcConn == GPDMA_CONN_MEMORY) || (SrcConn >= sizeof(GPDMA_LUTPerReq))) {
+			return ERROR;
+		}
+		SrcPeripheral = DMAMUX_Config(SrcConn);
+	}
+
+	if ((ret & 2) == 0) {
+		if ((DstConn == GPDMA_CONN_MEMORY) || (DstConn >= sizeof(GPDMA_LUTPerReq))) {
+			return ERROR;
+		}
+		DstPeripheral = DMAMUX_Config(DstConn);
+	}
+
+	Chip_DMA_FreeChain(ChannelNum);
+	if (IP_GPDMA_Setup(pGPDMA, &GPDMACfg, dsc->ctrl, dsc->lli, SrcPeripheral, DstPeripheral) == ERROR) {
+		return ERROR;
+	}
+
+	/* Start the Channel */
+	IP_GPDMA_ChannelCmd(pGPDMA, ChannelNum, ENABLE);
+	return SUCCESS;
+}
+
+/* Get a free GPDMA channel for one DMA connection */
+uint8_t Chip_DMA_GetFreeChannel(LPC_GPDMA_T *pGPDMA,
+								uint32_t PeripheralConnection_ID)
+{
+	return Chip_DMA_ClaimChannel(pGPDMA, GPDMA_PRIO_HIGH, false);
+}
+
+/* Allocate a GPDMA channel of the requested priority */
+uint8_t Chip_DMA_AllocChannel(LPC_GPDMA_T *pGPDMA, GPDMA_PRIO_T priority)
+{
+	return Chip_DMA_ClaimChannel(pGPDMA, priority, true);
+}
+
+/* Stop and free a GPDMA channel */
+void Chip_DMA_ReleaseChannel(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum)
+{
+	uint32_t primask;
+
+	if (ChannelNum >= GPDMA_NUMBER_CHANNELS) {
+		return;
+	}
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	Chip_DMA_Stop(pGPDMA, ChannelNum);
+	ChannelCallback[ChannelNum] = NULL;
+	ChannelUserData[ChannelNum] = NULL;
+	ChannelAllocMask &= ~(1UL << ChannelNum);
+	ChannelOwnedMask &= ~(1UL << ChannelNum);
+	__set_PRIMASK(primask);
+
+	/* Virtual channels may be waiting for it */
+	Chip_DMA_Released(pGPDMA);
+}
+
+/* Register to be called when GPDMA channels may have been freed */
+void Chip_DMA_AddReleaseWaiter(LPC_GPDMA_T *pGPDMA, DMA_ReleaseWaiter_t *pWaiter)
+{
+	DMA_ReleaseWaiter_t **ppWaiter;
+	uint32_t primask;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	for (ppWaiter = &ReleaseWaiters; *ppWaiter != NULL; ppWaiter = &(*ppWaiter)->next) {
+		if (*ppWaiter == pWaiter) {
+			__set_PRIMASK(primask);
+			return;
+		}
+	}
+	pWaiter->next = NULL;
+	*ppWaiter = pWaiter;
+	__set_PRIMASK(primask);
+}
+
+/* Unregister a channel release waiter */
+void Chip_DMA_RemoveReleaseWaiter(LPC_GPDMA_T *pGPDMA, DMA_ReleaseWaiter_t *pWaiter)
+{
+	DMA_ReleaseWaiter_t **ppWaiter;
+	uint32_t primask;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	for (ppWaiter = &ReleaseWaiters; *ppWaiter != NULL; ppWaiter = &(*ppWaiter)->next) {
+		if (*ppWaiter == pWaiter) {
+			*ppWaiter = pWaiter->next;
+			break;
+		}
+	}
+	__set_PRIMASK(primask);
+}
+
+/* Set the completion callback of a GPDMA channel */
+void Chip_DMA_SetCallback(LPC_GPDMA_T *pGPDMA, uint8_t ChannelNum,
+						  GPDMA_CALLBACK_T callback, void *pUserData)
+{
+	uint32_t primask;
+
+	if (ChannelNum >= GPDMA_NUMBER_CHANNELS) {
+		return;
+	}
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	ChannelCallback[ChannelNum] = callback;
+	ChannelUserData[ChannelNum] = pUserData;
+	__set_PRIMASK(primask);
+}
+
+/* GPDMA interrupt service routine, dispatches to the channel callbacks */
+void Chip_GPDMA_Interrupt_Handler(LPC_GPDMA_T *pGPDMA)
+{
+	GPDMA_CALLBACK_T owner[GPDMA_NUMBER_CHANNELS];
+	void *ownerData[GPDMA_NUMBER_CHANNELS];
+	uint32_t tc, err, pending, mask;
+	uint8_t ch;
+
+	/* Take a snapshot of the pending channels and their owners */
+	pending = pGPDMA->INTTCSTAT | pGPDMA->INTERRSTAT;
+	for (mask = pending; mask != 0; mask &= ~(1UL << ch)) {
+		ch = (uint8_t) __CLZ(__RBIT(mask));
+		owner[ch] = ChannelCallback[ch];
+		ownerData[ch] = ChannelUserData[ch];
+	}
+
+	/* Highest priority (lowest numbered) channel first */
+	while (pending != 0) {
+		ch = (uint8_t) __CLZ(__RBIT(pending));
+		mask = 1UL << ch;
+		pending &= ~mask;
+
+		/* An earlier callback may have stopped this channel, which clears
+		   its status, or released it, which clears its callback, and handed
+		   it to a new owner. A new owner's status stays pending and comes
+		   back with the next interrupt. */
+		tc = pGPDMA->INTTCSTAT & mask;
+		err = pGPDMA->INTERRSTAT & mask;
+		if (((tc | err) == 0) ||
+			(ChannelCallback[ch] != owner[ch]) || (ChannelUserData[ch] != ownerData[ch])) {
+			continue;
+		}
+		if (tc != 0) {
+			pGPDMA->INTTCCLEAR = tc;
+		}
+		if (err != 0) {
+			pGPDMA->INTERRCLR = err;
+		}
+
+		/* A split transfer has finished with its descriptors */
+		if (!(pGPDMA->ENBLDCHNS & (1UL << ch))) {
+			Chip_DMA_FreeChain(ch);
+		}
+		if (ChannelCallback[ch] != NULL) {
+			ChannelCallback[ch](ch, (err != 0) ? ERROR : SUCCESS, ChannelUserData[ch]);
+		}
+	}
+
+	/* Channels the callbacks have stopped are torn down by now */
+	Chip_DMA_Released(pGPDMA);
+}
+
+/* Copy memory, on the GPDMA for large blocks */
+Status Chip_DMA_Memcpy(LPC_GPDMA_T *pGPDMA, void *dst, const void *src, uint32_t len,
+					   GPDMA_CALLBACK_T callback, void *pUserData)
+{
+	return Chip_DMA_MemOp(pGPDMA, (uint8_t *) dst, (const uint8_t *) src, 0, len, callback, pUserData);
+}
+
+/* Fill memory, on the GPDMA for large blocks */
+Status Chip_DMA_Memset(LPC_GPDMA_T *pGPDMA, void *dst, uint8_t value, uint32_t len,
+					   GPDMA_CALLBACK_T callback, void *pUserData)
+{
+	return Chip_DMA_MemOp(pGPDMA, (uint8_t *) dst, NULL, value * 0x01010101UL, len, callback, pUserData);
+}
+
+/* Set the smallest block Chip_DMA_Memcpy()/Chip_DMA_Memset() give to the GPDMA */
+void Chip_DMA_SetMemThreshold(uint32_t bytes)
+{
+	MemDmaThreshold = bytes;
+}
+
+/* Find the block size from which the GPDMA copies faster than the CPU */
+uint32_t Chip_DMA_MemCalibrate(LPC_GPDMA_T *pGPDMA, void *dst, const void *src, uint32_t maxLen)
+{
+	uint32_t len, start, cpu, dma, trace, cyccnt;
+	uint8_t ch;
+
+	ch = Chip_DMA_AllocChannel(pGPDMA, GPDMA_PRIO_LOW);
+	if (ch == GPDMA_CHANNEL_NONE) {
+		return MemDmaThreshold;
+	}
+
+	/* Time both with the cycle counter, left as the application set it */
+	trace = CoreDebug->DEMCR & CoreDebug_DEMCR_TRCENA_Msk;
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	cyccnt = DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	for (len = 16; len <= maxLen; len <<= 1) {
+		start = DWT->CYCCNT;
+		WordCopy(dst, src, len);
+		cpu = DWT->CYCCNT - start;
+
+		start = DWT->CYCCNT;
+		if (Chip_DMA_StartMem(pGPDMA, ch, (uint32_t) (uintptr_t) src, (uint32_t) (uintptr_t) dst, len, true) == ERROR) {
+			break;
+		}
+		/* Waiting longer than the CPU took tells nothing more, and bounds
+		   the wait for a transfer that does not finish */
+		do {
+			dma = DWT->CYCCNT - start;
+		} while ((pGPDMA->ENBLDCHNS & (1UL << ch)) && (dma <= cpu));
+		Chip_DMA_Stop(pGPDMA, ch);
+
+		if (dma < cpu) {
+			break;
+		}
+	}
+	Chip_DMA_ReleaseChannel(pGPDMA, ch);
+
+	if (cyccnt == 0) {
+		DWT->CTRL &= ~DWT_CTRL_CYCCNTENA_Msk;
+	}
+	if (trace == 0) {
+		CoreDebug->DEMCR &= ~CoreDebug_DEMCR_TRCENA_Msk;
+	}
+
+	MemDmaThreshold = len;
+	return len;
+}
+
+/* Precompute the register values of a single-descriptor transfer */
+Status Chip_DMA_PrepareTransfer(LPC_GPDMA_T *pGPDMA,
+								DMA_PreparedTransfer_t *pXfer,
+								uint8_t ChannelNum,
+								uint32_t src,
+								uint32_t dst,
+								IP_GPDMA_FLOW_CONTROL_T TransferType,
+								uint32_t Size)
+{
+	GPDMA_Channel_CFG_T GPDMACfg;
+	uint8_t SrcPeripheral = 0, DstPeripheral = 0;
+	int ret;
+
+	ret = Chip_DMA_InitChannelCfg(pGPDMA, &GPDMACfg, ChannelNum, src, dst, Size, TransferType);
+	if ((ret < 0) || (GPDMACfg.TransferSize > GPDMA_MAX_XFER_SIZE)) {
+		return ERROR;
+	}
+
+	pXfer->ChannelNum = ChannelNum;
+	pXfer->dmamuxMask = pXfer->dmamuxVal = 0;
+
+	/* Adjust src/dst index if they are memory, else record the DMAMUX setting */
 	if (ret & 1) {
 		src = 0;
 	}
 	else {
-		SrcPeripheral = DMAMUX_Config(src);
+		SrcPeripheral = GPDMA_LUTPerReq[src];
+		pXfer->dmamuxMask |= 0x03UL << (2 * SrcPeripheral);
+		pXfer->dmamuxVal |= (uint32_t) GPDMA_LUTPerMux[src] << (2 * SrcPeripheral);
 	}
 
 	if (ret & 2) {
 		dst = 0;
 	}
 	else {
-		DstPeripheral = DMAMUX_Config(dst);
+		DstPeripheral = GPDMA_LUTPerReq[dst];
+		pXfer->dmamuxMask |= 0x03UL << (2 * DstPeripheral);
+		pXfer->dmamuxVal |= (uint32_t) GPDMA_LUTPerMux[dst] << (2 * DstPeripheral);
 	}
 
-	if (IP_GPDMA_Setup(pGPDMA, &GPDMACfg, dsc->ctrl, dsc->lli, SrcPeripheral, DstPeripheral) == ERROR) {
+	pXfer->src = GPDMACfg.SrcAddr;
+	pXfer->dst = GPDMACfg.DstAddr;
+	pXfer->lli = 0;
+	pXfer->ctrl = IP_GPDMA_MakeCtrlWord(&GPDMACfg,
+										(uint32_t) GPDMA_LUTPerBurst[src],
+										(uint32_t) GPDMA_LUTPerBurst[dst],
+										(uint32_t) GPDMA_LUTPerWid[src],
+										(uint32_t) GPDMA_LUTPerWid[dst]);
+	pXfer->config = GPDMA_DMACCxConfig_IE
+					| GPDMA_DMACCxConfig_ITC
+					| GPDMA_DMACCxConfig_TransferType((uint32_t) TransferType)
+					| GPDMA_DMACCxConfig_SrcPeripheral(SrcPeripheral)
+					| GPDMA_DMACCxConfig_DestPeripheral(DstPeripheral);
+
+	/* Enable DMA channels, little endian */
+	pGPDMA->CONFIG = GPDMA_DMACConfig_E;
+	return SUCCESS;
+}
+
+/* Start a prepared transfer */
+Status Chip_DMA_StartPrepared(LPC_GPDMA_T *pGPDMA, const DMA_PreparedTransfer_t *pXfer)
+{
+	IP_GPDMA_001_CH_T *pDMAch = &pGPDMA->CH[pXfer->ChannelNum];
+	uint32_t bit = 1UL << pXfer->ChannelNum;
+
+	if (pGPDMA->ENBLDCHNS & bit) {
 		return ERROR;
 	}
 
-	/* Start the Channel */
-	IP_GPDMA_ChannelCmd(pGPDMA, ChannelNum, ENABLE);
+	if (pXfer->dmamuxMask != 0) {
+		LPC_CREG->DMAMUX = (LPC_CREG->DMAMUX & ~pXfer->dmamuxMask) | pXfer->dmamuxVal;
+	}
+	pGPDMA->INTTCCLEAR = bit;
+	pGPDMA->INTERRCLR = bit;
+
+	pDMAch->SRCADDR = pXfer->src;
+	pDMAch->DESTADDR = pXfer->dst;
+	pDMAch->LLI = pXfer->lli;
+	pDMAch->CONTROL = pXfer->ctrl;
+	pDMAch->CONFIG = pXfer->config | GPDMA_DMACCxConfig_E;
 	return SUCCESS;
 }
 
-/* Get a free GPDMA channel for one DMA connection */
-uint8_t Chip_DMA_GetFreeChannel(LPC_GPDMA_T *pGPDMA,
-								uint32_t PeripheralConnection_ID)
+/* Set up a virtual channel */
+Status Chip_DMA_VChannelInit(LPC_GPDMA_T *pGPDMA, DMA_VChannel_t *pVch,
+							 GPDMA_PRIO_T priority, bool reserve)
+{
+	pVch->head = pVch->tail = NULL;
+	pVch->nextWaiting = NULL;
+	pVch->waiting = false;
+	pVch->priority = (uint8_t) priority;
+	pVch->active = GPDMA_CHANNEL_NONE;
+	pVch->reserved = GPDMA_CHANNEL_NONE;
+
+	if (reserve) {
+		pVch->reserved = Chip_DMA_AllocChannel(pGPDMA, priority);
+		if (pVch->reserved == GPDMA_CHANNEL_NONE) {
+			return ERROR;
+		}
+	}
+	return SUCCESS;
+}
+
+/* Give back the reservation of an idle virtual channel */
+Status Chip_DMA_VChannelDeInit(LPC_GPDMA_T *pGPDMA, DMA_VChannel_t *pVch)
+{
+	if ((pVch->head != NULL) || (pVch->active != GPDMA_CHANNEL_NONE)) {
+		return ERROR;
+	}
+
+	if (pVch->reserved != GPDMA_CHANNEL_NONE) {
+		Chip_DMA_ReleaseChannel(pGPDMA, pVch->reserved);
+		pVch->reserved = GPDMA_CHANNEL_NONE;
+	}
+	return SUCCESS;
+}
+
+/* Queue a request on a virtual channel */
+Status Chip_DMA_VSubmit(LPC_GPDMA_T *pGPDMA, DMA_VChannel_t *pVch, DMA_VRequest_t *pReq)
+{
+	uint32_t primask;
+	uint8_t ch;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	pReq->next = NULL;
+	if (pVch->tail != NULL) {
+		pVch->tail->next = pReq;
+	}
+	else {
+		pVch->head = pReq;
+	}
+	pVch->tail = pReq;
+
+	/* A running or waiting virtual channel picks it up in turn */
+	if ((pVch->active == GPDMA_CHANNEL_NONE) && !pVch->waiting) {
+		if (pVch->reserved != GPDMA_CHANNEL_NONE) {
+			Chip_DMA_VRun(pGPDMA, pVch, pVch->reserved);
+		}
+		else {
+			ch = Chip_DMA_AllocChannel(pGPDMA, (GPDMA_PRIO_T) pVch->priority);
+			if (ch != GPDMA_CHANNEL_NONE) {
+				Chip_DMA_VRun(pGPDMA, pVch, ch);
+			}
+			else {
+				Chip_DMA_VWait(pVch);
+			}
+		}
+	}
+
+	__set_PRIMASK(primask);
+	return SUCCESS;
+}
+
+/* Start a continuous ping-pong stream */
+Status Chip_DMA_StreamStart(LPC_GPDMA_T *pGPDMA,
+							DMA_Stream_t *pStream,
+							uint32_t peripheral,
+							IP_GPDMA_FLOW_CONTROL_T TransferType,
+							uint32_t bufA,
+							uint32_t bufB,
+							uint32_t len,
+							GPDMA_STREAM_CALLBACK_T callback,
+							void *pUserData)
 {
-	uint8_t temp = 0;
-	for (temp = 0; temp < GPDMA_NUMBER_CHANNELS; temp++) {
-		if (!Chip_GPDMA_IntGetStatus(pGPDMA, GPDMA_STAT_ENABLED_CH,
-									 temp) && (ChannelHandlerArray[temp].ChannelStatus == DISABLE)) {
-			ChannelHandlerArray[temp].ChannelStatus = ENABLE;
-			return temp;
+	uint32_t buf[2] = {bufA, bufB};
+	bool toPeripheral;
+	uint8_t ch;
+	int i;
+
+	switch (TransferType) {
+	case GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA:
+	case GPDMA_TRANSFERTYPE_M2P_CONTROLLER_PERIPHERAL:
+		toPeripheral = true;
+		break;
+
+	case GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA:
+	case GPDMA_TRANSFERTYPE_P2M_CONTROLLER_PERIPHERAL:
+		toPeripheral = false;
+		break;
+
+	default:
+		return ERROR;
+	}
+
+	if ((callback == NULL) || (len == 0) || (len > GPDMA_MAX_XFER_SIZE)) {
+		return ERROR;
+	}
+
+	/* Each half raises a terminal count interrupt and then hands over to
+	   the other one, so the list never ends */
+	for (i = 0; i < 2; i++) {
+		if (Chip_DMA_PrepareDescriptor(pGPDMA, &pStream->desc[i],
+									   toPeripheral ? buf[i] : peripheral,
+									   toPeripheral ? peripheral : buf[i],
+									   len, TransferType, &pStream->desc[i ^ 1]) == ERROR) {
+			return ERROR;
 		}
+		pStream->desc[i].ctrl |= GPDMA_DMACCxControl_I;
+	}
+
+	ch = Chip_DMA_AllocChannel(pGPDMA, GPDMA_PRIO_HIGH);
+	if (ch == GPDMA_CHANNEL_NONE) {
+		return ERROR;
+	}
+
+	pStream->callback = callback;
+	pStream->pUserData = pUserData;
+	pStream->ChannelNum = ch;
+	pStream->next = 0;
+	pStream->lost = 0;
+	Chip_DMA_SetCallback(pGPDMA, ch, Chip_DMA_StreamEvent, pStream);
+
+	if (Chip_DMA_SGTransferConn(pGPDMA, ch, &pStream->desc[0],
+								toPeripheral ? GPDMA_CONN_MEMORY : peripheral,
+								toPeripheral ? peripheral : GPDMA_CONN_MEMORY, TransferType) == ERROR) {
+		Chip_DMA_ReleaseChannel(pGPDMA, ch);
+		pStream->ChannelNum = GPDMA_CHANNEL_NONE;
+		return ERROR;
+	}
+
+	return SUCCESS;
+}
+
+/* Stop a stream */
+void Chip_DMA_StreamStop(LPC_GPDMA_T *pGPDMA, DMA_Stream_t *pStream)
+{
+	uint8_t ch = pStream->ChannelNum;
+
+	if (ch != GPDMA_CHANNEL_NONE) {
+		pStream->ChannelNum = GPDMA_CHANNEL_NONE;
+		Chip_DMA_ReleaseChannel(pGPDMA, ch);
 	}
-	return 0;
+}
+
+/* Copy a rectangle of pixels */
+Status Chip_DMA_BlitCopy(LPC_GPDMA_T *pGPDMA, const void *src, void *dst,
+						 uint32_t width, uint32_t height, uint32_t srcStride, uint32_t dstStride,
+						 uint32_t pixelSize, GPDMA_CALLBACK_T callback, void *pUserData)
+{
+	if (src == NULL) {
+		return ERROR;
+	}
+
+	return Chip_DMA_BlitOp(pGPDMA, (uint8_t *) dst, (const uint8_t *) src, 0, width * pixelSize, height,
+						   srcStride, dstStride, pixelSize, callback, pUserData);
+}
+
+/* Fill a rectangle of pixels */
+Status Chip_DMA_BlitFill(LPC_GPDMA_T *pGPDMA, void *dst, uint32_t color,
+						 uint32_t width, uint32_t height, uint32_t dstStride,
+						 uint32_t pixelSize, GPDMA_CALLBACK_T callback, void *pUserData)
+{
+	/* Repeat the pixel over a word, the GPDMA may write wider than a pixel */
+	if (pixelSize == 1) {
+		color = (color & 0xFF) * 0x01010101UL;
+	}
+	else if (pixelSize == 2) {
+		color = (color & 0xFFFF) * 0x00010001UL;
+	}
+
+	return Chip_DMA_BlitOp(pGPDMA, (uint8_t *) dst, NULL, color, width * pixelSize, height,
+						   0, dstStride, pixelSize, callback, pUserData);
 }
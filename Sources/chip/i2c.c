@@ -42,6 +42,21 @@ static I2C_M_SETUP_T TransferMCfg;
 static uint8_t p_regAddr;
 static uint8_t tx_buffer[MAX_TX_BUFFER_SIZE];
 
+/* Queued master transactions of one bus */
+typedef struct {
+	I2C_XFER_T *head;		/* Waiting transactions */
+	I2C_XFER_T *tail;		/* Last waiting transaction */
+	I2C_XFER_T *active;		/* Transaction on the bus */
+	bool timed;				/* Start tick of the active transaction taken */
+	bool recovering;		/* Bus recovery running, transactions only queue */
+	uint32_t started;		/* Tick the active transaction was first seen at */
+	const I2C_RECOVERY_T *pRecovery;	/* Pins to recover the bus with */
+} I2C_QUEUE_T;
+
+static I2C_QUEUE_T i2cQueue[2];
+
+static I2C_SLAVE_REGS_T *i2cSlaveRegs[2];
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -76,6 +91,310 @@ static IP_I2C_ID_T Chip_I2C_Get_BusNum(LPC_I2C_T *pI2C)
 	return I2C0;
 }
 
+/* Make the next waiting transaction the active one */
+static bool Chip_I2C_Queue_Next(I2C_QUEUE_T *pQueue)
+{
+	pQueue->active = pQueue->head;
+	pQueue->timed = false;
+	if (pQueue->active == NULL) {
+		return false;
+	}
+
+	pQueue->head = pQueue->active->next;
+	if (pQueue->head == NULL) {
+		pQueue->tail = NULL;
+	}
+	return true;
+}
+
+/* Finish the running transaction and chain the next waiting one */
+static void Chip_I2C_Queue_Finish(LPC_I2C_T *pI2C, I2C_QUEUE_T *pQueue, Status result)
+{
+	I2C_XFER_T *pXfer = pQueue->active;
+
+	pXfer->status = pI2C->STAT & I2C_STAT_CODE_BITMASK;
+	if (Chip_I2C_Queue_Next(pQueue)) {
+		/* STOP followed by START, without going idle */
+		pI2C->CONSET = I2C_I2CONSET_STO | I2C_I2CONSET_STA;
+	}
+	else {
+		pI2C->CONSET = I2C_I2CONSET_STO;
+	}
+	pI2C->CONCLR = I2C_I2CONCLR_SIC | I2C_I2CONCLR_AAC;
+
+	if (pXfer->callback != NULL) {
+		pXfer->callback(pXfer, result);
+	}
+}
+
+/* Advance the running transaction on an I2C status event */
+static void Chip_I2C_Queue_Event(LPC_I2C_T *pI2C, I2C_QUEUE_T *pQueue)
+{
+	I2C_XFER_T *pXfer = pQueue->active;
+
+	switch (pI2C->STAT & I2C_STAT_CODE_BITMASK) {
+	case I2C_I2STAT_M_TX_START:
+	case I2C_I2STAT_M_TX_RESTART:
+		if (pXfer->tx_count < pXfer->tx_length) {
+			pI2C->DAT = pXfer->slaveAddr << 1;
+		}
+		else {
+			pI2C->DAT = (pXfer->slaveAddr << 1) | 0x01;
+		}
+		pI2C->CONCLR = I2C_I2CONCLR_STAC | I2C_I2CONCLR_SIC;
+		break;
+
+	case I2C_I2STAT_M_TX_SLAW_ACK:
+	case I2C_I2STAT_M_TX_DAT_ACK:
+		if (pXfer->tx_count < pXfer->tx_length) {
+			pI2C->DAT = pXfer->tx_data[pXfer->tx_count++];
+			pI2C->CONCLR = I2C_I2CONCLR_SIC;
+		}
+		else if (pXfer->rx_length > 0) {
+			/* Repeated start for the read phase */
+			pI2C->CONSET = I2C_I2CONSET_STA;
+			pI2C->CONCLR = I2C_I2CONCLR_SIC;
+		}
+		else {
+			Chip_I2C_Queue_Finish(pI2C, pQueue, SUCCESS);
+		}
+		break;
+
+	case I2C_I2STAT_M_RX_SLAR_ACK:
+		/* Acknowledge all but the last byte */
+		if (pXfer->rx_length > 1) {
+			pI2C->CONSET = I2C_I2CONSET_AA;
+		}
+		else {
+			pI2C->CONCLR = I2C_I2CONCLR_AAC;
+		}
+		pI2C->CONCLR = I2C_I2CONCLR_SIC;
+		break;
+
+	case I2C_I2STAT_M_RX_DAT_ACK:
+		pXfer->rx_data[pXfer->rx_count++] = pI2C->DAT & I2C_I2DAT_BITMASK;
+		if ((pXfer->rx_count + 1) < pXfer->rx_length) {
+			pI2C->CONSET = I2C_I2CONSET_AA;
+		}
+		else {
+			pI2C->CONCLR = I2C_I2CONCLR_AAC;
+		}
+		pI2C->CONCLR = I2C_I2CONCLR_SIC;
+		break;
+
+	case I2C_I2STAT_M_RX_DAT_NACK:
+		pXfer->rx_data[pXfer->rx_count++] = pI2C->DAT & I2C_I2DAT_BITMASK;
+		Chip_I2C_Queue_Finish(pI2C, pQueue, SUCCESS);
+		break;
+
+	default:
+		/* NACK, arbitration lost or bus error */
+		Chip_I2C_Queue_Finish(pI2C, pQueue, ERROR);
+		break;
+	}
+}
+
+/* Complete a list of transactions taken off the bus with ERROR. Each one is
+   unlinked before its callback, which may submit it again. */
+static void Chip_I2C_Queue_Fail(I2C_XFER_T *pList)
+{
+	I2C_XFER_T *pXfer;
+
+	while ((pXfer = pList) != NULL) {
+		pList = pXfer->next;
+		pXfer->next = NULL;
+		if (pXfer->callback != NULL) {
+			pXfer->callback(pXfer, ERROR);
+		}
+	}
+}
+
+/* Recover the bus after transactions were taken off it with the controller
+   stopped, start those queued in the meantime and fail the taken ones */
+static Status Chip_I2C_Queue_Recover(LPC_I2C_T *pI2C, I2C_QUEUE_T *pQueue, I2C_XFER_T *pList)
+{
+	uint32_t primask;
+	Status ret;
+
+	ret = Chip_I2C_BusRecover(pI2C, pQueue->pRecovery);
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	pQueue->recovering = false;
+	if (Chip_I2C_Queue_Next(pQueue)) {
+		pI2C->CONCLR = I2C_I2CONCLR_SIC | I2C_I2CONCLR_STAC;
+		pI2C->CONSET = I2C_I2CONSET_STA;
+	}
+	__set_PRIMASK(primask);
+
+	Chip_I2C_Queue_Fail(pList);
+	return ret;
+}
+
+/* Time the running transaction from the first time it is seen here, and
+   give up on it once its timeout has passed */
+static void Chip_I2C_Queue_Expire(LPC_I2C_T *pI2C, I2C_QUEUE_T *pQueue, uint32_t now)
+{
+	I2C_XFER_T *pXfer;
+	uint32_t primask;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	pXfer = pQueue->active;
+	if ((pXfer != NULL) && !pQueue->timed) {
+		pQueue->timed = true;
+		pQueue->started = now;
+	}
+	if ((pXfer == NULL) || (pXfer->timeout == 0) || ((now - pQueue->started) < pXfer->timeout)) {
+		__set_PRIMASK(primask);
+		return;
+	}
+
+	/* Stopping the controller keeps the interrupt off the transaction */
+	pI2C->CONCLR = I2C_I2CONCLR_I2ENC;
+	pXfer->status = pI2C->STAT & I2C_STAT_CODE_BITMASK;
+	pXfer->next = NULL;
+	pQueue->active = NULL;
+	pQueue->recovering = true;
+	__set_PRIMASK(primask);
+
+	Chip_I2C_Queue_Recover(pI2C, pQueue, pXfer);
+}
+
+/* Drive a recovery line as open drain, low drives the pin and high releases it */
+static void Chip_I2C_RecoveryLine(const I2C_RECOVERY_PIN_T *pPin, bool level, uint32_t delay)
+{
+	Chip_GPIO_WriteDirBit(LPC_GPIO_PORT, pPin->gpioPort, pPin->gpioBit, !level);
+	while (delay--) {
+		__NOP();
+	}
+}
+
+/* Move the register pointer of a slave register file to the next register */
+static void Chip_I2C_SlaveRegs_Advance(I2C_SLAVE_REGS_T *pRegs)
+{
+	if (++pRegs->ptr >= pRegs->size) {
+		pRegs->ptr = 0;
+	}
+}
+
+/* Byte for the master to read, from the shadow while it lasts */
+static uint8_t Chip_I2C_SlaveRegs_Read(I2C_SLAVE_REGS_T *pRegs)
+{
+	uint8_t value;
+
+	if (pRegs->shadowPos < pRegs->shadowLen) {
+		value = pRegs->shadow[pRegs->shadowPos++];
+	}
+	else {
+		value = pRegs->regs[pRegs->ptr];
+	}
+	Chip_I2C_SlaveRegs_Advance(pRegs);
+
+	return value;
+}
+
+/* Byte written by the master, sets the pointer or a register */
+static void Chip_I2C_SlaveRegs_Write(I2C_SLAVE_REGS_T *pRegs, uint8_t value)
+{
+	I2C_SLAVE_WRITE_T wr;
+	uint8_t mask;
+
+	if (pRegs->addrPhase) {
+		pRegs->addrPhase = false;
+		pRegs->ptr = (value < pRegs->size) ? value : 0;
+		return;
+	}
+
+	mask = (pRegs->rwMask != NULL) ? pRegs->rwMask[pRegs->ptr] : 0xFF;
+	if (mask != 0) {
+		wr.reg = pRegs->ptr;
+		wr.value = (pRegs->regs[pRegs->ptr] & ~mask) | (value & mask);
+		pRegs->regs[pRegs->ptr] = wr.value;
+		if ((pRegs->pWrites != NULL) && (RingBuffer_Insert(pRegs->pWrites, &wr) == ERROR)) {
+			pRegs->overruns++;
+		}
+	}
+	Chip_I2C_SlaveRegs_Advance(pRegs);
+}
+
+/* Advance the slave register file on an I2C status event */
+static void Chip_I2C_SlaveRegs_Event(LPC_I2C_T *pI2C, I2C_SLAVE_REGS_T *pRegs)
+{
+	uint32_t i, reg;
+
+	switch (pI2C->STAT & I2C_STAT_CODE_BITMASK) {
+	case I2C_I2STAT_S_RX_SLAW_ACK:
+	case I2C_I2STAT_S_RX_ARB_LOST_M_SLA:
+		pRegs->addrPhase = true;
+		break;
+
+	case I2C_I2STAT_S_RX_PRE_SLA_DAT_ACK:
+		Chip_I2C_SlaveRegs_Write(pRegs, pI2C->DAT & I2C_I2DAT_BITMASK);
+		break;
+
+	case I2C_I2STAT_S_RX_GENCALL_ACK:
+	case I2C_I2STAT_S_RX_ARB_LOST_M_GENCALL:
+	case I2C_I2STAT_S_RX_PRE_GENCALL_DAT_ACK:
+		/* General calls are not meant for the register file, their
+		   bytes are acknowledged and dropped */
+		break;
+
+	case I2C_I2STAT_S_TX_SLAR_ACK:
+	case I2C_I2STAT_S_TX_ARB_LOST_M_SLA:
+		/* Latch the registers this read starts with */
+		reg = pRegs->ptr;
+		pRegs->shadowLen = (pRegs->size < I2C_SLAVE_SHADOW_LEN) ? pRegs->size : I2C_SLAVE_SHADOW_LEN;
+		for (i = 0; i < pRegs->shadowLen; i++) {
+			pRegs->shadow[i] = pRegs->regs[reg];
+			if (++reg >= pRegs->size) {
+				reg = 0;
+			}
+		}
+		pRegs->shadowPos = 0;
+		pI2C->DAT = Chip_I2C_SlaveRegs_Read(pRegs);
+		break;
+
+	case I2C_I2STAT_S_TX_DAT_ACK:
+		pI2C->DAT = Chip_I2C_SlaveRegs_Read(pRegs);
+		break;
+
+	case I2C_I2STAT_S_RX_PRE_SLA_DAT_NACK:
+	case I2C_I2STAT_S_RX_PRE_GENCALL_DAT_NACK:
+	case I2C_I2STAT_S_RX_STA_STO_SLVREC_SLVTRX:
+	case I2C_I2STAT_S_TX_DAT_NACK:
+	case I2C_I2STAT_S_TX_LAST_DAT_ACK:
+		/* Access over, stay addressable */
+		break;
+
+	default:
+		/* Bus error, release the lines */
+		pI2C->CONSET = I2C_I2CONSET_STO;
+		break;
+	}
+
+	pI2C->CONSET = I2C_I2CONSET_AA;
+	pI2C->CONCLR = I2C_I2CONCLR_SIC;
+}
+
+/* Swap the buffers of a poll plan when its read completes */
+static void Chip_I2C_Poll_Done(I2C_XFER_T *pXfer, Status result)
+{
+	I2C_POLL_PLAN_T *pPlan = (I2C_POLL_PLAN_T *) pXfer->pUserData;
+
+	if (result == SUCCESS) {
+		pPlan->front ^= 1;
+		pPlan->stamp = pPlan->started;
+		__DMB();
+		pPlan->seq++;
+	}
+	else {
+		pPlan->errors++;
+	}
+	pPlan->busy = false;
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -83,6 +402,14 @@ static IP_I2C_ID_T Chip_I2C_Get_BusNum(LPC_I2C_T *pI2C)
 /* Initializes the LPC_I2C peripheral with specified parameter */
 void Chip_I2C_Init(LPC_I2C_T *pI2C)
 {
+	I2C_QUEUE_T *pQueue = &i2cQueue[Chip_I2C_Get_BusNum(pI2C)];
+
+	pQueue->head = pQueue->tail = pQueue->active = NULL;
+	pQueue->timed = false;
+	pQueue->recovering = false;
+	pQueue->pRecovery = NULL;
+	i2cSlaveRegs[Chip_I2C_Get_BusNum(pI2C)] = NULL;
+
 	/* Enable I2C Clocking */
 	Chip_Clock_Enable(Chip_I2C_DetermineClk(pI2C));
 
@@ -242,11 +569,258 @@ uint32_t Chip_I2C_MasterReadReg(LPC_I2C_T *pI2C,
 	return TransferMCfg.rx_count;
 }
 
+/* Queue a master transaction on an I2C bus */
+Status Chip_I2C_Queue_Submit(LPC_I2C_T *pI2C, I2C_XFER_T *pXfer)
+{
+	I2C_QUEUE_T *pQueue = &i2cQueue[Chip_I2C_Get_BusNum(pI2C)];
+	uint32_t primask;
+
+	if (((pXfer->tx_length == 0) && (pXfer->rx_length == 0)) ||
+		((pXfer->tx_length > 0) && (pXfer->tx_data == NULL)) ||
+		((pXfer->rx_length > 0) && (pXfer->rx_data == NULL))) {
+		return ERROR;
+	}
+
+	pXfer->tx_count = 0;
+	pXfer->rx_count = 0;
+	pXfer->status = I2C_I2STAT_NO_INF;
+	pXfer->next = NULL;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if ((pQueue->active == NULL) && !pQueue->recovering) {
+		pQueue->active = pXfer;
+		pI2C->CONCLR = I2C_I2CONCLR_SIC | I2C_I2CONCLR_STAC;
+		pI2C->CONSET = I2C_I2CONSET_STA;
+	}
+	else {
+		if (pQueue->tail != NULL) {
+			pQueue->tail->next = pXfer;
+		}
+		else {
+			pQueue->head = pXfer;
+		}
+		pQueue->tail = pXfer;
+	}
+	__set_PRIMASK(primask);
+
+	return SUCCESS;
+}
+
+/* Check for queued master transactions */
+bool Chip_I2C_Queue_Busy(LPC_I2C_T *pI2C)
+{
+	I2C_QUEUE_T *pQueue = &i2cQueue[Chip_I2C_Get_BusNum(pI2C)];
+
+	return (pQueue->active != NULL) || pQueue->recovering;
+}
+
+/* Step queued master transactions without the I2C interrupt */
+bool Chip_I2C_Queue_Step(LPC_I2C_T *pI2C, uint32_t now)
+{
+	I2C_QUEUE_T *pQueue = &i2cQueue[Chip_I2C_Get_BusNum(pI2C)];
+
+	if (pQueue->active == NULL) {
+		return false;
+	}
+
+	if (pI2C->CONSET & I2C_I2CONSET_SI) {
+		Chip_I2C_Queue_Event(pI2C, pQueue);
+	}
+	Chip_I2C_Queue_Expire(pI2C, pQueue, now);
+
+	return pQueue->active != NULL;
+}
+
+/* Check the timeout of the running transaction in interrupt mode */
+void Chip_I2C_Queue_CheckTimeout(LPC_I2C_T *pI2C, uint32_t now)
+{
+	Chip_I2C_Queue_Expire(pI2C, &i2cQueue[Chip_I2C_Get_BusNum(pI2C)], now);
+}
+
+/* Abort all queued master transactions of a bus */
+Status Chip_I2C_Queue_Abort(LPC_I2C_T *pI2C)
+{
+	I2C_QUEUE_T *pQueue = &i2cQueue[Chip_I2C_Get_BusNum(pI2C)];
+	I2C_XFER_T *pList;
+	uint32_t primask;
+	bool busy;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	pI2C->CONCLR = I2C_I2CONCLR_I2ENC;
+	pList = pQueue->head;
+	if (pQueue->active != NULL) {
+		pQueue->active->status = pI2C->STAT & I2C_STAT_CODE_BITMASK;
+		pQueue->active->next = pList;
+		pList = pQueue->active;
+	}
+	pQueue->head = pQueue->tail = pQueue->active = NULL;
+	busy = pQueue->recovering;
+	pQueue->recovering = true;
+
+	__set_PRIMASK(primask);
+
+	if (busy) {
+		/* Already being recovered by a timeout, just fail the rest */
+		Chip_I2C_Queue_Fail(pList);
+		return ERROR;
+	}
+	return Chip_I2C_Queue_Recover(pI2C, pQueue, pList);
+}
+
+/* Set the pins used to recover a bus after a queued transaction times out */
+void Chip_I2C_Queue_SetRecovery(LPC_I2C_T *pI2C, const I2C_RECOVERY_T *pRec)
+{
+	i2cQueue[Chip_I2C_Get_BusNum(pI2C)].pRecovery = pRec;
+}
+
+/* Recover an I2C bus held by a slave */
+Status Chip_I2C_BusRecover(LPC_I2C_T *pI2C, const I2C_RECOVERY_T *pRec)
+{
+	Status ret = SUCCESS;
+	int i;
+
+	/* Take the lines away from the controller onto GPIO */
+	if (pRec != NULL) {
+		Chip_GPIO_WritePortBit(LPC_GPIO_PORT, pRec->scl.gpioPort, pRec->scl.gpioBit, false);
+		Chip_GPIO_WritePortBit(LPC_GPIO_PORT, pRec->sda.gpioPort, pRec->sda.gpioBit, false);
+		Chip_I2C_RecoveryLine(&pRec->scl, true, 0);
+		Chip_I2C_RecoveryLine(&pRec->sda, true, 0);
+		Chip_SCU_PinMux(pRec->scl.scuPort, pRec->scl.scuPin, pRec->scl.mode, pRec->scl.gpioFunc);
+		Chip_SCU_PinMux(pRec->sda.scuPort, pRec->sda.scuPin, pRec->sda.mode, pRec->sda.gpioFunc);
+
+		/* Clock out the slave until it lets go of SDA */
+		for (i = 0; (i < 9) && !Chip_GPIO_ReadPortBit(LPC_GPIO_PORT, pRec->sda.gpioPort, pRec->sda.gpioBit); i++) {
+			Chip_I2C_RecoveryLine(&pRec->scl, false, pRec->delay);
+			Chip_I2C_RecoveryLine(&pRec->scl, true, pRec->delay);
+		}
+
+		/* START then STOP, so every slave sees the bus idle */
+		Chip_I2C_RecoveryLine(&pRec->sda, false, pRec->delay);
+		Chip_I2C_RecoveryLine(&pRec->sda, true, pRec->delay);
+
+		if (!Chip_GPIO_ReadPortBit(LPC_GPIO_PORT, pRec->sda.gpioPort, pRec->sda.gpioBit) ||
+			!Chip_GPIO_ReadPortBit(LPC_GPIO_PORT, pRec->scl.gpioPort, pRec->scl.gpioBit)) {
+			ret = ERROR;
+		}
+	}
+
+	/* Reset the controller state machine before it gets the lines back,
+	   this releases the lines it drives */
+	IP_I2C_Reset(pI2C);
+
+	if (pRec != NULL) {
+		Chip_SCU_PinMux(pRec->scl.scuPort, pRec->scl.scuPin, pRec->scl.mode, pRec->scl.i2cFunc);
+		Chip_SCU_PinMux(pRec->sda.scuPort, pRec->sda.scuPin, pRec->sda.mode, pRec->sda.i2cFunc);
+	}
+
+	return ret;
+}
+
+/* Initialize an I2C poll scheduler */
+void Chip_I2C_Poll_Init(I2C_POLL_T *pPoll, LPC_I2C_T *pI2C)
+{
+	pPoll->pI2C = pI2C;
+	pPoll->plans = NULL;
+}
+
+/* Register a poll plan with a scheduler */
+Status Chip_I2C_Poll_AddPlan(I2C_POLL_T *pPoll, I2C_POLL_PLAN_T *pPlan, uint32_t now)
+{
+	if ((pPlan->length == 0) || (pPlan->length > I2C_POLL_MAXLEN) || (pPlan->period == 0)) {
+		return ERROR;
+	}
+
+	pPlan->due = now;
+	pPlan->stamp = 0;
+	pPlan->seq = 0;
+	pPlan->errors = 0;
+	pPlan->busy = false;
+	pPlan->front = 0;
+
+	pPlan->xfer.slaveAddr = pPlan->slaveAddr;
+	pPlan->xfer.tx_data = &pPlan->regAddr;
+	pPlan->xfer.tx_length = 1;
+	pPlan->xfer.rx_length = pPlan->length;
+	pPlan->xfer.callback = Chip_I2C_Poll_Done;
+	pPlan->xfer.pUserData = pPlan;
+	pPlan->xfer.timeout = pPlan->timeout;
+
+	pPlan->next = pPoll->plans;
+	pPoll->plans = pPlan;
+
+	return SUCCESS;
+}
+
+/* Start the reads that are due */
+uint32_t Chip_I2C_Poll_Run(I2C_POLL_T *pPoll, uint32_t now)
+{
+	I2C_POLL_PLAN_T *pPlan;
+	uint32_t started = 0;
+
+	for (pPlan = pPoll->plans; pPlan != NULL; pPlan = pPlan->next) {
+		if ((int32_t) (now - pPlan->due) < 0) {
+			continue;
+		}
+
+		/* Keep the sample grid unless a whole period was missed */
+		if ((now - pPlan->due) >= pPlan->period) {
+			pPlan->due = now;
+		}
+		pPlan->due += pPlan->period;
+
+		if (pPlan->busy) {
+			continue;
+		}
+		pPlan->busy = true;
+		pPlan->started = now;
+		pPlan->xfer.rx_data = pPlan->data[pPlan->front ^ 1];
+		if (Chip_I2C_Queue_Submit(pPoll->pI2C, &pPlan->xfer) == SUCCESS) {
+			started++;
+		}
+		else {
+			pPlan->busy = false;
+		}
+	}
+
+	return started;
+}
+
+/* Copy the latest snapshot of a poll plan */
+uint32_t Chip_I2C_Poll_Read(I2C_POLL_PLAN_T *pPlan, uint8_t *buffer, uint32_t *pStamp)
+{
+	uint32_t seq, i;
+	uint8_t front;
+
+	/* Retry when a read completed while copying */
+	do {
+		seq = pPlan->seq;
+		__DMB();
+		front = pPlan->front;
+		for (i = 0; i < pPlan->length; i++) {
+			buffer[i] = pPlan->data[front][i];
+		}
+		if (pStamp != NULL) {
+			*pStamp = pPlan->stamp;
+		}
+		__DMB();
+	} while (seq != pPlan->seq);
+
+	return seq;
+}
+
 /* General Master Interrupt handler for I2C peripheral */
 void Chip_I2C_Interrupt_MasterHandler(LPC_I2C_T *pI2C)
 {
 	IP_I2C_ID_T I2C_Num = Chip_I2C_Get_BusNum(pI2C);
 
+	if (i2cQueue[I2C_Num].active != NULL) {
+		Chip_I2C_Queue_Event(pI2C, &i2cQueue[I2C_Num]);
+		return;
+	}
+
 	IP_I2C_Interrupt_MasterHandler(pI2C, I2C_Num);
 }
 
@@ -295,11 +869,55 @@ Status Chip_I2C_SlaveReceiveData(LPC_I2C_T *pI2C, I2C_S_SETUP_T *TransferCfg, IP
 	return IP_I2C_SlaveTransferData(pI2C, I2C_Num, TransferCfg, Opt);
 }
 
+/* Serve a register file in slave mode */
+Status Chip_I2C_SlaveRegs_Attach(LPC_I2C_T *pI2C, I2C_SLAVE_REGS_T *pRegs)
+{
+	IP_I2C_ID_T I2C_Num = Chip_I2C_Get_BusNum(pI2C);
+
+	if (pRegs == NULL) {
+		i2cSlaveRegs[I2C_Num] = NULL;
+		pI2C->CONCLR = I2C_I2CONCLR_AAC;
+		return SUCCESS;
+	}
+
+	if ((pRegs->regs == NULL) || (pRegs->size == 0) || (pRegs->size > 256)) {
+		return ERROR;
+	}
+
+	pRegs->ptr = 0;
+	pRegs->shadowPos = 0;
+	pRegs->shadowLen = 0;
+	pRegs->addrPhase = false;
+	pRegs->overruns = 0;
+	i2cSlaveRegs[I2C_Num] = pRegs;
+
+	IP_I2C_Slave_Enable(pI2C);
+	return SUCCESS;
+}
+
+/* Update registers of a slave register file from the application */
+void Chip_I2C_SlaveRegs_Update(I2C_SLAVE_REGS_T *pRegs, uint8_t reg, const uint8_t *data, uint32_t len)
+{
+	uint32_t primask, i;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	for (i = 0; (i < len) && ((reg + i) < pRegs->size); i++) {
+		pRegs->regs[reg + i] = data[i];
+	}
+	__set_PRIMASK(primask);
+}
+
 /* General Slave Interrupt handler for I2C peripheral */
 void Chip_I2C_Interrupt_SlaveHandler(LPC_I2C_T *pI2C)
 {
 	IP_I2C_ID_T I2C_Num = Chip_I2C_Get_BusNum(pI2C);
 
+	if (i2cSlaveRegs[I2C_Num] != NULL) {
+		Chip_I2C_SlaveRegs_Event(pI2C, i2cSlaveRegs[I2C_Num]);
+		return;
+	}
+
 	IP_I2C_Interrupt_SlaveHandler(pI2C, I2C_Num);
 }
 
@@ -51,7 +51,7 @@
 void Chip_SCU_PinMux(uint8_t port, uint8_t pin, uint8_t mode, uint8_t func)
 {
 	if (port == PINMUX_CLK) {
-		LPC_SCU_CLK(((uint32_t) LPC_SCU), pin) = mode + func;
+		LPC_SCU_CLK(((uintptr_t) LPC_SCU), pin) = mode + func;
 	}
 	else {
 		LPC_SCU->SFSP[port][pin] = mode + func;
@@ -39,6 +39,10 @@
 /* Global instance of the current card */
 static mci_card_struct *g_card_info;
 
+/* DMA descriptors set with Chip_SDMMC_SetDmaPool() */
+static pSDMMC_DMA_T *sdmmc_dma_pool;
+static uint32_t sdmmc_dma_pool_num;
+
 /* Helper definition: all SD error conditions in the status word */
 #define SD_INT_ERROR (MCI_INT_RESP_ERR | MCI_INT_RCRC | MCI_INT_DCRC | \
 					  MCI_INT_RTO | MCI_INT_DTO | MCI_INT_HTO | MCI_INT_FRUN | MCI_INT_HLE | \
@@ -207,7 +211,7 @@ static void prv_process_csd(LPC_SDMMC_T *pSDMMC)
 			IP_SDMMC_SetBlockSize(pSDMMC, MMC_SECTOR_SIZE);
 
 			/* send EXT_CSD command */
-			IP_SDMMC_DmaSetup(pSDMMC, &g_card_info->sdif_dev, (uint32_t) g_card_info->ext_csd, MMC_SECTOR_SIZE);
+			IP_SDMMC_DmaSetup(pSDMMC, &g_card_info->sdif_dev, (uint32_t) (uintptr_t) g_card_info->ext_csd, MMC_SECTOR_SIZE);
 
 			status = sdmmc_execute_command(pSDMMC, CMD_SEND_EXT_CSD, 0, 0 | MCI_INT_DATA_OVER);
 			if ((status & SD_INT_ERROR) == 0) {
@@ -298,6 +302,96 @@ static int32_t prv_set_card_params(LPC_SDMMC_T *pSDMMC)
 	return 0;
 }
 
+/* Read blocks the DMA descriptors can describe in one go, range checked
+   by the caller */
+static int32_t prv_read_blocks(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_block, int32_t num_blocks)
+{
+	int32_t cbRead = (num_blocks) * MMC_SECTOR_SIZE;
+	int32_t status = 0;
+	int32_t index;
+
+	/* put card in trans state */
+	if (prv_set_trans_state(pSDMMC) != 0) {
+		return 0;
+	}
+
+	/* set number of bytes to read */
+	pSDMMC->BYTCNT = cbRead;
+
+	/* if high capacity card use block indexing */
+	if (g_card_info->card_type & CARD_TYPE_HC) {
+		index = start_block;
+	}
+	else {	/*fix at 512 bytes*/
+		index = start_block << 9;	// \* g_card_info->block_len;
+
+	}
+	IP_SDMMC_DmaSetup(pSDMMC, &g_card_info->sdif_dev, (uint32_t) (uintptr_t) buffer, cbRead);
+
+	/* Select single or multiple read based on number of blocks */
+	if (num_blocks == 1) {
+		status = sdmmc_execute_command(pSDMMC, CMD_READ_SINGLE, index, 0 | MCI_INT_DATA_OVER);
+	}
+	else {
+		status = sdmmc_execute_command(pSDMMC, CMD_READ_MULTIPLE, index, 0 | MCI_INT_DATA_OVER);
+	}
+
+	if (status != 0) {
+		cbRead = 0;
+	}
+	/*Wait for card program to finish*/
+	while (Chip_SDMMC_GetState(pSDMMC) != SDMMC_TRAN_ST) ;
+
+	return cbRead;
+}
+
+/* Write blocks the DMA descriptors can describe in one go, range checked
+   by the caller */
+static int32_t prv_write_blocks(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_block, int32_t num_blocks)
+{
+	int32_t cbWrote = num_blocks *  MMC_SECTOR_SIZE;
+	int32_t status;
+	int32_t index;
+
+	/*Wait for card program to finish*/
+	while (Chip_SDMMC_GetState(pSDMMC) != SDMMC_TRAN_ST) ;
+
+	/* put card in trans state */
+	if (prv_set_trans_state(pSDMMC) != 0) {
+		return 0;
+	}
+
+	/* set number of bytes to write */
+	pSDMMC->BYTCNT = cbWrote;
+
+	/* if high capacity card use block indexing */
+	if (g_card_info->card_type & CARD_TYPE_HC) {
+		index = start_block;
+	}
+	else {	/*fix at 512 bytes*/
+		index = start_block << 9;	// * g_card_info->block_len;
+
+	}
+	IP_SDMMC_DmaSetup(pSDMMC, &g_card_info->sdif_dev, (uint32_t) (uintptr_t) buffer, cbWrote);
+
+	/* Select single or multiple write based on number of blocks */
+	if (num_blocks == 1) {
+		status = sdmmc_execute_command(pSDMMC, CMD_WRITE_SINGLE, index, 0 | MCI_INT_DATA_OVER);
+	}
+	else {
+		status = sdmmc_execute_command(pSDMMC, CMD_WRITE_MULTIPLE, index, 0 | MCI_INT_DATA_OVER);
+	}
+
+	/*Wait for card program to finish*/
+	while (Chip_SDMMC_GetState(pSDMMC) != SDMMC_TRAN_ST) ;
+
+	if (status != 0) {
+		cbWrote = 0;
+	}
+
+	return cbWrote;
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -355,6 +449,8 @@ uint32_t Chip_SDMMC_Acquire(LPC_SDMMC_T *pSDMMC, mci_card_struct *pcardinfo)
 	uint32_t command = 0;
 
 	g_card_info = pcardinfo;
+	g_card_info->sdif_dev.dma_pool = sdmmc_dma_pool;
+	g_card_info->sdif_dev.dma_pool_num = sdmmc_dma_pool_num;
 
 	/* clear card type */
 	IP_SDMMC_SetCardType(pSDMMC, 0);
@@ -521,46 +617,25 @@ int32_t Chip_SDMMC_GetDeviceBlocks(LPC_SDMMC_T *pSDMMC)
 /* Performs the read of data from the SD/MMC card */
 int32_t Chip_SDMMC_ReadBlocks(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_block, int32_t num_blocks)
 {
-	int32_t cbRead = (num_blocks) * MMC_SECTOR_SIZE;
-	int32_t status = 0;
-	int32_t index;
+	int32_t maxBlocks = IP_SDMMC_DmaMaxSize(&g_card_info->sdif_dev) / MMC_SECTOR_SIZE;
+	int32_t cbRead = 0;
+	int32_t blocks, cb;
 
 	/* if card is not acquired return immediately */
 	if (( start_block < 0) || ( (start_block + num_blocks) > g_card_info->blocknr) ) {
 		return 0;
 	}
 
-	/* put card in trans state */
-	if (prv_set_trans_state(pSDMMC) != 0) {
-		return 0;
-	}
-
-	/* set number of bytes to read */
-	pSDMMC->BYTCNT = cbRead;
-
-	/* if high capacity card use block indexing */
-	if (g_card_info->card_type & CARD_TYPE_HC) {
-		index = start_block;
-	}
-	else {	/*fix at 512 bytes*/
-		index = start_block << 9;	// \* g_card_info->block_len;
-
-	}
-	IP_SDMMC_DmaSetup(pSDMMC, &g_card_info->sdif_dev, (uint32_t) buffer, cbRead);
-
-	/* Select single or multiple read based on number of blocks */
-	if (num_blocks == 1) {
-		status = sdmmc_execute_command(pSDMMC, CMD_READ_SINGLE, index, 0 | MCI_INT_DATA_OVER);
-	}
-	else {
-		status = sdmmc_execute_command(pSDMMC, CMD_READ_MULTIPLE, index, 0 | MCI_INT_DATA_OVER);
-	}
-
-	if (status != 0) {
-		cbRead = 0;
+	while (num_blocks > 0) {
+		blocks = (num_blocks > maxBlocks) ? maxBlocks : num_blocks;
+		cb = prv_read_blocks(pSDMMC, (uint8_t *) buffer + cbRead, start_block, blocks);
+		if (cb == 0) {
+			break;
+		}
+		cbRead += cb;
+		start_block += blocks;
+		num_blocks -= blocks;
 	}
-	/*Wait for card program to finish*/
-	while (Chip_SDMMC_GetState(pSDMMC) != SDMMC_TRAN_ST) ;
 
 	return cbRead;
 }
@@ -568,50 +643,37 @@ int32_t Chip_SDMMC_ReadBlocks(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_b
 /* Performs write of data to the SD/MMC card */
 int32_t Chip_SDMMC_WriteBlocks(LPC_SDMMC_T *pSDMMC, void *buffer, int32_t start_block, int32_t num_blocks)
 {
-	int32_t cbWrote = num_blocks *  MMC_SECTOR_SIZE;
-	int32_t status;
-	int32_t index;
+	int32_t maxBlocks = IP_SDMMC_DmaMaxSize(&g_card_info->sdif_dev) / MMC_SECTOR_SIZE;
+	int32_t cbWrote = 0;
+	int32_t blocks, cb;
 
 	/* if card is not acquired return immediately */
 	if (( start_block < 0) || ( (start_block + num_blocks) > g_card_info->blocknr) ) {
 		return 0;
 	}
 
-	/*Wait for card program to finish*/
-	while (Chip_SDMMC_GetState(pSDMMC) != SDMMC_TRAN_ST) ;
-
-	/* put card in trans state */
-	if (prv_set_trans_state(pSDMMC) != 0) {
-		return 0;
-	}
-
-	/* set number of bytes to write */
-	pSDMMC->BYTCNT = cbWrote;
-
-	/* if high capacity card use block indexing */
-	if (g_card_info->card_type & CARD_TYPE_HC) {
-		index = start_block;
-	}
-	else {	/*fix at 512 bytes*/
-		index = start_block << 9;	// * g_card_info->block_len;
-
+	while (num_blocks > 0) {
+		blocks = (num_blocks > maxBlocks) ? maxBlocks : num_blocks;
+		cb = prv_write_blocks(pSDMMC, (uint8_t *) buffer + cbWrote, start_block, blocks);
+		if (cb == 0) {
+			break;
+		}
+		cbWrote += cb;
+		start_block += blocks;
+		num_blocks -= blocks;
 	}
-	IP_SDMMC_DmaSetup(pSDMMC, &g_card_info->sdif_dev, (uint32_t) buffer, cbWrote);
 
-	/* Select single or multiple write based on number of blocks */
-	if (num_blocks == 1) {
-		status = sdmmc_execute_command(pSDMMC, CMD_WRITE_SINGLE, index, 0 | MCI_INT_DATA_OVER);
-	}
-	else {
-		status = sdmmc_execute_command(pSDMMC, CMD_WRITE_MULTIPLE, index, 0 | MCI_INT_DATA_OVER);
-	}
+	return cbWrote;
+}
 
-	/*Wait for card program to finish*/
-	while (Chip_SDMMC_GetState(pSDMMC) != SDMMC_TRAN_ST) ;
+/* Supply DMA descriptors for large transfers */
+void Chip_SDMMC_SetDmaPool(LPC_SDMMC_T *pSDMMC, pSDMMC_DMA_T *pPool, uint32_t num)
+{
+	sdmmc_dma_pool = (num > 0) ? pPool : NULL;
+	sdmmc_dma_pool_num = num;
 
-	if (status != 0) {
-		cbWrote = 0;
+	if (g_card_info != NULL) {
+		g_card_info->sdif_dev.dma_pool = sdmmc_dma_pool;
+		g_card_info->sdif_dev.dma_pool_num = sdmmc_dma_pool_num;
 	}
-
-	return cbWrote;
 }
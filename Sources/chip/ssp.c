@@ -37,7 +37,7 @@
 /** SSP macro: write 2 bytes to FIFO buffer */
 #define SSP_Write2BFifo(pSSP, \
 						xf_setup) if (xf_setup->tx_data) {IP_SSP_SendFrame(pSSP, \
-																		   (*(uint16_t *) ((uint32_t) xf_setup->tx_data	\
+																		   (*(uint16_t *) ((uint8_t *) xf_setup->tx_data	\
 																						   + xf_setup->tx_cnt))); }	\
 	else {IP_SSP_SendFrame(pSSP, 0xFFFF); }	\
 	xf_setup->tx_cnt += 2;
@@ -45,7 +45,7 @@
 /** SSP macro: write 1 bytes to FIFO buffer */
 #define SSP_Write1BFifo(pSSP, \
 						xf_setup) if (xf_setup->tx_data) {IP_SSP_SendFrame(pSSP, \
-																		   (*(uint8_t *) ((uint32_t) xf_setup->tx_data \
+																		   (*(uint8_t *) ((uint8_t *) xf_setup->tx_data \
 																						  + xf_setup->tx_cnt))); } \
 	else {IP_SSP_SendFrame(pSSP, 0xFF); } \
 	xf_setup->tx_cnt++;
@@ -56,7 +56,7 @@
 													  SSP_STAT_RNE) == SET && xf_setup->rx_cnt < xf_setup->length) { \
 		rDat = IP_SSP_ReceiveFrame(pSSP); \
 		if (xf_setup->rx_data) { \
-			*(uint16_t *) ((uint32_t) xf_setup->rx_data + xf_setup->rx_cnt) = rDat;	\
+			*(uint16_t *) ((uint8_t *) xf_setup->rx_data + xf_setup->rx_cnt) = rDat;	\
 		} \
 		xf_setup->rx_cnt += 2; \
 }
@@ -67,11 +67,29 @@
 													  SSP_STAT_RNE) == SET && xf_setup->rx_cnt < xf_setup->length) { \
 		rDat = IP_SSP_ReceiveFrame(pSSP); \
 		if (xf_setup->rx_data) { \
-			*(uint8_t *) ((uint32_t) xf_setup->rx_data + xf_setup->rx_cnt) = rDat; \
+			*(uint8_t *) ((uint8_t *) xf_setup->rx_data + xf_setup->rx_cnt) = rDat; \
 		} \
 		xf_setup->rx_cnt++;	\
 }
 
+/* Frames the SSP transmit and receive FIFOs each hold */
+#define SSP_FIFO_DEPTH 8
+
+/* GPDMA transfer state of an SSP */
+typedef struct {
+	DMA_TransferDescriptor_t txDesc[SSP_DMA_DESC_NUM];
+	DMA_TransferDescriptor_t rxDesc[SSP_DMA_DESC_NUM];
+	LPC_SSP_T *pSSP;
+	SSP_DMA_CALLBACK_T callback;
+	void *pUserData;
+	uint16_t dummy;		/* Sent when there is no transmit data */
+	uint16_t sink;		/* Receives the frames when they are not kept */
+	uint8_t txCh;
+	uint8_t rxCh;
+} SSP_DMA_CTX_T;
+
+static SSP_DMA_CTX_T sspDmaCtx[2];
+
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -80,15 +98,80 @@
  * Private functions
  ****************************************************************************/
 
-/*****************************************************************************
- * Public functions
- ****************************************************************************/
+/* Rate of the SSP base clock, the clock profiles are computed from it */
+static uint32_t Chip_SSP_Get_BaseClock(LPC_SSP_T *pSSP)
+{
+	if (pSSP == LPC_SSP0) {
+		return Chip_Clock_GetRate(CLK_MX_SSP0);
+	}
+	return Chip_Clock_GetRate(CLK_MX_SSP1);
+}
 
-/* SSP Polling Read/Write in blocking mode */
-uint32_t Chip_SSP_RWFrames_Blocking(LPC_SSP_T *pSSP, Chip_SSP_DATA_SETUP_T *xf_setup)
+/* The blocking kernel keeps at most a FIFO depth of frames in flight. The
+   transmit FIFO then always has room, and in master mode the receive FIFO
+   cannot overrun, so the status register is only read to drain what has
+   arrived.
+
+   It clocks the larger of *pTxFrames and *pRxFrames frames of 8 or, when
+   wide is set, 16 bits. The first *pTxFrames come from tx, all ones are
+   sent when tx is NULL or runs out; the first *pRxFrames received go to rx,
+   the rest and all of them when rx is NULL are dropped. On return both
+   hold how many of those frames went out and came in. */
+static Status SSP_Kernel(LPC_SSP_T *pSSP, const uint8_t *tx, uint8_t *rx,
+						 uint32_t *pTxFrames, uint32_t *pRxFrames, bool wide)
 {
-	uint16_t rDat;
+	uint32_t txWant = *pTxFrames, rxWant = *pRxFrames;
+	uint32_t frames = (txWant > rxWant) ? txWant : rxWant;
+	uint32_t sent = 0, recv = 0, step = wide ? 2 : 1;
+	uint16_t frame;
+
+	if (tx == NULL) {
+		txWant = 0;
+	}
+	if (rx == NULL) {
+		rxWant = 0;
+	}
+
+	while (recv < frames) {
+		while (((sent - recv) < SSP_FIFO_DEPTH) && (sent < frames)) {
+			if (sent < txWant) {
+				frame = wide ? *(const uint16_t *) tx : *tx;
+				tx += step;
+			}
+			else {
+				frame = 0xFFFF;
+			}
+			IP_SSP_SendFrame(pSSP, frame);
+			sent++;
+		}
+
+		if (IP_SSP_GetRawIntStatus(pSSP, SSP_RORRIS) == SET) {
+			break;
+		}
+
+		while ((recv < sent) && (IP_SSP_GetStatus(pSSP, SSP_STAT_RNE) == SET)) {
+			frame = IP_SSP_ReceiveFrame(pSSP);
+			if (recv < rxWant) {
+				if (wide) {
+					*(uint16_t *) rx = frame;
+				}
+				else {
+					*rx = (uint8_t) frame;
+				}
+				rx += step;
+			}
+			recv++;
+		}
+	}
 
+	*pTxFrames = (sent < *pTxFrames) ? sent : *pTxFrames;
+	*pRxFrames = (recv < *pRxFrames) ? recv : *pRxFrames;
+	return (recv == frames) ? SUCCESS : ERROR;
+}
+
+/* Empty the receive FIFO and clear the status before a blocking transfer */
+static void SSP_FlushRx(LPC_SSP_T *pSSP)
+{
 	/* Clear all remaining frames in RX FIFO */
 	while (IP_SSP_GetStatus(pSSP, SSP_STAT_RNE)) {
 		IP_SSP_ReceiveFrame(pSSP);
@@ -96,193 +179,377 @@ uint32_t Chip_SSP_RWFrames_Blocking(LPC_SSP_T *pSSP, Chip_SSP_DATA_SETUP_T *xf_s
 
 	/* Clear status */
 	IP_SSP_ClearIntPending(pSSP, SSP_INT_CLEAR_BITMASK);
+}
 
-	if (IP_SSP_GetDataSize(pSSP) > SSP_BITS_8) {
-		while (xf_setup->rx_cnt < xf_setup->length || xf_setup->tx_cnt < xf_setup->length) {
-			/* write data to buffer */
-			if (( IP_SSP_GetStatus(pSSP, SSP_STAT_TNF) == SET) && ( xf_setup->tx_cnt < xf_setup->length) ) {
-				SSP_Write2BFifo(pSSP, xf_setup)
-			}
-
-			/* Check overrun error */
-			if (IP_SSP_GetRawIntStatus(pSSP, SSP_RORRIS) == SET) {
-				return ERROR;
-			}
-
-			/* Check for any data available in RX FIFO */
-			SSP_Read2BFifo(pSSP, xf_setup, rDat)
+/* Describe one direction of a DMA transfer. The memory side increments
+   only when inc is set, by a byte or halfword per frame. */
+static Status SSP_DMA_BuildList(DMA_TransferDescriptor_t *desc, uint32_t conn, uint32_t mem, bool inc,
+								uint32_t frames, uint32_t width, IP_GPDMA_FLOW_CONTROL_T TransferType)
+{
+	bool toSSP = (TransferType == GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA);
+	uint32_t i, seg;
+
+	for (i = 0; frames > 0; i++, frames -= seg) {
+		seg = (frames > GPDMA_MAX_XFER_SIZE) ? GPDMA_MAX_XFER_SIZE : frames;
+		if (Chip_DMA_PrepareDescriptor(LPC_GPDMA, &desc[i], toSSP ? mem : conn, toSSP ? conn : mem, seg,
+									   TransferType, (frames > seg) ? &desc[i + 1] : NULL) == ERROR) {
+			return ERROR;
 		}
 
-		if (xf_setup->tx_data) {
-			return xf_setup->tx_cnt;
+		desc[i].ctrl &= ~(GPDMA_DMACCxControl_SWidth(7) | GPDMA_DMACCxControl_DWidth(7));
+		desc[i].ctrl |= GPDMA_DMACCxControl_SWidth(width) | GPDMA_DMACCxControl_DWidth(width);
+		if (!inc) {
+			desc[i].ctrl &= ~(toSSP ? GPDMA_DMACCxControl_SI : GPDMA_DMACCxControl_DI);
 		}
-		else if (xf_setup->rx_data) {
-			return xf_setup->rx_cnt;
+		else {
+			mem += seg << width;
 		}
-		return 0;
 	}
-	else {
-		while (xf_setup->rx_cnt < xf_setup->length || xf_setup->tx_cnt < xf_setup->length) {
-			/* write data to buffer */
-			if (( IP_SSP_GetStatus(pSSP, SSP_STAT_TNF) == SET) && ( xf_setup->tx_cnt < xf_setup->length) ) {
-				SSP_Write1BFifo(pSSP, xf_setup)
-			}
+	return SUCCESS;
+}
 
-			/* Check overrun error */
-			if (IP_SSP_GetRawIntStatus(pSSP, SSP_RORRIS) == SET) {
-				return ERROR;
-			}
+/* Give the channels of a DMA transfer back */
+static void SSP_DMA_Release(SSP_DMA_CTX_T *pCtx)
+{
+	IP_SSP_DMA_Disable(pCtx->pSSP, SSP_DMA_BITMASK);
+	if (pCtx->rxCh != GPDMA_CHANNEL_NONE) {
+		Chip_DMA_ReleaseChannel(LPC_GPDMA, pCtx->rxCh);
+		pCtx->rxCh = GPDMA_CHANNEL_NONE;
+	}
+	if (pCtx->txCh != GPDMA_CHANNEL_NONE) {
+		Chip_DMA_ReleaseChannel(LPC_GPDMA, pCtx->txCh);
+		pCtx->txCh = GPDMA_CHANNEL_NONE;
+	}
+}
 
-			/* Check for any data available in RX FIFO */
-			SSP_Read1BFifo(pSSP, xf_setup, rDat)
-		}
+/* GPDMA channel callback. The transfer is done when the receive channel
+   completes; an error on either channel ends it. */
+static void SSP_DMA_Event(uint8_t ChannelNum, Status result, void *pUserData)
+{
+	SSP_DMA_CTX_T *pCtx = (SSP_DMA_CTX_T *) pUserData;
+
+	if ((ChannelNum == pCtx->txCh) && (result == SUCCESS)) {
+		return;
+	}
+
+	SSP_DMA_Release(pCtx);
+	if (pCtx->callback != NULL) {
+		pCtx->callback(pCtx->pSSP, result, pCtx->pUserData);
+	}
+}
+
+/* Next transaction for a bus. One for the device the SSP is set up for
+   saves a reprogramming, unless SSP_BUS_BATCH of them already went ahead
+   of the queue head; a held chip select allows no other device. */
+static SSP_BUS_XFER_T *SSP_Bus_Pick(SSP_BUS_T *pBus)
+{
+	SSP_BUS_XFER_T *pXfer = pBus->head, *pPrev = NULL;
 
-		if (xf_setup->tx_data) {
-			return xf_setup->tx_cnt;
+	if ((pBus->pCurDev != NULL) && (pBus->csHeld || (pBus->batch < SSP_BUS_BATCH))) {
+		while ((pXfer != NULL) && (pXfer->pDev != pBus->pCurDev)) {
+			pPrev = pXfer;
+			pXfer = pXfer->next;
 		}
-		else if (xf_setup->rx_data) {
-			return xf_setup->rx_cnt;
+		if ((pXfer == NULL) && !pBus->csHeld) {
+			pXfer = pBus->head;
+			pPrev = NULL;
 		}
-		return 0;
 	}
+	if (pXfer == NULL) {
+		return NULL;
+	}
+
+	if (pPrev == NULL) {
+		pBus->head = pXfer->next;
+		pBus->batch = 0;
+	}
+	else {
+		pPrev->next = pXfer->next;
+		pBus->batch++;
+	}
+	if (pBus->tail == pXfer) {
+		pBus->tail = pPrev;
+	}
+	return pXfer;
 }
 
-/* SSP Polling Write in blocking mode */
-uint32_t Chip_SSP_WriteFrames_Blocking(LPC_SSP_T *pSSP, uint8_t *buffer, uint32_t buffer_len)
+/* End the running bus transaction */
+static void SSP_Bus_Finish(SSP_BUS_T *pBus, Status result)
 {
-	uint32_t tx_cnt = 0, rx_cnt = 0;
+	SSP_BUS_XFER_T *pXfer = pBus->active;
 
-	/* Clear all remaining frames in RX FIFO */
-	while (IP_SSP_GetStatus(pSSP, SSP_STAT_RNE)) {
-		IP_SSP_ReceiveFrame(pSSP);
+	pBus->csHeld = pXfer->keepCS && (result == SUCCESS);
+	if (!pBus->csHeld) {
+		Chip_GPIO_WritePortBit(LPC_GPIO_PORT, pXfer->pDev->cs.port, pXfer->pDev->cs.pin, true);
 	}
 
-	/* Clear status */
-	IP_SSP_ClearIntPending(pSSP, SSP_INT_CLEAR_BITMASK);
-
-	if (IP_SSP_GetDataSize(pSSP) > SSP_BITS_8) {
-		uint16_t *wdata16;
+	pBus->active = NULL;
+	if (pXfer->callback != NULL) {
+		pXfer->callback(pXfer, result);
+	}
+}
 
-		wdata16 = (uint16_t *) buffer;
+static void SSP_Bus_Run(SSP_BUS_T *pBus);
 
-		while (tx_cnt < buffer_len || rx_cnt < buffer_len) {
-			/* write data to buffer */
-			if ((IP_SSP_GetStatus(pSSP, SSP_STAT_TNF) == SET) && (tx_cnt < buffer_len)) {
-				IP_SSP_SendFrame(pSSP, *wdata16);
-				wdata16++;
-				tx_cnt += 2;
-			}
+/* GPDMA completion of a bus transaction */
+static void SSP_Bus_DMADone(LPC_SSP_T *pSSP, Status result, void *pUserData)
+{
+	SSP_Bus_Finish((SSP_BUS_T *) pUserData, result);
+	SSP_Bus_Run((SSP_BUS_T *) pUserData);
+}
 
-			/* Check overrun error */
-			if (IP_SSP_GetRawIntStatus(pSSP, SSP_RORRIS) == SET) {
-				return ERROR;
-			}
+/* Start the next transaction if the bus is idle, or the one left waiting
+   for GPDMA channels. It stays waiting when there are still none free and
+   is retried on the next submit or channel release. */
+static void SSP_Bus_Run(SSP_BUS_T *pBus)
+{
+	SSP_BUS_XFER_T *pXfer = NULL;
+	SSP_BUS_DEVICE_T *pDev;
+	uint32_t primask;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (pBus->active == NULL) {
+		pXfer = pBus->active = SSP_Bus_Pick(pBus);
+	}
+	else if (pBus->stalled) {
+		pXfer = pBus->active;
+		pBus->stalled = false;
+	}
+	__set_PRIMASK(primask);
+	if (pXfer == NULL) {
+		return;
+	}
 
-			/* Check for any data available in RX FIFO */
-			while (IP_SSP_GetStatus(pSSP, SSP_STAT_RNE) == SET) {
-				IP_SSP_ReceiveFrame(pSSP);	/* read dummy data */
-				rx_cnt += 2;
-			}
+	/* Reprogram only for another device or a changed base clock, with the
+	   SSP disabled */
+	pDev = pXfer->pDev;
+	if ((pDev != pBus->pCurDev) || !Chip_SSP_ClockProfileValid(&pDev->profile)) {
+		if (!Chip_SSP_ClockProfileValid(&pDev->profile)) {
+			/* First use, or computed before a clock change */
+			Chip_SSP_Calc_ClockProfile(pBus->pSSP, pDev->bitRate, &pDev->profile);
 		}
+		IP_SSP_Disable(pBus->pSSP);
+		IP_SSP_Set_Format(pBus->pSSP, pDev->bits, SSP_FRAMEFORMAT_SPI, pDev->clockFormat);
+		Chip_SSP_Set_ClockProfile(pBus->pSSP, &pDev->profile);
+		IP_SSP_Enable(pBus->pSSP);
+		pBus->pCurDev = pDev;
+	}
+	Chip_GPIO_WritePortBit(LPC_GPIO_PORT, pDev->cs.port, pDev->cs.pin, false);
 
-		return tx_cnt;
+	if (Chip_SSP_DMA_Transfer(pBus->pSSP, pXfer->tx_data, pXfer->rx_data, pXfer->frames,
+							  SSP_Bus_DMADone, pBus) == SUCCESS) {
+		return;
 	}
-	else {
-		uint8_t *wdata8;
 
-		wdata8 = buffer;
+	/* No GPDMA channels free, wait for one with the chip select released */
+	if (!pBus->csHeld) {
+		Chip_GPIO_WritePortBit(LPC_GPIO_PORT, pDev->cs.port, pDev->cs.pin, true);
+	}
+	pBus->stalled = true;
+}
 
-		while (tx_cnt < buffer_len || rx_cnt < buffer_len) {
-			/* write data to buffer */
-			if ((IP_SSP_GetStatus(pSSP, SSP_STAT_TNF) == SET) && (tx_cnt < buffer_len)) {
-				IP_SSP_SendFrame(pSSP, *wdata8);
-				wdata8++;
-				tx_cnt++;
-			}
+/* GPDMA release waiter, retries a bus transaction waiting for channels */
+static void SSP_Bus_Retry(void *pUserData)
+{
+	SSP_BUS_T *pBus = (SSP_BUS_T *) pUserData;
 
-			/* Check overrun error */
-			if (IP_SSP_GetRawIntStatus(pSSP, SSP_RORRIS) == SET) {
-				return ERROR;
-			}
+	if (pBus->stalled) {
+		SSP_Bus_Run(pBus);
+	}
+}
 
-			/* Check for any data available in RX FIFO */
-			while (IP_SSP_GetStatus(pSSP, SSP_STAT_RNE) == SET && rx_cnt < buffer_len) {
-				IP_SSP_ReceiveFrame(pSSP);	/* read dummy data */
-				rx_cnt++;
-			}
-		}
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* SSP Polling Read/Write in blocking mode */
+uint32_t Chip_SSP_RWFrames_Blocking(LPC_SSP_T *pSSP, Chip_SSP_DATA_SETUP_T *xf_setup)
+{
+	uint8_t *tx = (uint8_t *) xf_setup->tx_data;
+	uint8_t *rx = (uint8_t *) xf_setup->rx_data;
+	uint32_t txFrames, rxFrames;
+	bool wide = IP_SSP_GetDataSize(pSSP) > SSP_BITS_8;
+	Status ret;
+
+	SSP_FlushRx(pSSP);
+
+	/* Each direction resumes from its own count */
+	txFrames = (xf_setup->tx_cnt < xf_setup->length) ? (xf_setup->length - xf_setup->tx_cnt) : 0;
+	rxFrames = (xf_setup->rx_cnt < xf_setup->length) ? (xf_setup->length - xf_setup->rx_cnt) : 0;
+	if (tx != NULL) {
+		tx += xf_setup->tx_cnt;
+	}
+	if (rx != NULL) {
+		rx += xf_setup->rx_cnt;
+	}
+	if (wide) {
+		txFrames = (txFrames + 1) >> 1;
+		rxFrames = (rxFrames + 1) >> 1;
+	}
+
+	/* Record the frames that made it, also when the transfer fails */
+	ret = SSP_Kernel(pSSP, tx, rx, &txFrames, &rxFrames, wide);
+	xf_setup->tx_cnt += wide ? (txFrames << 1) : txFrames;
+	xf_setup->rx_cnt += wide ? (rxFrames << 1) : rxFrames;
+	if (ret == ERROR) {
+		return ERROR;
+	}
+
+	if (xf_setup->tx_data) {
+		return xf_setup->tx_cnt;
+	}
+	else if (xf_setup->rx_data) {
+		return xf_setup->rx_cnt;
+	}
+	return 0;
+}
 
-		return tx_cnt;
+/* SSP Polling Write in blocking mode */
+uint32_t Chip_SSP_WriteFrames_Blocking(LPC_SSP_T *pSSP, uint8_t *buffer, uint32_t buffer_len)
+{
+	bool wide = IP_SSP_GetDataSize(pSSP) > SSP_BITS_8;
+	uint32_t txFrames = wide ? ((buffer_len + 1) >> 1) : buffer_len, rxFrames = 0;
+
+	SSP_FlushRx(pSSP);
+
+	if (SSP_Kernel(pSSP, buffer, NULL, &txFrames, &rxFrames, wide) == ERROR) {
+		return ERROR;
 	}
+
+	return wide ? (txFrames << 1) : txFrames;
 }
 
 /* SSP Polling Read in blocking mode */
 uint32_t Chip_SSP_ReadFrames_Blocking(LPC_SSP_T *pSSP, uint8_t *buffer, uint32_t buffer_len)
 {
-	uint32_t rx_cnt = 0, tx_cnt = 0;
+	bool wide = IP_SSP_GetDataSize(pSSP) > SSP_BITS_8;
+	uint32_t txFrames = 0, rxFrames = wide ? ((buffer_len + 1) >> 1) : buffer_len;
 
-	/* Clear all remaining frames in RX FIFO */
-	while (IP_SSP_GetStatus(pSSP, SSP_STAT_RNE)) {
-		IP_SSP_ReceiveFrame(pSSP);
+	SSP_FlushRx(pSSP);
+
+	if (SSP_Kernel(pSSP, NULL, buffer, &txFrames, &rxFrames, wide) == ERROR) {
+		return ERROR;
 	}
 
-	/* Clear status */
-	IP_SSP_ClearIntPending(pSSP, SSP_INT_CLEAR_BITMASK);
+	return wide ? (rxFrames << 1) : rxFrames;
+}
 
-	if (IP_SSP_GetDataSize(pSSP) > SSP_BITS_8) {
-		uint16_t *rdata16;
+/* Transfer frames with the GPDMA */
+Status Chip_SSP_DMA_Transfer(LPC_SSP_T *pSSP, const void *tx_data, void *rx_data, uint32_t frames,
+							 SSP_DMA_CALLBACK_T callback, void *pUserData)
+{
+	SSP_DMA_CTX_T *pCtx = &sspDmaCtx[(pSSP == LPC_SSP0) ? 0 : 1];
+	uint32_t width;
 
-		rdata16 = (uint16_t *) buffer;
+	if ((frames == 0) || (frames > SSP_DMA_MAXLEN) || (pCtx->rxCh != GPDMA_CHANNEL_NONE)) {
+		return ERROR;
+	}
 
-		while (tx_cnt < buffer_len || rx_cnt < buffer_len) {
-			/* write data to buffer */
-			if ((IP_SSP_GetStatus(pSSP, SSP_STAT_TNF) == SET) && (tx_cnt < buffer_len)) {
-				IP_SSP_SendFrame(pSSP, 0xFFFF);	/* just send dummy data */
-				tx_cnt += 2;
-			}
+	/* Receive gets the higher priority channel, it must keep up */
+	pCtx->rxCh = Chip_DMA_AllocChannel(LPC_GPDMA, GPDMA_PRIO_HIGH);
+	pCtx->txCh = Chip_DMA_AllocChannel(LPC_GPDMA, GPDMA_PRIO_LOW);
+	pCtx->pSSP = pSSP;
+	pCtx->callback = callback;
+	pCtx->pUserData = pUserData;
+	pCtx->dummy = 0xFFFF;
+	if ((pCtx->rxCh == GPDMA_CHANNEL_NONE) || (pCtx->txCh == GPDMA_CHANNEL_NONE)) {
+		SSP_DMA_Release(pCtx);
+		return ERROR;
+	}
 
-			/* Check overrun error */
-			if (IP_SSP_GetRawIntStatus(pSSP, SSP_RORRIS) == SET) {
-				return ERROR;
-			}
+	width = (IP_SSP_GetDataSize(pSSP) > SSP_BITS_8) ? GPDMA_WIDTH_HALFWORD : GPDMA_WIDTH_BYTE;
+	if ((SSP_DMA_BuildList(pCtx->rxDesc, (pSSP == LPC_SSP0) ? GPDMA_CONN_SSP0_Rx : GPDMA_CONN_SSP1_Rx,
+						   (rx_data != NULL) ? (uint32_t) (uintptr_t) rx_data : (uint32_t) (uintptr_t) &pCtx->sink,
+						   rx_data != NULL, frames, width, GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA) == ERROR) ||
+		(SSP_DMA_BuildList(pCtx->txDesc, (pSSP == LPC_SSP0) ? GPDMA_CONN_SSP0_Tx : GPDMA_CONN_SSP1_Tx,
+						   (tx_data != NULL) ? (uint32_t) (uintptr_t) tx_data : (uint32_t) (uintptr_t) &pCtx->dummy,
+						   tx_data != NULL, frames, width, GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA) == ERROR)) {
+		SSP_DMA_Release(pCtx);
+		return ERROR;
+	}
 
-			/* Check for any data available in RX FIFO */
-			while (IP_SSP_GetStatus(pSSP, SSP_STAT_RNE) == SET && rx_cnt < buffer_len) {
-				*rdata16 = IP_SSP_ReceiveFrame(pSSP);
-				rdata16++;
-				rx_cnt += 2;
-			}
-		}
+	SSP_FlushRx(pSSP);
+	Chip_DMA_SetCallback(LPC_GPDMA, pCtx->rxCh, SSP_DMA_Event, pCtx);
+	Chip_DMA_SetCallback(LPC_GPDMA, pCtx->txCh, SSP_DMA_Event, pCtx);
+
+	/* Receive is armed before the first frame goes out */
+	if ((Chip_DMA_SGTransferConn(LPC_GPDMA, pCtx->rxCh, pCtx->rxDesc,
+								 (pSSP == LPC_SSP0) ? GPDMA_CONN_SSP0_Rx : GPDMA_CONN_SSP1_Rx, GPDMA_CONN_MEMORY,
+								 GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA) == ERROR) ||
+		(Chip_DMA_SGTransferConn(LPC_GPDMA, pCtx->txCh, pCtx->txDesc,
+								 GPDMA_CONN_MEMORY, (pSSP == LPC_SSP0) ? GPDMA_CONN_SSP0_Tx : GPDMA_CONN_SSP1_Tx,
+								 GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA) == ERROR)) {
+		SSP_DMA_Release(pCtx);
+		return ERROR;
+	}
+	IP_SSP_DMA_Enable(pSSP, SSP_DMA_BITMASK);
+
+	return SUCCESS;
+}
 
-		return rx_cnt;
+/* Abort a GPDMA transfer */
+void Chip_SSP_DMA_Abort(LPC_SSP_T *pSSP)
+{
+	SSP_DMA_CTX_T *pCtx = &sspDmaCtx[(pSSP == LPC_SSP0) ? 0 : 1];
+
+	if (pCtx->rxCh != GPDMA_CHANNEL_NONE) {
+		SSP_DMA_Release(pCtx);
+		Chip_SSP_Int_FlushData(pSSP);
 	}
-	else {
-		uint8_t *rdata8;
+}
 
-		rdata8 = buffer;
+/* Set up a bus of devices sharing an SSP */
+void Chip_SSP_Bus_Init(SSP_BUS_T *pBus, LPC_SSP_T *pSSP)
+{
+	pBus->pSSP = pSSP;
+	pBus->pCurDev = NULL;
+	pBus->head = pBus->tail = pBus->active = NULL;
+	pBus->batch = 0;
+	pBus->csHeld = false;
+	pBus->stalled = false;
+	pBus->dmaWaiter.callback = SSP_Bus_Retry;
+	pBus->dmaWaiter.pUserData = pBus;
+	Chip_DMA_AddReleaseWaiter(LPC_GPDMA, &pBus->dmaWaiter);
+}
 
-		while (tx_cnt < buffer_len || rx_cnt < buffer_len) {
-			/* write data to buffer */
-			if ((IP_SSP_GetStatus(pSSP, SSP_STAT_TNF) == SET) && (tx_cnt < buffer_len)) {
-				IP_SSP_SendFrame(pSSP, 0xFF);	/* just send dummy data		 */
-				tx_cnt++;
-			}
+/* Stop using a bus */
+void Chip_SSP_Bus_DeInit(SSP_BUS_T *pBus)
+{
+	Chip_DMA_RemoveReleaseWaiter(LPC_GPDMA, &pBus->dmaWaiter);
+}
 
-			/* Check overrun error */
-			if (IP_SSP_GetRawIntStatus(pSSP, SSP_RORRIS) == SET) {
-				return ERROR;
-			}
+/* Set up the chip select of a bus device */
+void Chip_SSP_Bus_AddDevice(SSP_BUS_DEVICE_T *pDev)
+{
+	pDev->profile.clkRate = 0;
+	Chip_GPIO_WritePortBit(LPC_GPIO_PORT, pDev->cs.port, pDev->cs.pin, true);
+	Chip_GPIO_WriteDirBit(LPC_GPIO_PORT, pDev->cs.port, pDev->cs.pin, true);
+}
 
-			/* Check for any data available in RX FIFO */
-			while (IP_SSP_GetStatus(pSSP, SSP_STAT_RNE) == SET && rx_cnt < buffer_len) {
-				*rdata8 = IP_SSP_ReceiveFrame(pSSP);
-				rdata8++;
-				rx_cnt++;
-			}
-		}
+/* Queue a transaction on a bus */
+Status Chip_SSP_Bus_Submit(SSP_BUS_T *pBus, SSP_BUS_XFER_T *pXfer)
+{
+	uint32_t primask;
+
+	if ((pXfer->frames == 0) || (pXfer->frames > SSP_DMA_MAXLEN)) {
+		return ERROR;
+	}
 
-		return rx_cnt;
+	primask = __get_PRIMASK();
+	__disable_irq();
+	pXfer->next = NULL;
+	if (pBus->tail != NULL) {
+		pBus->tail->next = pXfer;
 	}
+	else {
+		pBus->head = pXfer;
+	}
+	pBus->tail = pXfer;
+	__set_PRIMASK(primask);
+
+	SSP_Bus_Run(pBus);
+	return SUCCESS;
 }
 
 /* Clean all data in RX FIFO of SSP */
@@ -376,34 +643,39 @@ void Chip_SSP_Set_Master(LPC_SSP_T *pSSP, bool master)
 	}
 }
 
-/* Set the clock frequency for SSP interface */
-void Chip_SSP_Set_BitRate(LPC_SSP_T *pSSP, uint32_t bit_rate)
+/* Compute the clock profile for a bit rate */
+void Chip_SSP_Calc_ClockProfile(LPC_SSP_T *pSSP, uint32_t bit_rate, SSP_CLOCK_PROFILE_T *pProfile)
 {
-	uint32_t ssp_clk, cr0_div, cmp_clk, prescale;
-
-	if (pSSP == LPC_SSP0) {
-		ssp_clk = Chip_Clock_GetRate(CLK_MX_SSP0);
+	uint32_t ssp_clk, div, prescale;
+
+	/* Generation first, a change while reading the rate then shows */
+	pProfile->clkGen = Chip_Clock_GetGeneration();
+	ssp_clk = Chip_SSP_Get_BaseClock(pSSP);
+
+	/* Smallest divider with ssp_clk / div <= bit_rate, then the smallest
+	   even prescaler that reaches it with at most 256 clocks per bit */
+	div = (bit_rate >= ssp_clk) ? 1 : ((ssp_clk / (bit_rate + 1)) + 1);
+	prescale = ((div + 511) / 512) * 2;
+	if (prescale < 2) {
+		prescale = 2;
 	}
-	else {
-		ssp_clk = Chip_Clock_GetRate(CLK_MX_SSP1);
+	else if (prescale > 254) {
+		prescale = 254;
+		div = 254 * 256;
 	}
 
-	cr0_div = 0;
-	cmp_clk = 0xFFFFFFFF;
-	prescale = 2;
+	pProfile->clkRate = ssp_clk;
+	pProfile->cpsr = (uint8_t) prescale;
+	pProfile->scr = (uint8_t) (((div + prescale - 1) / prescale) - 1);
+}
 
-	while (cmp_clk > bit_rate) {
-		cmp_clk = ssp_clk / ((cr0_div + 1) * prescale);
-		if (cmp_clk > bit_rate) {
-			cr0_div++;
-			if (cr0_div > 0xFF) {
-				cr0_div = 0;
-				prescale += 2;
-			}
-		}
-	}
+/* Set the clock frequency for SSP interface */
+void Chip_SSP_Set_BitRate(LPC_SSP_T *pSSP, uint32_t bit_rate)
+{
+	SSP_CLOCK_PROFILE_T profile;
 
-	IP_SSP_Set_ClockRate(pSSP, cr0_div, prescale);
+	Chip_SSP_Calc_ClockProfile(pSSP, bit_rate, &profile);
+	Chip_SSP_Set_ClockProfile(pSSP, &profile);
 }
 
 /* Initialize the SSP */
@@ -419,6 +691,10 @@ void Chip_SSP_Init(LPC_SSP_T *pSSP)
 	IP_SSP_Set_Mode(pSSP, SSP_MODE_MASTER);
 	IP_SSP_Set_Format(pSSP, SSP_BITS_8, SSP_FRAMEFORMAT_SPI, SSP_CLOCK_CPHA0_CPOL0);
 	Chip_SSP_Set_BitRate(pSSP, 100000);
+
+	/* No GPDMA transfer running */
+	sspDmaCtx[(pSSP == LPC_SSP0) ? 0 : 1].txCh = GPDMA_CHANNEL_NONE;
+	sspDmaCtx[(pSSP == LPC_SSP0) ? 0 : 1].rxCh = GPDMA_CHANNEL_NONE;
 }
 
 /* Shutdown the SSP */
@@ -30,18 +30,33 @@
  */
 
 #include "chip.h"
+#include "string.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
  ****************************************************************************/
 
-/** UART Ring buffer declaration*/
-static UART_RingBuffer_T rb;
+/** Number of UART ports */
+#define UART_NUM_PORTS 4
 
-/** Current Tx Interrupt enable state */
-static __IO FlagStatus TxIntStat;
+/** Ring buffer context registered for each UART port */
+static UART_RB_CTX_T *uartRBCtx[UART_NUM_PORTS];
 
-FlagStatus ABsyncSts = RESET;
+/** Auto-baud sync state of each UART port */
+static __IO FlagStatus ABsyncSts[UART_NUM_PORTS];
+
+/** GPDMA receive request line of each UART port */
+static const uint8_t uartRxDmaConn[UART_NUM_PORTS] = {
+	GPDMA_CONN_UART0_Rx, GPDMA_CONN_UART1_Rx, GPDMA_CONN_UART2_Rx, GPDMA_CONN_UART3_Rx
+};
+
+/** GPDMA transmit request line of each UART port */
+static const uint8_t uartTxDmaConn[UART_NUM_PORTS] = {
+	GPDMA_CONN_UART0_Tx, GPDMA_CONN_UART1_Tx, GPDMA_CONN_UART2_Tx, GPDMA_CONN_UART3_Tx
+};
+
+/** Largest GPDMA transfer size of one descriptor */
+#define UART_DMA_MAX_XFER 0xFFF
 /*****************************************************************************
  * Public types/enumerations/variables
  ****************************************************************************/
@@ -87,6 +102,242 @@ static CHIP_CCU_CLK_T Chip_UART_DetermineClk(LPC_USART_T *pUART) {
 	return uartclk;
 }
 
+/* Refill the transmit FIFO from the transmit ring buffer in one burst,
+   the caller has seen THRE so the whole FIFO is free */
+static void Chip_UART_TxRingToFifo(LPC_USART_T *pUART, UART_RB_CTX_T *pCtx)
+{
+	uint8_t *data;
+	int num, cnt, room = UART_TX_FIFO_SIZE;
+
+	while (room > 0) {
+		num = RingBuffer_GetReadSpan(&pCtx->txRB, (void **) &data);
+		if (num == 0) {
+			break;
+		}
+		if (num > room) {
+			num = room;
+		}
+
+		room -= num;
+		for (cnt = 0; cnt < num; cnt++) {
+			pUART->THR = data[cnt];
+		}
+		RingBuffer_Consume(&pCtx->txRB, num);
+	}
+}
+
+/* Enable the THRE interrupt while transmit data is queued, else disable it */
+static void Chip_UART_TxUpdateIntState(LPC_USART_T *pUART, UART_RB_CTX_T *pCtx)
+{
+	if (RingBuffer_IsEmpty(&pCtx->txRB)) {
+		Chip_UART_IntConfig(pUART, UART_INTCFG_THRE, DISABLE);
+		/* Reset Tx Interrupt state */
+		pCtx->TxIntStat = RESET;
+	}
+	else {
+		/* Set Tx Interrupt state */
+		pCtx->TxIntStat = SET;
+		Chip_UART_IntConfig(pUART, UART_INTCFG_THRE, ENABLE);
+	}
+}
+
+/* Drain the receive FIFO into the receive ring buffer */
+static void Chip_UART_RxFifoToRing(LPC_USART_T *pUART, UART_RB_CTX_T *pCtx)
+{
+	uint8_t *data;
+	int num, cnt;
+
+	while (pUART->LSR & UART_LSR_RDR) {
+		num = RingBuffer_GetWriteSpan(&pCtx->rxRB, (void **) &data);
+		if (num == 0) {
+			/* No more space, remaining characters are trimmed out */
+			while (pUART->LSR & UART_LSR_RDR) {
+				(void) pUART->RBR;
+			}
+			break;
+		}
+
+		cnt = 0;
+		do {
+			data[cnt++] = (uint8_t) (pUART->RBR & UART_RBR_MASKBIT);
+		} while ((cnt < num) && (pUART->LSR & UART_LSR_RDR));
+		RingBuffer_CommitWrite(&pCtx->rxRB, cnt);
+	}
+}
+
+/* Move the receive ring head up to the GPDMA write position. The UART
+   and GPDMA interrupts and Chip_UART_DMA_RxSync() all publish, so it is
+   done with interrupts masked. Each terminal count (halfDone) takes the
+   GPDMA past one more half boundary; a position behind the boundaries
+   counted so far means it went round the ring once more than it shows. */
+static uint32_t Chip_UART_RxDmaPublish(UART_RB_CTX_T *pCtx, bool halfDone)
+{
+	RINGBUFF_T *rb = &pCtx->rxRB;
+	uint32_t pos, num, primask;
+	int over;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	/* Receive DMA may have been stopped since the caller checked */
+	if (pCtx->rxDmaCh < 0) {
+		__set_PRIMASK(primask);
+		return 0;
+	}
+
+	pos = LPC_GPDMA->CH[pCtx->rxDmaCh].DESTADDR - (uint32_t) (uintptr_t) rb->data;
+	num = (pos - RB_INDH(rb)) & (rb->count - 1);
+	if (halfDone) {
+		pCtx->rxDmaBound += rb->count / 2;
+		if ((int32_t) (pCtx->rxDmaBound - (rb->head + num)) > 0) {
+			num += rb->count;
+		}
+	}
+
+	if (num != 0) {
+		/* The tail belongs to the reader, which drops what the GPDMA has
+		   overwritten; only the newly lost bytes are counted here */
+		RingBuffer_CommitWrite(rb, num);
+		over = RingBuffer_GetCount(rb) - rb->count;
+		if (over > 0) {
+			pCtx->rxDmaOverrun += ((uint32_t) over < num) ? (uint32_t) over : num;
+		}
+	}
+
+	__set_PRIMASK(primask);
+	return num;
+}
+
+/* Publish new receive data and notify the application */
+static uint32_t Chip_UART_RxDmaToRing(LPC_USART_T *pUART, UART_RB_CTX_T *pCtx, bool halfDone)
+{
+	uint32_t num = Chip_UART_RxDmaPublish(pCtx, halfDone);
+
+	if ((num != 0) && (pCtx->rxDmaCallback != NULL)) {
+		pCtx->rxDmaCallback(pUART, num);
+	}
+	return num;
+}
+
+/* Chain all waiting transmit requests and start them on the channel,
+   called with the channel idle and interrupts locked out */
+static void Chip_UART_TxDmaStart(LPC_USART_T *pUART, UART_RB_CTX_T *pCtx)
+{
+	UART_DMA_TX_REQ_T *pReq = pCtx->txDmaPend;
+
+	if (pReq == NULL) {
+		return;
+	}
+
+	for (; pReq != NULL; pReq = pReq->next) {
+		pReq->desc[pReq->numDesc - 1].lli = (pReq->next != NULL) ? (uint32_t) (uintptr_t) &pReq->next->desc[0] : 0;
+	}
+
+	pCtx->txDmaActive = pCtx->txDmaPend;
+	pCtx->txDmaPend = pCtx->txDmaPendTail = NULL;
+	Chip_DMA_SGTransferConn(LPC_GPDMA, (uint8_t) pCtx->txDmaCh, &pCtx->txDmaActive->desc[0],
+							GPDMA_CONN_MEMORY, uartTxDmaConn[Chip_UART_Get_UARTNum(pUART)],
+							GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA);
+}
+
+/* Check if the channel is still on a request, from the next descriptor it
+   will load: one of the request's own, the first of the following request
+   or none after the last request */
+static bool Chip_UART_TxDmaInProgress(const UART_DMA_TX_REQ_T *pReq, uint32_t next)
+{
+	uint32_t i;
+
+	for (i = 1; i < pReq->numDesc; i++) {
+		if (next == (uint32_t) (uintptr_t) &pReq->desc[i]) {
+			return true;
+		}
+	}
+	if (pReq->next == NULL) {
+		return next == 0;
+	}
+	return next == (uint32_t) (uintptr_t) &pReq->next->desc[0];
+}
+
+/* Complete the active requests the channel is done with, all of them once
+   it has stopped */
+static void Chip_UART_TxDmaRetire(LPC_USART_T *pUART, UART_RB_CTX_T *pCtx, Status result)
+{
+	UART_DMA_TX_REQ_T *pReq;
+	uint8_t ch = (uint8_t) pCtx->txDmaCh;
+	bool busy = Chip_GPDMA_IntGetStatus(LPC_GPDMA, GPDMA_STAT_ENABLED_CH, ch) != RESET;
+	uint32_t next = LPC_GPDMA->CH[ch].LLI;
+
+	while ((pReq = pCtx->txDmaActive) != NULL) {
+		if (busy && Chip_UART_TxDmaInProgress(pReq, next)) {
+			break;
+		}
+
+		pCtx->txDmaActive = pReq->next;
+		pReq->next = NULL;
+		if (pReq->callback != NULL) {
+			pReq->callback(pUART, pReq, busy ? SUCCESS : result);
+		}
+	}
+}
+
+/* GPDMA receive channel callback, on each half/full ring completion */
+static void Chip_UART_RxDmaEvent(uint8_t ChannelNum, Status result, void *pUserData)
+{
+	LPC_USART_T *pUART = (LPC_USART_T *) pUserData;
+	UART_RB_CTX_T *pCtx = uartRBCtx[Chip_UART_Get_UARTNum(pUART)];
+
+	if ((pCtx == NULL) || (pCtx->rxDmaCh != (int8_t) ChannelNum)) {
+		return;
+	}
+
+	Chip_UART_RxDmaToRing(pUART, pCtx, result == SUCCESS);
+	if (result == ERROR) {
+		/* The channel stops on a bus error, fall back to interrupt receive */
+		pCtx->rxDmaCh = -1;
+		Chip_DMA_SetCallback(LPC_GPDMA, ChannelNum, NULL, NULL);
+		Chip_DMA_Stop(LPC_GPDMA, ChannelNum);
+	}
+}
+
+/* GPDMA transmit channel callback, on each request completion */
+static void Chip_UART_TxDmaEvent(uint8_t ChannelNum, Status result, void *pUserData)
+{
+	LPC_USART_T *pUART = (LPC_USART_T *) pUserData;
+	UART_RB_CTX_T *pCtx = uartRBCtx[Chip_UART_Get_UARTNum(pUART)];
+
+	if ((pCtx == NULL) || (pCtx->txDmaCh != (int8_t) ChannelNum)) {
+		return;
+	}
+
+	/* A request is done once the channel has loaded past its last
+	   descriptor, the next chain starts when the channel stops (also
+	   on a bus error, which loses the rest of the chain) */
+	Chip_UART_TxDmaRetire(pUART, pCtx, result);
+	if (pCtx->txDmaActive == NULL) {
+		Chip_UART_TxDmaStart(pUART, pCtx);
+	}
+}
+
+/* Acknowledge the interrupt of one channel and pass it on, for
+   applications that do not use Chip_GPDMA_Interrupt_Handler() */
+static void Chip_UART_DMA_AckChannel(uint8_t ch, GPDMA_CALLBACK_T event, LPC_USART_T *pUART)
+{
+	Status result = SUCCESS;
+
+	if (Chip_GPDMA_IntGetStatus(LPC_GPDMA, GPDMA_STAT_INTTC, ch)) {
+		Chip_GPDMA_ClearIntPending(LPC_GPDMA, GPDMA_STATCLR_INTTC, ch);
+	}
+	else if (!Chip_GPDMA_IntGetStatus(LPC_GPDMA, GPDMA_STAT_INTERR, ch)) {
+		return;
+	}
+	if (Chip_GPDMA_IntGetStatus(LPC_GPDMA, GPDMA_STAT_INTERR, ch)) {
+		Chip_GPDMA_ClearIntPending(LPC_GPDMA, GPDMA_STATCLR_INTERR, ch);
+		result = ERROR;
+	}
+
+	event(ch, result, pUART);
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
@@ -178,80 +429,40 @@ IP_UART_INT_STATUS_T Chip_UART_GetIntStatus(LPC_USART_T *pUART)
 /* UART interrupt service routine */
 void Chip_UART_Interrupt_Handler(LPC_USART_T *pUART)
 {
-	uint8_t tmpc;
-	uint32_t rLen;
+	IP_UART_ID_T UARTPort = Chip_UART_Get_UARTNum(pUART);
+	UART_RB_CTX_T *pCtx = uartRBCtx[UARTPort];
 	IP_UART_INT_STATUS_T Sts = Chip_UART_GetIntStatus(pUART);
 	if (Sts == UART_INTSTS_ERROR) {
 		return;	/* error */
 	}
-	if (Sts & UART_INTSTS_RTR) {	/* ready for Read Data */
-		while (1) {
-			/* Call UART read function in UART driver */
-			rLen = Chip_UART_Receive(pUART, &tmpc, 1, NONE_BLOCKING);
-			/* If data received */
-			if (rLen) {
-				/* Check if buffer is more space
-				 * If no more space, remaining character will be trimmed out
-				 */
-				if (!__BUF_IS_FULL(rb.rx_head, rb.rx_tail)) {
-					rb.rx[rb.rx_head] = tmpc;
-					__BUF_INCR(rb.rx_head);
-				}
-			}
-			/* no more data */
-			else {
-				break;
-			}
-		}
-	}
-
-	if (Sts & UART_INTSTS_RTS) {	/* ready for Write Data */
-		/* Disable THRE interrupt */
-		Chip_UART_IntConfig(pUART, UART_INTCFG_THRE, DISABLE);
-
-		/* Wait for FIFO buffer empty, transfer UART_TX_FIFO_SIZE bytes
-		 * of data or break whenever ring buffers are empty */
-		/* Wait until THR empty */
-		while (Chip_UART_CheckBusy(pUART) == SET) {}
-
-		while (!__BUF_IS_EMPTY(rb.tx_head, rb.tx_tail)) {
-			/* Move a piece of data into the transmit FIFO */
-			if (Chip_UART_Send(pUART, (uint8_t *) &rb.tx[rb.tx_tail], 1, NONE_BLOCKING)) {
-				/* Update transmit ring FIFO tail pointer */
-				__BUF_INCR(rb.tx_tail);
-			}
-			else {
-				break;
-			}
-		}
-
-		/* If there is no more data to send, disable the transmit
-		   interrupt - else enable it or keep it enabled */
-		if (__BUF_IS_EMPTY(rb.tx_head, rb.tx_tail)) {
-			Chip_UART_IntConfig(pUART, UART_INTCFG_THRE, DISABLE);
-			// Reset Tx Interrupt state
-			TxIntStat = RESET;
+	if ((Sts & UART_INTSTS_RTR) && (pCtx != NULL)) {	/* ready for Read Data */
+		if (pCtx->rxDmaCh >= 0) {
+			/* Idle line (character time-out), publish the partial half */
+			Chip_UART_RxDmaToRing(pUART, pCtx, false);
 		}
 		else {
-			/* Set Tx Interrupt state */
-			TxIntStat = SET;
-			Chip_UART_IntConfig(pUART, UART_INTCFG_THRE, ENABLE);
+			Chip_UART_RxFifoToRing(pUART, pCtx);
 		}
 	}
 
+	if ((Sts & UART_INTSTS_RTS) && (pCtx != NULL)) {	/* ready for Write Data */
+		Chip_UART_TxRingToFifo(pUART, pCtx);
+		Chip_UART_TxUpdateIntState(pUART, pCtx);
+	}
+
 	if (Sts & UART_INTSTS_ABEO) {
 		Chip_UART_ABClearIntPending(pUART, UART_INTSTS_ABEO);
 	}
 	if (Sts & UART_INTSTS_ABTO) {
 		Chip_UART_ABClearIntPending(pUART, UART_INTSTS_ABTO);
 	}
-	if (ABsyncSts == RESET) {
+	if (ABsyncSts[UARTPort] == RESET) {
 		/* Interrupt caused by End of auto-baud */
 		if (Sts & UART_INTSTS_ABEO) {
 			// Disable AB interrupt
 			Chip_UART_IntConfig(pUART, UART_INTCFG_ABEO, DISABLE);
 			// Set Sync flag
-			ABsyncSts = SET;
+			ABsyncSts[UARTPort] = SET;
 		}
 
 		/* Auto-Baudrate Time-Out interrupt (not implemented) */
@@ -263,30 +474,23 @@ void Chip_UART_Interrupt_Handler(LPC_USART_T *pUART)
 }
 
 /* UART transmit function for interrupt mode (using ring buffers) */
-uint32_t Chip_UART_Interrupt_Transmit(LPC_USART_T *pUART, uint8_t *txbuf, uint8_t buflen)
+uint32_t Chip_UART_Interrupt_Transmit(LPC_USART_T *pUART, const uint8_t *txbuf, uint32_t buflen)
 {
-	uint8_t *data = (uint8_t *) txbuf;
-	uint32_t bytes = 0;
+	UART_RB_CTX_T *pCtx = uartRBCtx[Chip_UART_Get_UARTNum(pUART)];
+	uint32_t bytes;
+
+	if (pCtx == NULL) {
+		return 0;
+	}
 
 	/* Temporarily lock out UART transmit interrupts during this
-	   read so the UART transmit interrupt won't cause problems
-	   with the index values */
+	   write so the UART transmit interrupt won't cause problems
+	   with the Tx interrupt state */
 	Chip_UART_IntConfig(pUART, UART_INTCFG_THRE, DISABLE);
 
-	/* Loop until transmit run buffer is full or until n_bytes
+	/* Copy until transmit ring buffer is full or until buflen
 	   expires */
-	while ((buflen > 0) && (!__BUF_IS_FULL(rb.tx_head, rb.tx_tail))) {
-		/* Write data from buffer into ring buffer */
-		rb.tx[rb.tx_head] = *data;
-		data++;
-
-		/* Increment head pointer */
-		__BUF_INCR(rb.tx_head);
-
-		/* Increment data count and decrement buffer size count */
-		bytes++;
-		buflen--;
-	}
+	bytes = RingBuffer_InsertMult8(&pCtx->txRB, txbuf, buflen);
 
 	/*
 	 * Check if current Tx interrupt enable is reset,
@@ -294,99 +498,289 @@ uint32_t Chip_UART_Interrupt_Transmit(LPC_USART_T *pUART, uint8_t *txbuf, uint8_
 	 * due to call UART_IntTransmit() function to trigger
 	 * this interrupt type
 	 */
-	if (TxIntStat == RESET) {
-		// Disable THRE interrupt
-		Chip_UART_IntConfig(pUART, UART_INTCFG_THRE, DISABLE);
+	if ((pCtx->TxIntStat == RESET) && (pUART->LSR & UART_LSR_THRE)) {
+		Chip_UART_TxRingToFifo(pUART, pCtx);
+	}
+	Chip_UART_TxUpdateIntState(pUART, pCtx);
 
-		/* Wait for FIFO buffer empty, transfer UART_TX_FIFO_SIZE bytes
-		 * of data or break whenever ring buffers are empty */
-		/* Wait until THR empty */
-		while (Chip_UART_CheckBusy(pUART) == SET) {}
+	return bytes;
+}
 
-		while (!__BUF_IS_EMPTY(rb.tx_head, rb.tx_tail)) {
-			/* Move a piece of data into the transmit FIFO */
-			if (Chip_UART_Send(pUART, (uint8_t *) &rb.tx[rb.tx_tail], 1, NONE_BLOCKING)) {
-				/* Update transmit ring FIFO tail pointer */
-				__BUF_INCR(rb.tx_tail);
-			}
-			else {
-				break;
-			}
-		}
+/* UART read function for interrupt mode (using ring buffers) */
+uint32_t Chip_UART_Interrupt_Receive(LPC_USART_T *pUART, uint8_t *rxbuf, uint32_t buflen)
+{
+	UART_RB_CTX_T *pCtx = uartRBCtx[Chip_UART_Get_UARTNum(pUART)];
+	uint32_t head, tail, size, lost, num;
 
-		/* If there is no more data to send, disable the transmit
-		   interrupt - else enable it or keep it enabled */
-		if (__BUF_IS_EMPTY(rb.tx_head, rb.tx_tail)) {
-			Chip_UART_IntConfig(pUART, UART_INTCFG_THRE, DISABLE);
-			/* Reset Tx Interrupt state */
-			TxIntStat = RESET;
+	if (pCtx == NULL) {
+		return 0;
+	}
+
+	/* The receive interrupt only moves the ring buffer head, so no
+	   interrupt lock out is needed here. The GPDMA keeps writing while the
+	   data is copied though: at most one ring is read, and whatever it
+	   overwrote before or during the copy is dropped, oldest first. */
+	size = (uint32_t) pCtx->rxRB.count;
+	if (buflen > size) {
+		buflen = size;
+	}
+	head = pCtx->rxRB.head;
+	if ((head - pCtx->rxRB.tail) > size) {
+		pCtx->rxRB.tail = head - size;
+	}
+	tail = pCtx->rxRB.tail;
+	num = (uint32_t) RingBuffer_PopMult8(&pCtx->rxRB, rxbuf, (int) buflen);
+
+	/* Everything the GPDMA has been past again by now may be stale */
+	head = pCtx->rxRB.head;
+	if ((head - tail) > size) {
+		lost = head - size - tail;
+		if (lost > num) {
+			lost = num;
 		}
-		else {
-			/* Set Tx Interrupt state */
-			TxIntStat = SET;
-			Chip_UART_IntConfig(pUART, UART_INTCFG_THRE, ENABLE);
+		num -= lost;
+		memmove(rxbuf, rxbuf + lost, num);
+		if ((head - pCtx->rxRB.tail) > size) {
+			pCtx->rxRB.tail = head - size;
 		}
 	}
-	/*
-	 * Otherwise, re-enables Tx Interrupt
-	 */
-	else {
-		Chip_UART_IntConfig(pUART, UART_INTCFG_THRE, ENABLE);
+
+	return num;
+}
+
+/* Attach Tx and Rx ring buffers to a UART port */
+Status Chip_UART_InitRingBuffer(LPC_USART_T *pUART, UART_RB_CTX_T *pCtx,
+								uint8_t *txBuf, int txSize, uint8_t *rxBuf, int rxSize)
+{
+	IP_UART_ID_T UARTPort = Chip_UART_Get_UARTNum(pUART);
+
+	if ((RingBuffer_Init(&pCtx->txRB, txBuf, 1, txSize) == ERROR) ||
+		(RingBuffer_Init(&pCtx->rxRB, rxBuf, 1, rxSize) == ERROR)) {
+		return ERROR;
 	}
+	pCtx->TxIntStat = RESET;
+	pCtx->rxDmaCh = -1;
+	pCtx->rxDmaCallback = NULL;
+	pCtx->txDmaCh = -1;
+	pCtx->txDmaActive = pCtx->txDmaPend = pCtx->txDmaPendTail = NULL;
 
-	return bytes;
+	uartRBCtx[UARTPort] = pCtx;
+	ABsyncSts[UARTPort] = RESET;
+
+	return SUCCESS;
 }
 
-/* UART read function for interrupt mode (using ring buffers) */
-uint32_t Chip_UART_Interrupt_Receive(LPC_USART_T *pUART, uint8_t *rxbuf, uint8_t buflen)
+/* Receive into the ring buffer of a UART port with the GPDMA */
+Status Chip_UART_DMA_RxStart(LPC_USART_T *pUART, uint8_t ChannelNum, UART_DMA_RX_FUNC_T rxCallback)
+{
+	IP_UART_ID_T UARTPort = Chip_UART_Get_UARTNum(pUART);
+	UART_RB_CTX_T *pCtx = uartRBCtx[UARTPort];
+	uint32_t half;
+	int i;
+
+	if ((pCtx == NULL) || (pCtx->rxDmaCh >= 0)) {
+		return ERROR;
+	}
+	half = pCtx->rxRB.count / 2;
+	if ((half == 0) || (half > UART_DMA_MAX_XFER)) {
+		return ERROR;
+	}
+
+	/* Each half raises a terminal count interrupt and then hands over to
+	   the other one, so the list never ends */
+	for (i = 0; i < 2; i++) {
+		if (Chip_DMA_PrepareDescriptor(LPC_GPDMA, &pCtx->rxDmaDesc[i], uartRxDmaConn[UARTPort],
+									   (uint32_t) (uintptr_t) pCtx->rxRB.data + (i * half), half,
+									   GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA,
+									   &pCtx->rxDmaDesc[i ^ 1]) == ERROR) {
+			return ERROR;
+		}
+		pCtx->rxDmaDesc[i].ctrl |= GPDMA_DMACCxControl_I;
+	}
+
+	/* The GPDMA always starts at the beginning of the ring */
+	pCtx->rxRB.head = pCtx->rxRB.tail = 0;
+	pCtx->rxDmaBound = 0;
+	pCtx->rxDmaOverrun = 0;
+	pCtx->rxDmaCallback = rxCallback;
+	pCtx->rxDmaCh = (int8_t) ChannelNum;
+	Chip_DMA_SetCallback(LPC_GPDMA, ChannelNum, Chip_UART_RxDmaEvent, pUART);
+
+	if (Chip_DMA_SGTransferConn(LPC_GPDMA, ChannelNum, &pCtx->rxDmaDesc[0],
+								uartRxDmaConn[UARTPort], GPDMA_CONN_MEMORY,
+								GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA) == ERROR) {
+		Chip_DMA_SetCallback(LPC_GPDMA, ChannelNum, NULL, NULL);
+		pCtx->rxDmaCh = -1;
+		return ERROR;
+	}
+
+	return SUCCESS;
+}
+
+/* Stop receiving with the GPDMA */
+void Chip_UART_DMA_RxStop(LPC_USART_T *pUART)
 {
-	uint8_t *data = (uint8_t *) rxbuf;
-	uint32_t bytes = 0;
+	UART_RB_CTX_T *pCtx = uartRBCtx[Chip_UART_Get_UARTNum(pUART)];
+	uint8_t ch;
+	uint32_t num, primask;
 
-	/* Temporarily lock out UART receive interrupts during this
-	   read so the UART receive interrupt won't cause problems
-	   with the index values */
-	Chip_UART_IntConfig(pUART, UART_INTCFG_RBR, DISABLE);
+	if ((pCtx == NULL) || (pCtx->rxDmaCh < 0)) {
+		return;
+	}
 
-	/* Loop until receive buffer ring is empty or
-	    until max_bytes expires */
-	while ((buflen > 0) && (!(__BUF_IS_EMPTY(rb.rx_head, rb.rx_tail)))) {
-		/* Read data from ring buffer into user buffer */
-		*data = rb.rx[rb.rx_tail];
-		data++;
+	/* The channel is free once stopped, finish with it before anyone
+	   else can take it */
+	primask = __get_PRIMASK();
+	__disable_irq();
+	ch = (uint8_t) pCtx->rxDmaCh;
+	Chip_GPDMA_ChannelCmd(LPC_GPDMA, ch, DISABLE);
+	num = Chip_UART_RxDmaPublish(pCtx, false);
+	pCtx->rxDmaCh = -1;
+	Chip_DMA_SetCallback(LPC_GPDMA, ch, NULL, NULL);
+	Chip_DMA_Stop(LPC_GPDMA, ch);
+	__set_PRIMASK(primask);
+
+	if ((num != 0) && (pCtx->rxDmaCallback != NULL)) {
+		pCtx->rxDmaCallback(pUART, num);
+	}
+}
 
-		/* Update tail pointer */
-		__BUF_INCR(rb.rx_tail);
+/* Publish the data the GPDMA has written so far to the receive ring */
+uint32_t Chip_UART_DMA_RxSync(LPC_USART_T *pUART)
+{
+	UART_RB_CTX_T *pCtx = uartRBCtx[Chip_UART_Get_UARTNum(pUART)];
 
-		/* Increment data count and decrement buffer size count */
-		bytes++;
-		buflen--;
+	if ((pCtx == NULL) || (pCtx->rxDmaCh < 0)) {
+		return 0;
 	}
+	return Chip_UART_RxDmaToRing(pUART, pCtx, false);
+}
 
-	/* Re-enable UART interrupts */
-	Chip_UART_IntConfig(pUART, UART_INTCFG_RBR, ENABLE);
+/* GPDMA interrupt service for the receive channel of a UART port */
+void Chip_UART_DMA_RxInterrupt(LPC_USART_T *pUART)
+{
+	UART_RB_CTX_T *pCtx = uartRBCtx[Chip_UART_Get_UARTNum(pUART)];
 
-	return bytes;
+	if ((pCtx == NULL) || (pCtx->rxDmaCh < 0)) {
+		return;
+	}
+	Chip_UART_DMA_AckChannel((uint8_t) pCtx->rxDmaCh, Chip_UART_RxDmaEvent, pUART);
+}
+
+/* Assign a GPDMA channel to Chip_UART_SendDMA() on a UART port */
+Status Chip_UART_DMA_TxInit(LPC_USART_T *pUART, uint8_t ChannelNum)
+{
+	UART_RB_CTX_T *pCtx = uartRBCtx[Chip_UART_Get_UARTNum(pUART)];
+
+	if (pCtx == NULL) {
+		return ERROR;
+	}
+
+	pCtx->txDmaActive = pCtx->txDmaPend = pCtx->txDmaPendTail = NULL;
+	pCtx->txDmaCh = (int8_t) ChannelNum;
+	Chip_DMA_SetCallback(LPC_GPDMA, ChannelNum, Chip_UART_TxDmaEvent, pUART);
+	return SUCCESS;
+}
+
+/* Queue buffers for transmission with the GPDMA */
+Status Chip_UART_SendDMA(LPC_USART_T *pUART, UART_DMA_TX_REQ_T *pReq)
+{
+	IP_UART_ID_T UARTPort = Chip_UART_Get_UARTNum(pUART);
+	UART_RB_CTX_T *pCtx = uartRBCtx[UARTPort];
+	UART_DMA_TX_REQ_T *pLast = NULL, *p;
+	uint32_t i, size, primask;
+
+	if ((pCtx == NULL) || (pCtx->txDmaCh < 0) || (pReq == NULL)) {
+		return ERROR;
+	}
+
+	/* Build the descriptors of each buffer outside the lock, the last one
+	   of a request keeps its terminal count interrupt */
+	for (p = pReq; p != NULL; p = p->next) {
+		if ((p->len == 0) || (p->len > UART_DMA_TX_MAXLEN)) {
+			return ERROR;
+		}
+
+		p->numDesc = (p->len + UART_DMA_MAX_XFER - 1) / UART_DMA_MAX_XFER;
+		for (i = 0; i < p->numDesc; i++) {
+			size = p->len - (i * UART_DMA_MAX_XFER);
+			if (size > UART_DMA_MAX_XFER) {
+				size = UART_DMA_MAX_XFER;
+			}
+			Chip_DMA_PrepareDescriptor(LPC_GPDMA, &p->desc[i],
+									   (uint32_t) (uintptr_t) p->data + (i * UART_DMA_MAX_XFER), uartTxDmaConn[UARTPort],
+									   size, GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA,
+									   (i + 1 < p->numDesc) ? &p->desc[i + 1] : NULL);
+		}
+		pLast = p;
+	}
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (pCtx->txDmaPendTail != NULL) {
+		pCtx->txDmaPendTail->next = pReq;
+	}
+	else {
+		pCtx->txDmaPend = pReq;
+	}
+	pCtx->txDmaPendTail = pLast;
+
+	/* A running chain is never extended, the interrupt starts the
+	   waiting requests when it ends */
+	if (pCtx->txDmaActive == NULL) {
+		Chip_UART_TxDmaStart(pUART, pCtx);
+	}
+
+	__set_PRIMASK(primask);
+	return SUCCESS;
 }
 
-/* Reset Tx and Rx ring buffer (head and tail) */
-void Chip_UART_InitRingBuffer(LPC_USART_T *pUART)
+/* Abort GPDMA transmission */
+void Chip_UART_DMA_TxStop(LPC_USART_T *pUART)
 {
-	(void) pUART;
+	UART_RB_CTX_T *pCtx = uartRBCtx[Chip_UART_Get_UARTNum(pUART)];
+	UART_DMA_TX_REQ_T *pReq;
+	uint32_t primask;
+
+	if ((pCtx == NULL) || (pCtx->txDmaCh < 0)) {
+		return;
+	}
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	/* Retire against the halted channel before it is freed */
+	Chip_GPDMA_ChannelCmd(LPC_GPDMA, (uint8_t) pCtx->txDmaCh, DISABLE);
+	Chip_DMA_SetCallback(LPC_GPDMA, (uint8_t) pCtx->txDmaCh, NULL, NULL);
+	Chip_UART_TxDmaRetire(pUART, pCtx, ERROR);
+	Chip_DMA_Stop(LPC_GPDMA, (uint8_t) pCtx->txDmaCh);
+	while ((pReq = pCtx->txDmaPend) != NULL) {
+		pCtx->txDmaPend = pReq->next;
+		pReq->next = NULL;
+		if (pReq->callback != NULL) {
+			pReq->callback(pUART, pReq, ERROR);
+		}
+	}
+	pCtx->txDmaPendTail = NULL;
+	pCtx->txDmaCh = -1;
+
+	__set_PRIMASK(primask);
+}
 
-	TxIntStat = RESET;
+/* GPDMA interrupt service for the transmit channel of a UART port */
+void Chip_UART_DMA_TxInterrupt(LPC_USART_T *pUART)
+{
+	UART_RB_CTX_T *pCtx = uartRBCtx[Chip_UART_Get_UARTNum(pUART)];
 
-	/* Reset ring buf head and tail idx */
-	__BUF_RESET(rb.rx_head);
-	__BUF_RESET(rb.rx_tail);
-	__BUF_RESET(rb.tx_head);
-	__BUF_RESET(rb.tx_tail);
+	if ((pCtx == NULL) || (pCtx->txDmaCh < 0)) {
+		return;
+	}
+	Chip_UART_DMA_AckChannel((uint8_t) pCtx->txDmaCh, Chip_UART_TxDmaEvent, pUART);
 }
 
 /* UART interrupt service routine */
 FlagStatus Chip_UART_GetABEOStatus(LPC_USART_T *pUART)
 {
-	(void) pUART;
-
-	return ABsyncSts;
+	return ABsyncSts[Chip_UART_Get_UARTNum(pUART)];
 }
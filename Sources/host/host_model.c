@@ -0,0 +1,339 @@
+/*
+ * @brief Host build behaviour model of the GPDMA and SSP
+ *
+ * @note
+ * Only compiled by the 'host' Makefile target. Host_PeriphRegs on its own
+ * is plain memory: nothing moves unless the harness writes it. Host_Tick()
+ * advances a small model of the hardware behind the register image by a
+ * number of core clocks:
+ *
+ * - GPDMA channels with their E bit set move one item every
+ *   HOST_DMA_ITEM_CYCLES clocks, lowest numbered channel first, follow
+ *   their linked lists, raise terminal count status as programmed and
+ *   mirror themselves into ENBLDCHNS.
+ * - Both SSPs shift the frames the GPDMA put into their 8 entry transmit
+ *   FIFO at CPSR * (SCR + 1) clocks per bit and, when enabled and in loop
+ *   back mode, receive them again (all ones otherwise). SR follows the FIFO
+ *   levels, an overflowing receive FIFO sets ROR in RIS.
+ * - With DMA_IRQn enabled in the NVIC and PRIMASK clear, pending GPDMA
+ *   status is handed to Chip_GPDMA_Interrupt_Handler().
+ * - DWT->CYCCNT counts the simulated clocks.
+ *
+ * Register writes are not trapped. Writes to INTTCCLEAR and INTERRCLR take
+ * effect at the next model step, the status the interrupt handler was
+ * called with is retired when it returns. ENBLDCHNS follows the channel E
+ * bits at each step. The CPU's own SSP DR reads and writes are not seen;
+ * peripherals other than the SSPs accept every GPDMA write and never
+ * request a read. Blocking driver calls that poll a status register do not
+ * advance the model: drive those from a SIGALRM handler or test them with
+ * a preloaded register image.
+ */
+
+#include "chip.h"
+#include <string.h>
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Clocks the GPDMA spends on one item (AHB read plus write) */
+#define HOST_DMA_ITEM_CYCLES    2
+
+/* SSP FIFO depth */
+#define HOST_SSP_FIFO_DEPTH     8
+
+/* Linked list item as the GPDMA reads it from memory */
+typedef struct {
+	uint32_t src;
+	uint32_t dst;
+	uint32_t lli;
+	uint32_t ctrl;
+} HOST_LLI_T;
+
+/* State behind one SSP register block */
+typedef struct {
+	LPC_SSP_T *pSSP;
+	uint16_t txFifo[HOST_SSP_FIFO_DEPTH];
+	uint16_t rxFifo[HOST_SSP_FIFO_DEPTH];
+	uint8_t txHead, txCount;
+	uint8_t rxHead, rxCount;
+	bool shifting;
+	uint16_t frame;
+	uint32_t remaining;		/* Clocks left of the frame on the wire */
+} HOST_SSP_T;
+
+static HOST_SSP_T hostSSP[2];
+
+/* Clocks left on the item the GPDMA is moving */
+static uint32_t dmaBusy;
+
+static uint64_t hostCycles;
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Read-only registers are written through a plain pointer */
+#define HOST_REG(reg)           (*(volatile uint32_t *) &(reg))
+
+/* SSP whose data register sits at a GPDMA address, if any */
+static HOST_SSP_T *Host_SSPAt(uint32_t addr)
+{
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		if (addr == (uint32_t) (uintptr_t) &hostSSP[i].pSSP->DR) {
+			return &hostSSP[i];
+		}
+	}
+	return NULL;
+}
+
+/* True for addresses inside the peripheral register image */
+static bool Host_IsPeriph(uint32_t addr)
+{
+	return (addr >= (uint32_t) (uintptr_t) Host_PeriphRegs) &&
+		   (addr < (uint32_t) (uintptr_t) Host_PeriphRegs + sizeof(Host_PeriphRegs));
+}
+
+/* Frame width in bits, DSS holds the width minus one */
+static uint32_t Host_SSPBits(HOST_SSP_T *pS)
+{
+	uint32_t bits = (pS->pSSP->CR0 & 0xF) + 1;
+
+	return (bits < 4) ? 8 : bits;
+}
+
+/* Publish FIFO levels in SR */
+static void Host_SSPStatus(HOST_SSP_T *pS)
+{
+	uint32_t sr = 0;
+
+	if (pS->txCount == 0) {
+		sr |= SSP_STAT_TFE;
+	}
+	if (pS->txCount < HOST_SSP_FIFO_DEPTH) {
+		sr |= SSP_STAT_TNF;
+	}
+	if (pS->rxCount != 0) {
+		sr |= SSP_STAT_RNE;
+	}
+	if (pS->rxCount == HOST_SSP_FIFO_DEPTH) {
+		sr |= SSP_STAT_RFF;
+	}
+	if (pS->shifting || (pS->txCount != 0)) {
+		sr |= SSP_STAT_BSY;
+	}
+	HOST_REG(pS->pSSP->SR) = sr;
+}
+
+/* One clock of an SSP: finish the frame on the wire, start the next one */
+static void Host_SSPClock(HOST_SSP_T *pS)
+{
+	uint32_t prescale;
+
+	if (!(pS->pSSP->CR1 & SSP_CR1_SSP_EN)) {
+		return;
+	}
+
+	if (pS->shifting && (--pS->remaining == 0)) {
+		pS->shifting = false;
+		if (pS->rxCount == HOST_SSP_FIFO_DEPTH) {
+			HOST_REG(pS->pSSP->RIS) |= SSP_RORRIS;
+		}
+		else {
+			pS->rxFifo[(pS->rxHead + pS->rxCount) % HOST_SSP_FIFO_DEPTH] =
+				(pS->pSSP->CR1 & SSP_CR1_LBM_EN) ? pS->frame : (uint16_t) ((1UL << Host_SSPBits(pS)) - 1);
+			pS->rxCount++;
+		}
+	}
+
+	if (!pS->shifting && (pS->txCount != 0)) {
+		pS->frame = pS->txFifo[pS->txHead];
+		pS->txHead = (pS->txHead + 1) % HOST_SSP_FIFO_DEPTH;
+		pS->txCount--;
+		prescale = pS->pSSP->CPSR & 0xFE;
+		pS->remaining = Host_SSPBits(pS) * ((prescale < 2) ? 2 : prescale) *
+						(((pS->pSSP->CR0 >> 8) & 0xFF) + 1);
+		pS->shifting = true;
+	}
+	Host_SSPStatus(pS);
+}
+
+/* Whether a GPDMA channel's next item can move now */
+static bool Host_DMAReady(IP_GPDMA_001_CH_T *pCh)
+{
+	HOST_SSP_T *pS;
+
+	if ((pS = Host_SSPAt(pCh->SRCADDR)) != NULL) {
+		if (!(pS->pSSP->DMACR & SSP_DMA_RX) || (pS->rxCount == 0)) {
+			return false;
+		}
+	}
+	else if (Host_IsPeriph(pCh->SRCADDR)) {
+		return false;
+	}
+
+	if ((pS = Host_SSPAt(pCh->DESTADDR)) != NULL) {
+		return (pS->pSSP->DMACR & SSP_DMA_TX) && (pS->txCount < HOST_SSP_FIFO_DEPTH);
+	}
+	return true;
+}
+
+/* Move one item of a GPDMA channel, then handle its terminal count */
+static void Host_DMAItem(LPC_GPDMA_T *pGPDMA, uint8_t ch)
+{
+	IP_GPDMA_001_CH_T *pCh = &pGPDMA->CH[ch];
+	uint32_t ctrl = pCh->CONTROL, value = 0;
+	uint32_t sw = 1UL << ((ctrl >> 18) & 0x7), dw = 1UL << ((ctrl >> 21) & 0x7);
+	const HOST_LLI_T *pLLI;
+	HOST_SSP_T *pS;
+
+	if ((pS = Host_SSPAt(pCh->SRCADDR)) != NULL) {
+		value = pS->rxFifo[pS->rxHead];
+		pS->rxHead = (pS->rxHead + 1) % HOST_SSP_FIFO_DEPTH;
+		pS->rxCount--;
+		Host_SSPStatus(pS);
+	}
+	else {
+		memcpy(&value, (const void *) (uintptr_t) pCh->SRCADDR, sw);
+	}
+
+	if ((pS = Host_SSPAt(pCh->DESTADDR)) != NULL) {
+		pS->txFifo[(pS->txHead + pS->txCount) % HOST_SSP_FIFO_DEPTH] =
+			(uint16_t) (value & ((1UL << Host_SSPBits(pS)) - 1));
+		pS->txCount++;
+		Host_SSPStatus(pS);
+	}
+	else {
+		memcpy((void *) (uintptr_t) pCh->DESTADDR, &value, dw);
+	}
+
+	if (ctrl & GPDMA_DMACCxControl_SI) {
+		pCh->SRCADDR += sw;
+	}
+	if (ctrl & GPDMA_DMACCxControl_DI) {
+		pCh->DESTADDR += dw;
+	}
+	if ((ctrl & 0xFFF) != 0) {
+		pCh->CONTROL = --ctrl;
+	}
+	if ((ctrl & 0xFFF) != 0) {
+		return;
+	}
+
+	/* Terminal count: raise the interrupt, go on with the next item */
+	if (ctrl & GPDMA_DMACCxControl_I) {
+		HOST_REG(pGPDMA->RAWINTTCSTAT) |= 1UL << ch;
+		if (pCh->CONFIG & GPDMA_DMACCxConfig_ITC) {
+			HOST_REG(pGPDMA->INTTCSTAT) |= 1UL << ch;
+		}
+	}
+	if (pCh->LLI != 0) {
+		pLLI = (const HOST_LLI_T *) (uintptr_t) pCh->LLI;
+		pCh->SRCADDR = pLLI->src;
+		pCh->DESTADDR = pLLI->dst;
+		pCh->LLI = pLLI->lli;
+		pCh->CONTROL = pLLI->ctrl;
+	}
+	else {
+		pCh->CONFIG &= ~GPDMA_DMACCxConfig_E;
+	}
+}
+
+/* One clock of the GPDMA */
+static void Host_DMAClock(LPC_GPDMA_T *pGPDMA)
+{
+	uint32_t enabled = 0;
+	uint8_t ch;
+
+	if (dmaBusy != 0) {
+		dmaBusy--;
+	}
+	else if (pGPDMA->CONFIG & GPDMA_DMACConfig_E) {
+		for (ch = 0; ch < GPDMA_NUMBER_CHANNELS; ch++) {
+			if ((pGPDMA->CH[ch].CONFIG & GPDMA_DMACCxConfig_E) && Host_DMAReady(&pGPDMA->CH[ch])) {
+				Host_DMAItem(pGPDMA, ch);
+				dmaBusy = HOST_DMA_ITEM_CYCLES - 1;
+				break;
+			}
+		}
+	}
+
+	for (ch = 0; ch < GPDMA_NUMBER_CHANNELS; ch++) {
+		if (pGPDMA->CH[ch].CONFIG & GPDMA_DMACCxConfig_E) {
+			enabled |= 1UL << ch;
+		}
+	}
+	HOST_REG(pGPDMA->ENBLDCHNS) = enabled;
+	HOST_REG(pGPDMA->INTSTAT) = pGPDMA->INTTCSTAT | pGPDMA->INTERRSTAT;
+}
+
+/* Apply the status clear registers */
+static void Host_DMAClear(LPC_GPDMA_T *pGPDMA, uint32_t tc, uint32_t err)
+{
+	tc |= pGPDMA->INTTCCLEAR;
+	err |= pGPDMA->INTERRCLR;
+	HOST_REG(pGPDMA->INTTCSTAT) &= ~tc;
+	HOST_REG(pGPDMA->RAWINTTCSTAT) &= ~tc;
+	HOST_REG(pGPDMA->INTERRSTAT) &= ~err;
+	HOST_REG(pGPDMA->RAWINTERRSTAT) &= ~err;
+	pGPDMA->INTTCCLEAR = 0;
+	pGPDMA->INTERRCLR = 0;
+	HOST_REG(pGPDMA->INTSTAT) = pGPDMA->INTTCSTAT | pGPDMA->INTERRSTAT;
+}
+
+/* Take the GPDMA interrupt if it is pending and not masked */
+static void Host_DMAInterrupt(LPC_GPDMA_T *pGPDMA)
+{
+	uint32_t tc = pGPDMA->INTTCSTAT, err = pGPDMA->INTERRSTAT;
+
+	if (((tc | err) == 0) || (Host_PRIMASK != 0) ||
+		!(NVIC->ISER[(uint32_t) DMA_IRQn >> 5] & (1UL << ((uint32_t) DMA_IRQn & 0x1F)))) {
+		return;
+	}
+
+	Chip_GPDMA_Interrupt_Handler(pGPDMA);
+
+	/* The handler consumes all the status it was entered with; nothing
+	   raises new status while it runs */
+	Host_DMAClear(pGPDMA, tc, err);
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Return the model to its reset state */
+void Host_ResetModel(void)
+{
+	memset(hostSSP, 0, sizeof(hostSSP));
+	hostSSP[0].pSSP = LPC_SSP0;
+	hostSSP[1].pSSP = LPC_SSP1;
+	dmaBusy = 0;
+	hostCycles = 0;
+}
+
+/* Advance the GPDMA and SSP model */
+void Host_Tick(uint32_t cycles)
+{
+	while (cycles-- > 0) {
+		Host_DMAClear(LPC_GPDMA, 0, 0);
+		Host_SSPClock(&hostSSP[0]);
+		Host_SSPClock(&hostSSP[1]);
+		Host_DMAClock(LPC_GPDMA);
+		Host_DMAInterrupt(LPC_GPDMA);
+		DWT->CYCCNT++;
+		hostCycles++;
+	}
+}
+
+/* Clocks simulated since the last reset */
+uint64_t Host_Cycles(void)
+{
+	return hostCycles;
+}
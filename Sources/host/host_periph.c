@@ -0,0 +1,53 @@
+/*
+ * @brief Host build peripheral register image
+ *
+ * @note
+ * Only compiled by the 'host' Makefile target. Every LPC_* peripheral
+ * pointer in chip.h resolves into Host_PeriphRegs when HOST_BUILD is
+ * defined, so drivers program plain memory instead of the APB/AHB
+ * peripherals. A harness can preload status registers (SSP SR, UART LSR,
+ * GPDMA INTSTAT, ...) before calling a driver and inspect the registers
+ * written by it afterwards. The Cortex-M4 core peripherals get their own
+ * image, see cmsis_host.h.
+ *
+ * Address registers of the DMA engines are 32 bits wide. The host library
+ * is built without PIE so its static data sits below 4 GB; buffers given
+ * to DMA drivers on the host must be static as well.
+ */
+
+#include "chip.h"
+#include <string.h>
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/* RAM image of the 0x40000000 peripheral window */
+uint32_t Host_PeriphRegs[LPC_PERIPH_WINDOW_SIZE / sizeof(uint32_t)];
+
+/* RAM image of the Cortex-M4 private peripheral bus */
+uint32_t Host_CoreRegs[HOST_CORE_WINDOW_SIZE / sizeof(uint32_t)];
+
+/* Simulated PRIMASK used by __disable_irq()/__enable_irq() */
+volatile uint32_t Host_PRIMASK;
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Return all simulated peripheral registers to zero, and the model behind them */
+void Host_ResetPeriphRegs(void)
+{
+	memset(Host_PeriphRegs, 0, sizeof(Host_PeriphRegs));
+	memset(Host_CoreRegs, 0, sizeof(Host_CoreRegs));
+	Host_PRIMASK = 0;
+	Host_ResetModel();
+}
@@ -110,7 +110,7 @@ void IP_EMC_Dynamic_Init(IP_EMC_001_T *pEMC, IP_EMC_DYN_CONFIG_T *Dynamic_Config
 	int i;
 
 	for (ChipSelect = 0; ChipSelect < 4; ChipSelect++) {
-		IP_EMC_001_T *EMC_Reg_add = (IP_EMC_001_T *) ((uint32_t) pEMC + (ChipSelect << 5));
+		IP_EMC_001_T *EMC_Reg_add = (IP_EMC_001_T *) ((uintptr_t) pEMC + (ChipSelect << 5));
 
 		EMC_Reg_add->DYNAMICRASCAS0    = Dynamic_Config->DevConfig[ChipSelect].RAS |
 										 ((Dynamic_Config->DevConfig[ChipSelect].ModeRegister <<
@@ -175,7 +175,7 @@ void IP_EMC_Dynamic_Init(IP_EMC_001_T *pEMC, IP_EMC_DYN_CONFIG_T *Dynamic_Config
 			uint32_t temp;
 			uint32_t ModeRegister;
 			ModeRegister = Dynamic_Config->DevConfig[ChipSelect].ModeRegister;
-			temp = *((volatile uint32_t *) (DynAddr | (ModeRegister << Col_len)));
+			temp = *((volatile uint32_t *) (uintptr_t) (DynAddr | (ModeRegister << Col_len)));
 			temp = temp;
 		}
 	}
@@ -215,7 +215,7 @@ void IP_EMC_Dynamic_Enable(IP_EMC_001_T *pEMC, uint8_t Enable)
  */
 void IP_EMC_Static_Init(IP_EMC_001_T *pEMC, IP_EMC_STATIC_CONFIG_T *Static_Config, uint32_t EMC_Clock)
 {
-	IP_EMC_001_T *EMC_Reg_add = (IP_EMC_001_T *) ((uint32_t) pEMC + ((Static_Config->ChipSelect) << 5));
+	IP_EMC_001_T *EMC_Reg_add = (IP_EMC_001_T *) ((uintptr_t) pEMC + ((Static_Config->ChipSelect) << 5));
 	EMC_Reg_add->STATICCONFIG0      = Static_Config->Config;
 	EMC_Reg_add->STATICWAITWEN0     = EMC_TimingParamConvert(EMC_Clock, Static_Config->WaitWen, 1);
 	EMC_Reg_add->STATICWAITOEN0     = EMC_TimingParamConvert(EMC_Clock, Static_Config->WaitOen, 0);
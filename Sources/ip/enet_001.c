@@ -173,6 +173,6 @@ void IP_ENET_InitDescriptors(IP_ENET_001_T *pENET,
 							 IP_ENET_001_ENHTXDESC_T *pTXDescs, IP_ENET_001_ENHRXDESC_T *pRXDescs)
 {
 	/* Setup descriptor list base addresses */
-	pENET->DMA_TRANS_DES_ADDR = (uint32_t) pTXDescs;
-	pENET->DMA_REC_DES_ADDR = (uint32_t) pRXDescs;
+	pENET->DMA_TRANS_DES_ADDR = (uint32_t) (uintptr_t) pTXDescs;
+	pENET->DMA_REC_DES_ADDR = (uint32_t) (uintptr_t) pRXDescs;
 }
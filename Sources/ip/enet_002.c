@@ -167,9 +167,9 @@ void IP_ENET_InitTxDescriptors(IP_ENET_002_T *pENET,
 							   uint32_t descNum)
 {
 	/* Setup descriptor list base addresses */
-	pENET->CONTROL.TX.DESCRIPTOR = (uint32_t) pDescs;
+	pENET->CONTROL.TX.DESCRIPTOR = (uint32_t) (uintptr_t) pDescs;
 	pENET->CONTROL.TX.DESCRIPTORNUMBER = descNum - 1;
-	pENET->CONTROL.TX.STATUS = (uint32_t) pStatus;
+	pENET->CONTROL.TX.STATUS = (uint32_t) (uintptr_t) pStatus;
 	pENET->CONTROL.TX.PRODUCEINDEX = 0;
 }
 
@@ -180,9 +180,9 @@ void IP_ENET_InitRxDescriptors(IP_ENET_002_T *pENET,
 							   uint32_t descNum)
 {
 	/* Setup descriptor list base addresses */
-	pENET->CONTROL.RX.DESCRIPTOR = (uint32_t) pDescs;
+	pENET->CONTROL.RX.DESCRIPTOR = (uint32_t) (uintptr_t) pDescs;
 	pENET->CONTROL.RX.DESCRIPTORNUMBER = descNum - 1;
-	pENET->CONTROL.RX.STATUS = (uint32_t) pStatus;
+	pENET->CONTROL.RX.STATUS = (uint32_t) (uintptr_t) pStatus;
 	pENET->CONTROL.RX.CONSUMEINDEX = 0;
 }
 
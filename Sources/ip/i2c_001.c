@@ -473,6 +473,15 @@ void IP_I2C_SetClockRate(IP_I2C_001_T *pI2C, uint32_t SCLValue)
 	pI2C->SCLL = (uint32_t) (SCLValue - pI2C->SCLH);
 }
 
+/* Reset the controller state machine, keeping the slave acknowledge setting */
+void IP_I2C_Reset(IP_I2C_001_T *pI2C)
+{
+	uint32_t aa = pI2C->CONSET & I2C_I2CONSET_AA;
+
+	pI2C->CONCLR = I2C_I2CONCLR_I2ENC | I2C_I2CONCLR_STAC | I2C_I2CONCLR_SIC | I2C_I2CONCLR_AAC;
+	pI2C->CONSET = I2C_I2CONSET_I2EN | aa;
+}
+
 /* General Master Interrupt handler for I2C peripheral */
 void IP_I2C_Interrupt_MasterHandler(IP_I2C_001_T *pI2C, IP_I2C_ID_T I2C_Num)
 {
@@ -567,6 +576,7 @@ Status IP_I2C_MasterTransferData(IP_I2C_001_T *pI2C,
 								 IP_I2C_TRANSFER_OPT_T Opt)
 {
 	uint32_t CodeStatus;
+	uint32_t cnt;
 	int32_t Ret = I2C_OK;
 
 	/* Reset I2C setup value to default state */
@@ -601,7 +611,16 @@ retry:
 			else if ( (Ret & I2C_BYTE_SENT) ||
 					  (Ret & I2C_BYTE_RECV)) {
 				/* Wait for sending ends/ Wait for next byte */
-				while (!(pI2C->CONSET & I2C_I2CONSET_SI)) {}
+				cnt = 0;
+				while (!(pI2C->CONSET & I2C_I2CONSET_SI)) {
+					if (++cnt > BLOCKING_TIMEOUT) {
+						/* Slave holding SCL low, give the bus up. A STOP cannot
+						   go out on a held bus, so the controller is reset. */
+						IP_I2C_Reset(pI2C);
+						TransferCfg->status = CodeStatus | I2C_SETUP_STATUS_TIMEOUT;
+						goto error;
+					}
+				}
 			}
 			else if (Ret & I2C_SEND_END) {	/* already send all data */
 				/* If no need to wait for data from Slave */
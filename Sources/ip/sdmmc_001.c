@@ -241,6 +241,7 @@ void IP_SDMMC_DmaSetup(IP_SDMMC_001_T *pSDMMC, sdif_device *psdif_dev, uint32_t
 {
 	int i = 0;
 	uint32_t ctrl, maxs;
+	pSDMMC_DMA_T *dd = (psdif_dev->dma_pool != NULL) ? psdif_dev->dma_pool : psdif_dev->mci_dma_dd;
 
 	/* Reset DMA */
 	pSDMMC->CTRL |= MCI_CTRL_DMA_RESET | MCI_CTRL_FIFO_RESET;
@@ -256,10 +257,10 @@ void IP_SDMMC_DmaSetup(IP_SDMMC_001_T *pSDMMC, sdif_device *psdif_dev, uint32_t
 		size -= maxs;
 
 		/* Set buffer size */
-		psdif_dev->mci_dma_dd[i].des1 = MCI_DMADES1_BS1(maxs);
+		dd[i].des1 = MCI_DMADES1_BS1(maxs);
 
 		/* Setup buffer address (chained) */
-		psdif_dev->mci_dma_dd[i].des2 = addr + (i * MCI_DMADES1_MAXTR);
+		dd[i].des2 = addr + (i * MCI_DMADES1_MAXTR);
 
 		/* Setup basic control */
 		ctrl = MCI_DMADES0_OWN | MCI_DMADES0_CH;
@@ -276,14 +277,25 @@ void IP_SDMMC_DmaSetup(IP_SDMMC_001_T *pSDMMC, sdif_device *psdif_dev, uint32_t
 		}
 
 		/* Another descriptor is needed */
-		psdif_dev->mci_dma_dd[i].des3 = (uint32_t) &psdif_dev->mci_dma_dd[i + 1];
-		psdif_dev->mci_dma_dd[i].des0 = ctrl;
+		dd[i].des3 = (uint32_t) (uintptr_t) &dd[i + 1];
+		dd[i].des0 = ctrl;
 
 		i++;
 	}
 
 	/* Set DMA derscriptor base address */
-	pSDMMC->DBADDR = (uint32_t) &psdif_dev->mci_dma_dd[0];
+	pSDMMC->DBADDR = (uint32_t) (uintptr_t) &dd[0];
+}
+
+/* Largest transfer the DMA descriptors of a device can describe */
+uint32_t IP_SDMMC_DmaMaxSize(sdif_device *psdif_dev)
+{
+	if (psdif_dev->dma_pool != NULL) {
+		return psdif_dev->dma_pool_num * MCI_DMADES1_MAXTR;
+	}
+
+	/* The extra built-in descriptor is never used */
+	return (MCI_DMADES_NUM - 1) * MCI_DMADES1_MAXTR;
 }
 
 /**
@@ -56,7 +56,7 @@ bool mem_test_walking0(MEM_TEST_SETUP_T *pMemSetup)
 	uint32_t fbytes = pMemSetup->bytes, *addr = pMemSetup->start_addr;
 
 	/* Must be 32-bit algined */
-	if ((((uint32_t) addr & 0x3) != 0) || ((fbytes & 0x3) != 0)) {
+	if ((((uintptr_t) addr & 0x3) != 0) || ((fbytes & 0x3) != 0)) {
 		return false;
 	}
 
@@ -102,7 +102,7 @@ bool mem_test_walking1(MEM_TEST_SETUP_T *pMemSetup)
 	uint32_t fbytes = pMemSetup->bytes, *addr = pMemSetup->start_addr;
 
 	/* Must be 32-bit algined */
-	if ((((uint32_t) addr & 0x3) != 0) || ((fbytes & 0x3) != 0)) {
+	if ((((uintptr_t) addr & 0x3) != 0) || ((fbytes & 0x3) != 0)) {
 		return false;
 	}
 
@@ -147,13 +147,13 @@ bool mem_test_address(MEM_TEST_SETUP_T *pMemSetup)
 	uint32_t fbytes = pMemSetup->bytes, *addr = pMemSetup->start_addr;
 
 	/* Must be 32-bit algined */
-	if ((((uint32_t) addr & 0x3) != 0) || ((fbytes & 0x3) != 0)) {
+	if ((((uintptr_t) addr & 0x3) != 0) || ((fbytes & 0x3) != 0)) {
 		return false;
 	}
 
 	/* Write address for memory location */
 	while (fbytes > 0) {
-		*addr =  (uint32_t) addr;
+		*addr =  (uint32_t) (uintptr_t) addr;
 
 		addr++;
 		fbytes -= 4;
@@ -163,10 +163,10 @@ bool mem_test_address(MEM_TEST_SETUP_T *pMemSetup)
 	fbytes = pMemSetup->bytes;
 	addr = pMemSetup->start_addr;
 	while (fbytes > 0) {
-		if (*addr != (uint32_t) addr) {
+		if (*addr != (uint32_t) (uintptr_t) addr) {
 			pMemSetup->fail_addr = addr;
 			pMemSetup->is_val = *addr;
-			pMemSetup->ex_val = (uint32_t) addr;
+			pMemSetup->ex_val = (uint32_t) (uintptr_t) addr;
 			return false;
 		}
 
@@ -183,13 +183,13 @@ bool mem_test_invaddress(MEM_TEST_SETUP_T *pMemSetup)
 	uint32_t fbytes = pMemSetup->bytes, *addr = pMemSetup->start_addr;
 
 	/* Must be 32-bit algined */
-	if ((((uint32_t) addr & 0x3) != 0) || ((fbytes & 0x3) != 0)) {
+	if ((((uintptr_t) addr & 0x3) != 0) || ((fbytes & 0x3) != 0)) {
 		return false;
 	}
 
 	/* Write inverse address for memory location */
 	while (fbytes > 0) {
-		*addr =  ~(uint32_t) addr;
+		*addr =  ~(uint32_t) (uintptr_t) addr;
 
 		addr++;
 		fbytes -= 4;
@@ -199,10 +199,10 @@ bool mem_test_invaddress(MEM_TEST_SETUP_T *pMemSetup)
 	fbytes = pMemSetup->bytes;
 	addr = pMemSetup->start_addr;
 	while (fbytes > 0) {
-		if (*addr != ~(uint32_t) addr) {
+		if (*addr != ~(uint32_t) (uintptr_t) addr) {
 			pMemSetup->fail_addr = addr;
 			pMemSetup->is_val = *addr;
-			pMemSetup->ex_val = ~(uint32_t) addr;
+			pMemSetup->ex_val = ~(uint32_t) (uintptr_t) addr;
 			return false;
 		}
 
@@ -220,7 +220,7 @@ bool mem_test_pattern(MEM_TEST_SETUP_T *pMemSetup)
 	uint32_t pattern = 0x55AA55AA;
 
 	/* Must be 32-bit algined */
-	if ((((uint32_t) addr & 0x3) != 0) || ((fbytes & 0x3) != 0)) {
+	if ((((uintptr_t) addr & 0x3) != 0) || ((fbytes & 0x3) != 0)) {
 		return false;
 	}
 
@@ -260,7 +260,7 @@ bool mem_test_pattern_seed(MEM_TEST_SETUP_T *pMemSetup, uint32_t seed, uint32_t
 	uint32_t pattern = seed;
 
 	/* Must be 32-bit algined */
-	if ((((uint32_t) addr & 0x3) != 0) || ((fbytes & 0x3) != 0)) {
+	if ((((uintptr_t) addr & 0x3) != 0) || ((fbytes & 0x3) != 0)) {
 		return false;
 	}
 
@@ -30,6 +30,7 @@
  */
 
 #include "ring_buffer.h"
+#include "word_copy.h"
 
 /*****************************************************************************
  * Private types/enumerations/variables
@@ -43,85 +44,174 @@
  * Private functions
  ****************************************************************************/
 
+/* Insert up to num items of itemSize bytes as at most two block copies */
+static int RingBuffer_InsertBlock(RINGBUFF_T *RingBuff, const void *data, int num, int itemSize)
+{
+	const uint8_t *src = data;
+	int idx, cnt1;
+
+	cnt1 = RingBuffer_GetFree(RingBuff);
+	if (num > cnt1) {
+		if (RingBuff->mode == RINGBUFF_MODE_OVERWRITE) {
+			/* Only the newest count items can survive */
+			if (num > RingBuff->count) {
+				src += (num - RingBuff->count) * itemSize;
+				num = RingBuff->count;
+			}
+
+			/* Drop the oldest items to make room */
+			RingBuff->tail += num - cnt1;
+		}
+		else {
+			/* Only insert what fits */
+			num = cnt1;
+		}
+	}
+	if (num <= 0) {
+		return 0;
+	}
+
+	/* Segment up to the end of the buffer, then the wrapped remainder */
+	idx = RB_INDH(RingBuff);
+	cnt1 = RingBuff->count - idx;
+	if (cnt1 > num) {
+		cnt1 = num;
+	}
+	WordCopy(RingBuff->data + (idx * itemSize), src, cnt1 * itemSize);
+	if (num > cnt1) {
+		WordCopy(RingBuff->data, src + (cnt1 * itemSize), (num - cnt1) * itemSize);
+	}
+
+	__DMB();
+	RingBuff->head += num;
+
+	return num;
+}
+
+/* Pop up to num items of itemSize bytes as at most two block copies */
+static int RingBuffer_PopBlock(RINGBUFF_T *RingBuff, void *data, int num, int itemSize)
+{
+	uint8_t *dst = data;
+	int idx, cnt1;
+
+	/* Copy data up to size in buffer or passed size of buffer,
+	   whichever is smaller */
+	cnt1 = RingBuffer_GetCount(RingBuff);
+	if (num > cnt1) {
+		num = cnt1;
+	}
+	if (num <= 0) {
+		return 0;
+	}
+
+	__DMB();
+	idx = RB_INDT(RingBuff);
+	cnt1 = RingBuff->count - idx;
+	if (cnt1 > num) {
+		cnt1 = num;
+	}
+	WordCopy(dst, RingBuff->data + (idx * itemSize), cnt1 * itemSize);
+	if (num > cnt1) {
+		WordCopy(dst + (cnt1 * itemSize), RingBuff->data, (num - cnt1) * itemSize);
+	}
+
+	__DMB();
+	RingBuff->tail += num;
+
+	return num;
+}
+
 /*****************************************************************************
  * Public functions
  ****************************************************************************/
 
 /* Initialize ring buffer */
-void RingBuffer_Init(RINGBUFF_T *RingBuff, void *buffer, int itemSize, int count)
+Status RingBuffer_Init(RINGBUFF_T *RingBuff, void *buffer, int itemSize, int count)
 {
-	RingBuff->bufferBase = RingBuff->bufferIn = RingBuff->bufferOut = buffer;
-	RingBuff->bufferLast = RingBuff->bufferBase + (itemSize * count);
+	/* Indices are masked with (count - 1) */
+	if ((count <= 0) || ((count & (count - 1)) != 0)) {
+		return ERROR;
+	}
+
+	RingBuff->data = buffer;
 	RingBuff->count = count;
 	RingBuff->itemSize = itemSize;
-	RingBuff->used = 0;
+	RingBuff->head = RingBuff->tail = 0;
+	RingBuff->mode = RINGBUFF_MODE_REJECT;
+
+	return SUCCESS;
 }
 
-/* Return empty status of ring buffer */
-void RingBuffer_Insert8(RINGBUFF_T *RingBuff, uint8_t data8)
+/* Insert a single item of itemSize bytes in ring buffer */
+Status RingBuffer_Insert(RINGBUFF_T *RingBuff, const void *data)
 {
-	*RingBuff->bufferIn = data8;
-	RingBuff->used++;
-	RingBuff->bufferIn++;
-	if (RingBuff->bufferIn >= RingBuff->bufferLast) {
-		RingBuff->bufferIn = RingBuff->bufferBase;
+	if (RingBuffer_IsFull(RingBuff)) {
+		if (RingBuff->mode != RINGBUFF_MODE_OVERWRITE) {
+			return ERROR;
+		}
+
+		/* Drop the oldest item */
+		RingBuff->tail++;
 	}
+
+	WordCopy(RingBuff->data + (RB_INDH(RingBuff) * RingBuff->itemSize), data, RingBuff->itemSize);
+
+	__DMB();
+	RingBuff->head++;
+
+	return SUCCESS;
+}
+
+/* Insert a block of items of itemSize bytes in ring buffer */
+int RingBuffer_InsertMult(RINGBUFF_T *RingBuff, const void *data, int num)
+{
+	return RingBuffer_InsertBlock(RingBuff, data, num, RingBuff->itemSize);
+}
+
+/* Insert a single 8-bit value in ring buffer */
+void RingBuffer_Insert8(RINGBUFF_T *RingBuff, uint8_t data8)
+{
+	RingBuff->data[RB_INDH(RingBuff)] = data8;
+
+	/* Item must be stored before the consumer can see the new head */
+	__DMB();
+	RingBuff->head++;
 }
 
 /* Insert a block of 8-bit values in ring buffer */
-void RingBuffer_InsertMult8(RINGBUFF_T *RingBuff, const uint8_t *block8, int num)
+int RingBuffer_InsertMult8(RINGBUFF_T *RingBuff, const uint8_t *block8, int num)
 {
-	while (num > 0) {
-		RingBuffer_Insert8(RingBuff, *block8);
-		block8++;
-		num--;
-	}
+	return RingBuffer_InsertBlock(RingBuff, block8, num, sizeof(uint8_t));
 }
 
 /* Insert 16-bit value in ring buffer */
 void RingBuffer_Insert16(RINGBUFF_T *RingBuff, uint16_t data16)
 {
-	uint16_t *buff16 = (uint16_t *) RingBuff->bufferIn;
-	*buff16 = data16;
-	RingBuff->used++;
-	buff16++;
-	RingBuff->bufferIn = (uint8_t *) buff16;
-	if (RingBuff->bufferIn >= RingBuff->bufferLast) {
-		RingBuff->bufferIn = RingBuff->bufferBase;
-	}
+	((uint16_t *) RingBuff->data)[RB_INDH(RingBuff)] = data16;
+
+	__DMB();
+	RingBuff->head++;
 }
 
 /* Insert a block of 16-bit values in ring buffer */
-void RingBuffer_InsertMult16(RINGBUFF_T *RingBuff, const uint16_t *block16, int num)
+int RingBuffer_InsertMult16(RINGBUFF_T *RingBuff, const uint16_t *block16, int num)
 {
-	while (num > 0) {
-		RingBuffer_Insert16(RingBuff, *block16);
-		block16++;
-		num--;
-	}
+	return RingBuffer_InsertBlock(RingBuff, block16, num, sizeof(uint16_t));
 }
 
 /* Insert 32-bit value in ring buffer */
 void RingBuffer_Insert32(RINGBUFF_T *RingBuff, uint32_t data32)
 {
-	uint32_t *buff32 = (uint32_t *) RingBuff->bufferIn;
-	*buff32 = data32;
-	RingBuff->used++;
-	buff32++;
-	RingBuff->bufferIn = (uint8_t *) buff32;
-	if (RingBuff->bufferIn >= RingBuff->bufferLast) {
-		RingBuff->bufferIn = RingBuff->bufferBase;
-	}
+	((uint32_t *) RingBuff->data)[RB_INDH(RingBuff)] = data32;
+
+	__DMB();
+	RingBuff->head++;
 }
 
 /* Insert a block of 32-bit values in ring buffer */
-void RingBuffer_InsertMult32(RINGBUFF_T *RingBuff, const uint32_t *block32, int num)
+int RingBuffer_InsertMult32(RINGBUFF_T *RingBuff, const uint32_t *block32, int num)
 {
-	while (num > 0) {
-		RingBuffer_Insert32(RingBuff, *block32);
-		block32++;
-		num--;
-	}
+	return RingBuffer_InsertBlock(RingBuff, block32, num, sizeof(uint32_t));
 }
 
 /* Pop an 8-bit value from the ring buffer */
@@ -129,12 +219,13 @@ uint8_t RingBuffer_Pop8(RINGBUFF_T *RingBuff)
 {
 	uint8_t data;
 
-	data = *RingBuff->bufferOut;
-	RingBuff->used--;
-	RingBuff->bufferOut++;
-	if (RingBuff->bufferOut >= RingBuff->bufferLast) {
-		RingBuff->bufferOut = RingBuff->bufferBase;
-	}
+	/* Head was read by the caller's empty check, item is read after it */
+	__DMB();
+	data = RingBuff->data[RB_INDT(RingBuff)];
+
+	/* Item must be read before the producer can reuse the slot */
+	__DMB();
+	RingBuff->tail++;
 
 	return data;
 }
@@ -142,40 +233,19 @@ uint8_t RingBuffer_Pop8(RINGBUFF_T *RingBuff)
 /* Pop a block of 8-bit values from the ring buffer */
 int RingBuffer_PopMult8(RINGBUFF_T *RingBuff, uint8_t *block8, int num)
 {
-	int popped = 0, count;
-
-	/* Copy data up to size in buffer or passed size of buffer,
-	   whichever is smaller */
-	count = RingBuffer_GetCount(RingBuff);
-	if (count > 0) {
-		if (count > num) {
-			count = num;
-		}
-
-		while (count > 0) {
-			*block8 = RingBuffer_Pop8(RingBuff);
-			count--;
-			popped++;
-		}
-	}
-
-	return popped;
+	return RingBuffer_PopBlock(RingBuff, block8, num, sizeof(uint8_t));
 }
 
 /* Pop a 16-bit value from the ring buffer */
 uint16_t RingBuffer_Pop16(RINGBUFF_T *RingBuff)
 {
-	uint16_t data, *buff16 = (uint16_t *) RingBuff->bufferOut;
+	uint16_t data;
 
-	data = *buff16;
-	RingBuff->used--;
-	buff16++;
-	if ((uint8_t *) buff16 >= RingBuff->bufferLast) {
-		RingBuff->bufferOut = RingBuff->bufferBase;
-	}
-	else {
-		RingBuff->bufferOut = (uint8_t *) buff16;
-	}
+	__DMB();
+	data = ((uint16_t *) RingBuff->data)[RB_INDT(RingBuff)];
+
+	__DMB();
+	RingBuff->tail++;
 
 	return data;
 }
@@ -183,40 +253,19 @@ uint16_t RingBuffer_Pop16(RINGBUFF_T *RingBuff)
 /* Pop a block of 16-bit values from the ring buffer */
 int RingBuffer_PopMult16(RINGBUFF_T *RingBuff, uint16_t *block16, int num)
 {
-	int popped = 0, count;
-
-	/* Copy data up to size in buffer or passed size of buffer,
-	   whichever is smaller */
-	count = RingBuffer_GetCount(RingBuff);
-	if (count > 0) {
-		if (count > num) {
-			count = num;
-		}
-
-		while (count > 0) {
-			*block16 = RingBuffer_Pop16(RingBuff);
-			count--;
-			popped++;
-		}
-	}
-
-	return popped;
+	return RingBuffer_PopBlock(RingBuff, block16, num, sizeof(uint16_t));
 }
 
 /* Pop a 32-bit value from the ring buffer */
 uint32_t RingBuffer_Pop32(RINGBUFF_T *RingBuff)
 {
-	uint32_t data, *buff32 = (uint32_t *) RingBuff->bufferOut;
+	uint32_t data;
 
-	data = *buff32;
-	RingBuff->used--;
-	data++;
-	if ((uint8_t *) data >= RingBuff->bufferLast) {
-		RingBuff->bufferOut = RingBuff->bufferBase;
-	}
-	else {
-		RingBuff->bufferOut = (uint8_t *) data;
-	}
+	__DMB();
+	data = ((uint32_t *) RingBuff->data)[RB_INDT(RingBuff)];
+
+	__DMB();
+	RingBuff->tail++;
 
 	return data;
 }
@@ -224,22 +273,64 @@ uint32_t RingBuffer_Pop32(RINGBUFF_T *RingBuff)
 /* Pop a block of 32-bit values from the ring buffer */
 int RingBuffer_PopMult32(RINGBUFF_T *RingBuff, uint32_t *block32, int num)
 {
-	int popped = 0, count;
+	return RingBuffer_PopBlock(RingBuff, block32, num, sizeof(uint32_t));
+}
 
-	/* Copy data up to size in buffer or passed size of buffer,
-	   whichever is smaller */
-	count = RingBuffer_GetCount(RingBuff);
-	if (count > 0) {
-		if (count > num) {
-			count = num;
-		}
+/* Pop a single item of itemSize bytes from the ring buffer */
+Status RingBuffer_Pop(RINGBUFF_T *RingBuff, void *data)
+{
+	if (RingBuffer_IsEmpty(RingBuff)) {
+		return ERROR;
+	}
 
-		while (count > 0) {
-			*block32 = RingBuffer_Pop32(RingBuff);
-			count--;
-			popped++;
-		}
+	__DMB();
+	WordCopy(data, RingBuff->data + (RB_INDT(RingBuff) * RingBuff->itemSize), RingBuff->itemSize);
+
+	__DMB();
+	RingBuff->tail++;
+
+	return SUCCESS;
+}
+
+/* Pop a block of items of itemSize bytes from the ring buffer */
+int RingBuffer_PopMult(RINGBUFF_T *RingBuff, void *data, int num)
+{
+	return RingBuffer_PopBlock(RingBuff, data, num, RingBuff->itemSize);
+}
+
+/* Get the contiguous free region at the head of the ring buffer */
+int RingBuffer_GetWriteSpan(RINGBUFF_T *RingBuff, void **data)
+{
+	int idx, num, cnt1;
+
+	num = RingBuffer_GetFree(RingBuff);
+	idx = RB_INDH(RingBuff);
+	cnt1 = RingBuff->count - idx;
+	if (num > cnt1) {
+		num = cnt1;
+	}
+
+	*data = RingBuff->data + (idx * RingBuff->itemSize);
+
+	return num;
+}
+
+/* Get the contiguous filled region at the tail of the ring buffer */
+int RingBuffer_GetReadSpan(RINGBUFF_T *RingBuff, void **data)
+{
+	int idx, num, cnt1;
+
+	num = RingBuffer_GetCount(RingBuff);
+
+	/* Items are read after the head that published them */
+	__DMB();
+	idx = RB_INDT(RingBuff);
+	cnt1 = RingBuff->count - idx;
+	if (num > cnt1) {
+		num = cnt1;
 	}
 
-	return popped;
+	*data = RingBuff->data + (idx * RingBuff->itemSize);
+
+	return num;
 }
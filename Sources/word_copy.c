@@ -0,0 +1,59 @@
+/*
+ * @brief Block copy shared by the library modules
+ *
+ * @note
+ * See word_copy.h, internal to the library.
+ */
+
+#include "word_copy.h"
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Public types/enumerations/variables
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+/* Copy a block of bytes, moving whole words when both ends are word aligned */
+void WordCopy(void *dst, const void *src, int bytes)
+{
+	uint8_t *dst8 = dst;
+	const uint8_t *src8 = src;
+
+	if ((((uintptr_t) dst8 | (uintptr_t) src8) & 0x3) == 0) {
+		uint32_t *dst32 = (uint32_t *) dst8;
+		const uint32_t *src32 = (const uint32_t *) src8;
+
+		/* 4 words per pass lets the compiler use LDM/STM */
+		while (bytes >= 16) {
+			dst32[0] = src32[0];
+			dst32[1] = src32[1];
+			dst32[2] = src32[2];
+			dst32[3] = src32[3];
+			dst32 += 4;
+			src32 += 4;
+			bytes -= 16;
+		}
+		while (bytes >= 4) {
+			*dst32++ = *src32++;
+			bytes -= 4;
+		}
+
+		dst8 = (uint8_t *) dst32;
+		src8 = (const uint8_t *) src32;
+	}
+
+	while (bytes > 0) {
+		*dst8++ = *src8++;
+		bytes--;
+	}
+}
@@ -0,0 +1,129 @@
+/*
+ * @brief Host build benchmarks on the GPDMA/SSP behaviour model
+ *
+ * @note
+ * Built and run by the 'host-bench' Makefile target against the host
+ * library. Each case starts a driver transfer, advances the model of
+ * Sources/host/host_model.c until the completion callback runs and prints
+ * the simulated core clocks. The figures compare driver configurations
+ * with each other (descriptor chains, frame widths, channel contention);
+ * they are not a cycle accurate prediction for the target.
+ */
+
+#include "chip.h"
+#include <stdio.h>
+#include <string.h>
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Give up on a case after this many simulated clocks */
+#define BENCH_LIMIT 10000000
+
+static uint8_t memSrc[16384], memDst[16384];
+static uint8_t sspTx[2048], sspRx[2048];
+
+static volatile int memDone, sspDone;
+static Status sspResult;
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+static void Bench_MemDone(uint8_t ch, Status result, void *pUserData)
+{
+	memDone = 1;
+}
+
+static void Bench_SSPDone(LPC_SSP_T *pSSP, Status result, void *pUserData)
+{
+	sspResult = result;
+	sspDone = 1;
+}
+
+/* Advance the model until a flag is set, return the clocks it took */
+static uint64_t Bench_Run(volatile int *pDone)
+{
+	uint64_t start = Host_Cycles();
+
+	while (!*pDone && (Host_Cycles() - start < BENCH_LIMIT)) {
+		Host_Tick(16);
+	}
+	return *pDone ? (Host_Cycles() - start) : 0;
+}
+
+/* Fresh model, GPDMA interrupt enabled, SSP1 in loop back at SCK = clock / 2 */
+static void Bench_Setup(CHIP_SSP_BITS_T bits)
+{
+	SSP_CLOCK_PROFILE_T fastest = {0, 2};
+
+	Host_ResetPeriphRegs();
+	Chip_GPDMA_Init(LPC_GPDMA);
+	Chip_SSP_Init(LPC_SSP1);
+	LPC_SSP1->CR0 = (LPC_SSP1->CR0 & ~0xF) | bits;
+	Chip_SSP_Set_ClockProfile(LPC_SSP1, &fastest);
+	Chip_SSP_EnableLoopBack(LPC_SSP1);
+	Chip_SSP_Enable(LPC_SSP1);
+	NVIC_EnableIRQ(DMA_IRQn);
+	memDone = sspDone = 0;
+}
+
+static void Bench_Memcpy(uint32_t len)
+{
+	uint64_t cycles;
+
+	Bench_Setup(SSP_BITS_8);
+	if (Chip_DMA_Memcpy(LPC_GPDMA, memDst, memSrc, len, Bench_MemDone, NULL) == ERROR) {
+		printf("memcpy %5u bytes: not started\n", (unsigned) len);
+		return;
+	}
+	cycles = Bench_Run(&memDone);
+	printf("memcpy %5u bytes: %7llu clocks, %.2f bytes/clock%s\n", (unsigned) len,
+		   (unsigned long long) cycles, cycles ? (double) len / cycles : 0.0,
+		   (memcmp(memDst, memSrc, len) == 0) ? "" : " DATA MISMATCH");
+}
+
+/* Full-duplex loop back, optionally against a GPDMA memory copy */
+static void Bench_SSP(CHIP_SSP_BITS_T bits, uint32_t frames, uint32_t copy)
+{
+	uint32_t wire = frames * (bits + 1) * 2, bytes = (bits > SSP_BITS_8) ? frames * 2 : frames;
+	uint64_t cycles;
+
+	Bench_Setup(bits);
+	memset(sspRx, 0, sizeof(sspRx));
+	if ((Chip_SSP_DMA_Transfer(LPC_SSP1, sspTx, sspRx, frames, Bench_SSPDone, NULL) == ERROR) ||
+		((copy != 0) && (Chip_DMA_Memcpy(LPC_GPDMA, memDst, memSrc, copy, Bench_MemDone, NULL) == ERROR))) {
+		printf("ssp %2u-bit x %4u: not started\n", (unsigned) (bits + 1), (unsigned) frames);
+		return;
+	}
+	cycles = Bench_Run(&sspDone);
+	printf("ssp %2u-bit x %4u%s: %7llu clocks, %3.0f%% of wire time%s%s\n", (unsigned) (bits + 1),
+		   (unsigned) frames, copy ? " + memcpy" : "         ", (unsigned long long) cycles,
+		   cycles ? 100.0 * wire / cycles : 0.0,
+		   ((sspResult == SUCCESS) && (memcmp(sspRx, sspTx, bytes) == 0)) ? "" : " DATA MISMATCH",
+		   (LPC_SSP1->RIS & SSP_RORRIS) ? " RX OVERRUN" : "");
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+int main(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < sizeof(memSrc); i++) {
+		memSrc[i] = (uint8_t) (i * 13 + 5);
+	}
+	for (i = 0; i < sizeof(sspTx); i++) {
+		sspTx[i] = (uint8_t) (i * 7 + 1);
+	}
+
+	Bench_Memcpy(4096);
+	Bench_Memcpy(16384);
+	Bench_SSP(SSP_BITS_8, 1024, 0);
+	Bench_SSP(SSP_BITS_16, 1024, 0);
+	Bench_SSP(SSP_BITS_8, 1024, 16384);
+	return 0;
+}
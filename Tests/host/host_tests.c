@@ -0,0 +1,1237 @@
+/*
+ * @brief Host build driver tests
+ *
+ * @note
+ * Built and run by the 'host' Makefile target against the host library.
+ * Each test resets the simulated peripheral and core register images,
+ * plays the hardware side by writing status registers and checks what
+ * the driver did. Buffers handed to the GPDMA are static so that their
+ * addresses fit the 32-bit address registers (see host_periph.c).
+ */
+
+#include "chip.h"
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/time.h>
+
+/*****************************************************************************
+ * Private types/enumerations/variables
+ ****************************************************************************/
+
+/* Report a failed check and count it */
+#define CHECK(cond) do { \
+		if (!(cond)) { \
+			printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+			failures++; \
+		} \
+} while (0)
+
+static int failures;
+
+static uint8_t uartTxBuf[64], uartRxBuf[64];
+static UART_RB_CTX_T uartCtx;
+static uint32_t uartRxNotified;
+
+static uint8_t sspBuf[16];
+static int sspDone;
+static Status sspDmaResult;
+
+static int i2cFailed, i2cDone;
+
+static uint8_t dmaChB;
+static int dmaCalls[2];
+
+static uint8_t memDoneCh;
+static char vOrder[8];
+static uint32_t vOrderLen;
+
+static uint8_t streamHalves[4];
+static int streamReports;
+
+static uint32_t sdData[8][3];
+static int sdDataCmds;
+
+/*****************************************************************************
+ * Private functions
+ ****************************************************************************/
+
+/* Raise a terminal count on a GPDMA channel and run the dispatcher */
+static void DMA_RaiseTC(uint8_t ch)
+{
+	*(volatile uint32_t *) &LPC_GPDMA->INTTCSTAT = 1UL << ch;
+	Chip_GPDMA_Interrupt_Handler(LPC_GPDMA);
+	*(volatile uint32_t *) &LPC_GPDMA->INTTCSTAT = 0;
+}
+
+/* Completion of channel A, hands channel B to a new owner */
+static void DMA_DoneA(uint8_t ch, Status result, void *pUserData)
+{
+	dmaCalls[0]++;
+	Chip_DMA_ReleaseChannel(LPC_GPDMA, dmaChB);
+	CHECK(Chip_DMA_AllocChannel(LPC_GPDMA, GPDMA_PRIO_HIGH) == dmaChB);
+	Chip_DMA_SetCallback(LPC_GPDMA, dmaChB, DMA_DoneA, &dmaCalls[1]);
+}
+
+static void DMA_DoneB(uint8_t ch, Status result, void *pUserData)
+{
+	dmaCalls[1]++;
+}
+
+static void DMA_MemDone(uint8_t ch, Status result, void *pUserData)
+{
+	memDoneCh = ch;
+}
+
+static void DMA_VReqDone(uint8_t ch, Status result, void *pUserData)
+{
+	if ((result == SUCCESS) && (vOrderLen < sizeof(vOrder) - 1)) {
+		vOrder[vOrderLen++] = *(const char *) pUserData;
+	}
+}
+
+static void DMA_StreamHalf(DMA_Stream_t *pStream, uint8_t half, Status result)
+{
+	if (streamReports < 4) {
+		streamHalves[streamReports] = half;
+	}
+	streamReports++;
+}
+
+static void UART_RxNotify(LPC_USART_T *pUART, uint32_t num)
+{
+	uartRxNotified += num;
+}
+
+static void SSP_BusDone(SSP_BUS_XFER_T *pXfer, Status result)
+{
+	sspDone++;
+}
+
+static void SSP_DmaDone(LPC_SSP_T *pSSP, Status result, void *pUserData)
+{
+	sspDmaResult = result;
+	sspDone++;
+}
+
+static void I2C_XferDone(I2C_XFER_T *pXfer, Status result)
+{
+	if (result == ERROR) {
+		i2cFailed++;
+	}
+	else {
+		i2cDone++;
+	}
+}
+
+/* Fails like I2C_XferDone() and submits the transaction again, once */
+static void I2C_XferRetry(I2C_XFER_T *pXfer, Status result)
+{
+	I2C_XferDone(pXfer, result);
+	pXfer->callback = I2C_XferDone;
+	Chip_I2C_Queue_Submit(LPC_I2C0, pXfer);
+}
+
+/* Controller side of the SD/MMC interface, run from a timer signal while
+   the driver polls: accepts the pending command and finishes resets */
+static void SD_Controller(int sig)
+{
+	uint32_t v;
+
+	v = LPC_SDMMC->CMD;
+	if (v & MCI_CMD_START) {
+		LPC_SDMMC->CMD = v & ~MCI_CMD_START;
+	}
+	v = LPC_SDMMC->CTRL;
+	if (v & (MCI_CTRL_RESET | MCI_CTRL_FIFO_RESET | MCI_CTRL_DMA_RESET)) {
+		LPC_SDMMC->CTRL = v & ~(MCI_CTRL_RESET | MCI_CTRL_FIFO_RESET | MCI_CTRL_DMA_RESET);
+	}
+}
+
+/* Card side: a 1024 block SDHC card in the transfer state answering the
+   command the controller took last. Data commands are logged. */
+static uint32_t SD_CardWait(void)
+{
+	volatile uint32_t *resp = (volatile uint32_t *) &LPC_SDMMC->RESP0;
+	uint32_t arg = LPC_SDMMC->CMDARG;
+
+	resp[0] = resp[1] = resp[2] = resp[3] = 0;
+	switch (LPC_SDMMC->CMD & 0x3F) {
+	case SD_CMD8:
+		resp[0] = arg;
+		break;
+
+	case SD_APP_OP_COND:
+		resp[0] = (arg != 0) ? (OCR_ALL_READY | OCR_HC_CCS) : 0;
+		break;
+
+	case MMC_ALL_SEND_CID:
+		resp[0] = 1;
+		break;
+
+	case SD_SEND_RELATIVE_ADDR:
+		resp[0] = 1UL << 16;
+		break;
+
+	case MMC_SEND_CSD:
+		resp[1] = 0UL << 16;	/* C_SIZE + 1 = 1, 1024 blocks */
+		resp[2] = 9UL << 16;	/* READ_BL_LEN, 512 bytes */
+		break;
+
+	case MMC_SEND_STATUS:
+		resp[0] = SDMMC_TRAN_ST << 9;
+		break;
+
+	case MMC_READ_SINGLE_BLOCK:
+	case MMC_READ_MULTIPLE_BLOCK:
+	case MMC_WRITE_BLOCK:
+	case MMC_WRITE_MULTIPLE_BLOCK:
+		if (sdDataCmds < 8) {
+			sdData[sdDataCmds][0] = LPC_SDMMC->CMD & 0x3F;
+			sdData[sdDataCmds][1] = arg;
+			sdData[sdDataCmds][2] = LPC_SDMMC->BYTCNT;
+		}
+		sdDataCmds++;
+		break;
+	}
+
+	return MCI_INT_CMD_DONE | MCI_INT_DATA_OVER;
+}
+
+static void SD_EventSetup(uint32_t bits)
+{}
+
+static void SD_Delay(uint32_t ms)
+{}
+
+/* Ring buffer insert/pop across the wrap */
+static void Test_RingBuffer(void)
+{
+	static uint8_t store[8];
+	RINGBUFF_T rb;
+	uint8_t out[8];
+	int i;
+
+	CHECK(RingBuffer_Init(&rb, store, 1, 8) == SUCCESS);
+	CHECK(RingBuffer_InsertMult(&rb, "abcdef", 6) == 6);
+	CHECK(RingBuffer_PopMult(&rb, out, 4) == 4);
+	CHECK(RingBuffer_InsertMult(&rb, "ghijklmn", 8) == 6);
+	CHECK(RingBuffer_IsFull(&rb));
+	CHECK(RingBuffer_PopMult(&rb, out, 8) == 8);
+	CHECK(memcmp(out, "efghijkl", 8) == 0);
+	for (i = 0; i < 8; i++) {
+		CHECK(RingBuffer_Insert(&rb, &out[i]) == SUCCESS);
+	}
+	CHECK(RingBuffer_Insert(&rb, &out[0]) == ERROR);
+}
+
+/* Block copies split at the end of the storage, also when the free
+   running indices wrap and the caller's buffer is unaligned */
+static void Test_RingBufferSegments(void)
+{
+	static uint32_t store32[16];
+	static uint8_t store8[32];
+	RINGBUFF_T rb;
+	uint32_t words[10];
+	uint8_t bytes[24], out[24];
+	int i;
+
+	CHECK(RingBuffer_Init(&rb, store32, sizeof(uint32_t), 16) == SUCCESS);
+	rb.head = rb.tail = 0xFFFFFFFE;
+	for (i = 0; i < 10; i++) {
+		words[i] = 0x01010101UL * (i + 1);
+	}
+	CHECK(RingBuffer_InsertMult32(&rb, words, 10) == 10);
+	CHECK((store32[14] == words[0]) && (store32[15] == words[1]));
+	CHECK((store32[0] == words[2]) && (store32[7] == words[9]));
+	CHECK((rb.head == 8) && (RingBuffer_GetCount(&rb) == 10));
+	CHECK(RingBuffer_PopMult(&rb, out + 1, 5) == 5);
+	CHECK(memcmp(out + 1, words, 5 * sizeof(uint32_t)) == 0);
+	CHECK(RingBuffer_PopMult32(&rb, words, 10) == 5);
+	CHECK((words[0] == 0x06060606UL) && (words[4] == 0x0A0A0A0AUL));
+	CHECK(RingBuffer_IsEmpty(&rb));
+
+	CHECK(RingBuffer_Init(&rb, store8, 1, 32) == SUCCESS);
+	rb.head = rb.tail = 25;
+	for (i = 0; i < (int) sizeof(bytes); i++) {
+		bytes[i] = (uint8_t) (i + 0x40);
+	}
+	CHECK(RingBuffer_InsertMult8(&rb, bytes + 3, 13) == 13);
+	CHECK((store8[25] == bytes[3]) && (store8[31] == bytes[9]));
+	CHECK((store8[0] == bytes[10]) && (store8[5] == bytes[15]));
+	memset(out, 0, sizeof(out));
+	CHECK(RingBuffer_PopMult8(&rb, out + 3, 20) == 13);
+	CHECK(memcmp(out + 3, bytes + 3, 13) == 0);
+}
+
+/* Zero-copy spans hand out the storage in at most two pieces */
+static void Test_RingBufferSpans(void)
+{
+	static uint8_t store[8];
+	RINGBUFF_T rb;
+	void *span;
+
+	CHECK(RingBuffer_Init(&rb, store, 1, 8) == SUCCESS);
+	rb.head = rb.tail = 6;
+	CHECK(RingBuffer_GetReadSpan(&rb, &span) == 0);
+
+	CHECK((RingBuffer_GetWriteSpan(&rb, &span) == 2) && (span == &store[6]));
+	memcpy(span, "ab", 2);
+	CHECK(RingBuffer_IsEmpty(&rb));
+	RingBuffer_CommitWrite(&rb, 2);
+	CHECK((RingBuffer_GetWriteSpan(&rb, &span) == 6) && (span == &store[0]));
+	memcpy(span, "cdefgh", 6);
+	RingBuffer_CommitWrite(&rb, 6);
+	CHECK(RingBuffer_IsFull(&rb));
+	CHECK(RingBuffer_GetWriteSpan(&rb, &span) == 0);
+
+	CHECK((RingBuffer_GetReadSpan(&rb, &span) == 2) && (memcmp(span, "ab", 2) == 0));
+	RingBuffer_Consume(&rb, 1);
+	CHECK((RingBuffer_GetReadSpan(&rb, &span) == 1) && (memcmp(span, "b", 1) == 0));
+	RingBuffer_Consume(&rb, 1);
+	CHECK((RingBuffer_GetReadSpan(&rb, &span) == 6) && (memcmp(span, "cdefgh", 6) == 0));
+	CHECK(RingBuffer_GetWriteSpan(&rb, &span) == 2);
+	RingBuffer_Consume(&rb, 6);
+	CHECK(RingBuffer_IsEmpty(&rb));
+	CHECK((RingBuffer_GetWriteSpan(&rb, &span) == 2) && (span == &store[6]));
+}
+
+/* Overwrite mode drops the oldest records of any size */
+static void Test_RingBufferOverwrite(void)
+{
+	typedef struct {
+		uint32_t seq;
+		uint8_t payload[9];
+	} REC_T;
+	static REC_T store[4];
+	REC_T recs[8], out[4];
+	RINGBUFF_T rb;
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		memset(&recs[i], i, sizeof(REC_T));
+		recs[i].seq = i;
+	}
+	CHECK(RingBuffer_Init(&rb, store, sizeof(REC_T), 4) == SUCCESS);
+	RingBuffer_SetMode(&rb, RINGBUFF_MODE_OVERWRITE);
+
+	/* A block larger than the free space pushes out the oldest records */
+	CHECK(RingBuffer_InsertMult(&rb, &recs[0], 3) == 3);
+	CHECK(RingBuffer_InsertMult(&rb, &recs[3], 3) == 3);
+	CHECK(RingBuffer_GetCount(&rb) == 4);
+	CHECK(RingBuffer_Pop(&rb, &out[0]) == SUCCESS);
+	CHECK(memcmp(&out[0], &recs[2], sizeof(REC_T)) == 0);
+
+	/* A single insert into a full buffer replaces the oldest record */
+	CHECK(RingBuffer_Insert(&rb, &recs[6]) == SUCCESS);
+	CHECK(RingBuffer_Insert(&rb, &recs[7]) == SUCCESS);
+	CHECK(RingBuffer_PopMult(&rb, out, 4) == 4);
+	CHECK((out[0].seq == 4) && (out[3].seq == 7));
+	CHECK(memcmp(&out[1], &recs[5], sizeof(REC_T)) == 0);
+
+	/* Only the newest count records of an oversized block survive */
+	CHECK(RingBuffer_Insert(&rb, &recs[0]) == SUCCESS);
+	CHECK(RingBuffer_InsertMult(&rb, &recs[1], 7) == 4);
+	CHECK(RingBuffer_PopMult(&rb, out, 4) == 4);
+	CHECK(memcmp(out, &recs[4], 4 * sizeof(REC_T)) == 0);
+
+	/* Reject mode keeps the oldest */
+	RingBuffer_SetMode(&rb, RINGBUFF_MODE_REJECT);
+	CHECK(RingBuffer_InsertMult(&rb, &recs[0], 6) == 4);
+	CHECK(RingBuffer_Insert(&rb, &recs[7]) == ERROR);
+	CHECK((RingBuffer_Pop(&rb, &out[0]) == SUCCESS) && (out[0].seq == 0));
+}
+
+/* Core peripherals live in the host image */
+static void Test_CorePeripherals(void)
+{
+	Host_ResetPeriphRegs();
+	NVIC_EnableIRQ(DMA_IRQn);
+	CHECK(NVIC->ISER[0] == (1UL << DMA_IRQn));
+	SCB->VTOR = 0x10000000;
+	CHECK(SCB->VTOR == 0x10000000);
+}
+
+/* Transfers over 0xFFF items run as a chain of 0xFE0 item segments from
+   the pool, interrupt once and give the pool back when done */
+static void Test_GPDMA_ChainSplit(void)
+{
+	static uint8_t src[10001], dst[10001];
+	const DMA_TransferDescriptor_t *pDesc;
+	uint32_t i;
+	uint8_t ch;
+
+	Host_ResetPeriphRegs();
+	Chip_GPDMA_Init(LPC_GPDMA);
+	NVIC_EnableIRQ(DMA_IRQn);
+	for (i = 0; i < sizeof(src); i++) {
+		src[i] = (uint8_t) (i * 3 + 1);
+	}
+	memset(dst, 0, sizeof(dst));
+	ch = Chip_DMA_AllocChannel(LPC_GPDMA, GPDMA_PRIO_LOW);
+	Chip_DMA_SetCallback(LPC_GPDMA, ch, DMA_MemDone, NULL);
+	memDoneCh = GPDMA_CHANNEL_NONE;
+
+	/* An odd size moves bytes: 0xFE0 in the channel, then 0xFE0 and the rest */
+	CHECK(Chip_DMA_Transfer(LPC_GPDMA, ch, (uint32_t) (uintptr_t) src, (uint32_t) (uintptr_t) dst,
+							GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA, sizeof(src)) == SUCCESS);
+	CHECK(((LPC_GPDMA->CH[ch].CONTROL & 0xFFF) == 0xFE0) && !(LPC_GPDMA->CH[ch].CONTROL & GPDMA_DMACCxControl_I));
+	pDesc = (const DMA_TransferDescriptor_t *) (uintptr_t) LPC_GPDMA->CH[ch].LLI;
+	CHECK((pDesc->src == (uint32_t) (uintptr_t) &src[0xFE0]) && (pDesc->dst == (uint32_t) (uintptr_t) &dst[0xFE0]));
+	CHECK(((pDesc->ctrl & 0xFFF) == 0xFE0) && !(pDesc->ctrl & GPDMA_DMACCxControl_I));
+	pDesc = (const DMA_TransferDescriptor_t *) (uintptr_t) pDesc->lli;
+	CHECK((pDesc->src == (uint32_t) (uintptr_t) &src[2 * 0xFE0]) && (pDesc->lli == 0));
+	CHECK(((pDesc->ctrl & 0xFFF) == sizeof(src) - 2 * 0xFE0) && (pDesc->ctrl & GPDMA_DMACCxControl_I));
+
+	/* A byte transfer needing the whole pool has to wait for the chain */
+	CHECK(Chip_DMA_Transfer(LPC_GPDMA, (uint8_t) (ch - 1), (uint32_t) (uintptr_t) src, (uint32_t) (uintptr_t) dst,
+							GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA,
+							GPDMA_DESC_POOL_SIZE * 0xFE0 + 1) == ERROR);
+
+	for (i = 0; (i < 100000) && (memDoneCh == GPDMA_CHANNEL_NONE); i++) {
+		Host_Tick(64);
+	}
+	CHECK(memDoneCh == ch);
+	CHECK(memcmp(dst, src, sizeof(src)) == 0);
+	CHECK(LPC_GPDMA->ENBLDCHNS == 0);
+
+	/* The chain went back on completion, the whole pool is free again */
+	CHECK(Chip_DMA_Transfer(LPC_GPDMA, (uint8_t) (ch - 1), (uint32_t) (uintptr_t) src, (uint32_t) (uintptr_t) dst,
+							GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA,
+							GPDMA_DESC_POOL_SIZE * 0xFE0 + 1) == SUCCESS);
+	Chip_DMA_Stop(LPC_GPDMA, (uint8_t) (ch - 1));
+	Chip_DMA_ReleaseChannel(LPC_GPDMA, ch);
+}
+
+/* The DMAMUX table selects each connection's request line function, and a
+   prepared transfer writes the same registers as Chip_DMA_Transfer() */
+static void Test_GPDMA_Prepared(void)
+{
+	static uint8_t buf[16];
+	DMA_PreparedTransfer_t xfer;
+	uint32_t control, config;
+
+	Host_ResetPeriphRegs();
+	Chip_GPDMA_Init(LPC_GPDMA);
+
+	/* UART0 Tx is function 1 of request line 1, SSP1 Rx function 0 of line 11 */
+	LPC_CREG->DMAMUX = 0xFFFFFFFF;
+	CHECK(Chip_DMA_Transfer(LPC_GPDMA, 0, (uint32_t) (uintptr_t) buf, GPDMA_CONN_UART0_Tx,
+							GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA, sizeof(buf)) == SUCCESS);
+	CHECK(LPC_CREG->DMAMUX == (0xFFFFFFFF & ~(0x3UL << 2)) + (1UL << 2));
+	CHECK(((LPC_GPDMA->CH[0].CONFIG >> 6) & 0x1F) == 1);
+	CHECK(LPC_GPDMA->CH[0].DESTADDR == (uint32_t) (uintptr_t) &LPC_USART0->THR);
+	CHECK(Chip_DMA_Transfer(LPC_GPDMA, 1, GPDMA_CONN_SSP1_Rx, (uint32_t) (uintptr_t) buf,
+							GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA, sizeof(buf)) == SUCCESS);
+	CHECK(((LPC_CREG->DMAMUX >> 22) & 0x3) == 0);
+	CHECK(((LPC_GPDMA->CH[1].CONFIG >> 1) & 0x1F) == 11);
+
+	control = LPC_GPDMA->CH[0].CONTROL;
+	config = LPC_GPDMA->CH[0].CONFIG;
+	memset((void *) &LPC_GPDMA->CH[0], 0, sizeof(LPC_GPDMA->CH[0]));
+	LPC_CREG->DMAMUX = 0xFFFFFFFF;
+
+	/* Preparing touches no channel or DMAMUX register, starting does */
+	CHECK(Chip_DMA_PrepareTransfer(LPC_GPDMA, &xfer, 0, (uint32_t) (uintptr_t) buf, GPDMA_CONN_UART0_Tx,
+								   GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA, sizeof(buf)) == SUCCESS);
+	CHECK((LPC_GPDMA->CH[0].CONFIG == 0) && (LPC_CREG->DMAMUX == 0xFFFFFFFF));
+	CHECK(Chip_DMA_StartPrepared(LPC_GPDMA, &xfer) == SUCCESS);
+	CHECK((LPC_GPDMA->CH[0].CONTROL == control) && (LPC_GPDMA->CH[0].CONFIG == config));
+	CHECK(LPC_GPDMA->CH[0].SRCADDR == (uint32_t) (uintptr_t) buf);
+	CHECK(LPC_CREG->DMAMUX == (0xFFFFFFFF & ~(0x3UL << 2)) + (1UL << 2));
+
+	/* A channel still running is not restarted */
+	*(volatile uint32_t *) &LPC_GPDMA->ENBLDCHNS = 1;
+	CHECK(Chip_DMA_StartPrepared(LPC_GPDMA, &xfer) == ERROR);
+	CHECK(Chip_DMA_PrepareTransfer(LPC_GPDMA, &xfer, 0, (uint32_t) (uintptr_t) buf, GPDMA_CONN_UART0_Tx,
+								   GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA, GPDMA_MAX_XFER_SIZE + 1) == ERROR);
+}
+
+/* Virtual channels share the free physical channels in waiting order,
+   a reserved one serves its owner alone */
+static void Test_GPDMA_VChannels(void)
+{
+	static uint8_t src[4][64], dst[4][64];
+	static const char tags[] = "ABCR";
+	static DMA_VChannel_t vA, vB, vR;
+	DMA_VRequest_t req[4];
+	uint8_t held[6];
+	int i;
+
+	Host_ResetPeriphRegs();
+	Chip_GPDMA_Init(LPC_GPDMA);
+	NVIC_EnableIRQ(DMA_IRQn);
+	for (i = 0; i < 6; i++) {
+		held[i] = Chip_DMA_AllocChannel(LPC_GPDMA, GPDMA_PRIO_HIGH);
+	}
+	for (i = 0; i < 4; i++) {
+		memset(src[i], 0x11 * (i + 1), sizeof(src[i]));
+		memset(dst[i], 0, sizeof(dst[i]));
+		memset(&req[i], 0, sizeof(req[i]));
+		req[i].src = (uint32_t) (uintptr_t) src[i];
+		req[i].dst = (uint32_t) (uintptr_t) dst[i];
+		req[i].TransferType = GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA;
+		req[i].Size = sizeof(src[i]);
+		req[i].callback = DMA_VReqDone;
+		req[i].pUserData = (void *) &tags[i];
+	}
+	vOrderLen = 0;
+
+	/* One channel for R alone, the last one shared by A and B */
+	CHECK(Chip_DMA_VChannelInit(LPC_GPDMA, &vR, GPDMA_PRIO_LOW, true) == SUCCESS);
+	CHECK(Chip_DMA_VChannelInit(LPC_GPDMA, &vA, GPDMA_PRIO_LOW, false) == SUCCESS);
+	CHECK(Chip_DMA_VChannelInit(LPC_GPDMA, &vB, GPDMA_PRIO_LOW, false) == SUCCESS);
+	CHECK(Chip_DMA_VSubmit(LPC_GPDMA, &vA, &req[0]) == SUCCESS);
+	CHECK(Chip_DMA_VSubmit(LPC_GPDMA, &vA, &req[2]) == SUCCESS);
+	CHECK(Chip_DMA_VSubmit(LPC_GPDMA, &vB, &req[1]) == SUCCESS);
+	CHECK((vA.active != GPDMA_CHANNEL_NONE) && (vA.head == &req[0]));
+	CHECK(vB.waiting && (vB.active == GPDMA_CHANNEL_NONE));
+	CHECK(Chip_DMA_VSubmit(LPC_GPDMA, &vR, &req[3]) == SUCCESS);
+	CHECK(vR.active == vR.reserved);
+
+	/* A's second request waits for B, which waited longer */
+	for (i = 0; (i < 10000) && (vOrderLen < 4); i++) {
+		Host_Tick(16);
+	}
+	CHECK((vOrderLen == 4) && (memchr(vOrder, 'R', 4) != NULL));
+	for (i = 0; vOrder[i] == 'R'; i++) {}
+	CHECK(vOrder[i] == 'A');
+	for (i++; vOrder[i] == 'R'; i++) {}
+	CHECK(vOrder[i] == 'B');
+	for (i = 0; i < 4; i++) {
+		CHECK(memcmp(dst[i], src[i], sizeof(src[i])) == 0);
+	}
+
+	/* The shared channel went back once the queues were empty */
+	CHECK((vA.active == GPDMA_CHANNEL_NONE) && (vB.active == GPDMA_CHANNEL_NONE) && !vB.waiting);
+	CHECK(Chip_DMA_VChannelDeInit(LPC_GPDMA, &vR) == SUCCESS);
+	CHECK(Chip_DMA_AllocChannel(LPC_GPDMA, GPDMA_PRIO_LOW) != GPDMA_CHANNEL_NONE);
+	CHECK(Chip_DMA_AllocChannel(LPC_GPDMA, GPDMA_PRIO_LOW) != GPDMA_CHANNEL_NONE);
+	for (i = 0; i < 6; i++) {
+		Chip_DMA_ReleaseChannel(LPC_GPDMA, held[i]);
+	}
+}
+
+/* Scatter-gather starts take the request line from the given connection */
+static void Test_GPDMA_SGTransfer(void)
+{
+	static uint32_t buf[4];
+	DMA_TransferDescriptor_t desc;
+	uint8_t ch;
+
+	Host_ResetPeriphRegs();
+	Chip_GPDMA_Init(LPC_GPDMA);
+	ch = Chip_DMA_AllocChannel(LPC_GPDMA, GPDMA_PRIO_HIGH);
+	CHECK(ch != GPDMA_CHANNEL_NONE);
+
+	CHECK(Chip_DMA_PrepareDescriptor(LPC_GPDMA, &desc, (uint32_t) (uintptr_t) buf, GPDMA_CONN_SCT_0, 4,
+									 GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA, NULL) == SUCCESS);
+	CHECK(Chip_DMA_SGTransferConn(LPC_GPDMA, ch, &desc, GPDMA_CONN_MEMORY, GPDMA_CONN_SCT_0,
+								  GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA) == SUCCESS);
+	CHECK(LPC_GPDMA->CH[ch].LLI == 0);
+	CHECK(Chip_DMA_SGTransferConn(LPC_GPDMA, ch, &desc, GPDMA_CONN_MEMORY, GPDMA_CONN_MEMORY,
+								  GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA) == ERROR);
+
+	/* Without connections they are found from the descriptor addresses */
+	CHECK(Chip_DMA_PrepareDescriptor(LPC_GPDMA, &desc, (uint32_t) (uintptr_t) buf, GPDMA_CONN_UART0_Tx, 4,
+									 GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA, NULL) == SUCCESS);
+	CHECK(Chip_DMA_SGTransfer(LPC_GPDMA, ch, &desc, GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA) == SUCCESS);
+	CHECK(LPC_GPDMA->CH[ch].DESTADDR == (uint32_t) (uintptr_t) &LPC_USART0->THR);
+	Chip_DMA_ReleaseChannel(LPC_GPDMA, ch);
+}
+
+/* A channel handed over by an earlier callback is not dispatched to its
+   new owner for the old status */
+static void Test_GPDMA_HandOver(void)
+{
+	uint8_t chA;
+
+	Host_ResetPeriphRegs();
+	Chip_GPDMA_Init(LPC_GPDMA);
+	chA = Chip_DMA_AllocChannel(LPC_GPDMA, GPDMA_PRIO_HIGH);
+	dmaChB = Chip_DMA_AllocChannel(LPC_GPDMA, GPDMA_PRIO_HIGH);
+	Chip_DMA_SetCallback(LPC_GPDMA, chA, DMA_DoneA, NULL);
+	Chip_DMA_SetCallback(LPC_GPDMA, dmaChB, DMA_DoneB, NULL);
+	dmaCalls[0] = dmaCalls[1] = 0;
+
+	*(volatile uint32_t *) &LPC_GPDMA->INTTCSTAT = (1UL << chA) | (1UL << dmaChB);
+	Chip_GPDMA_Interrupt_Handler(LPC_GPDMA);
+	*(volatile uint32_t *) &LPC_GPDMA->INTTCSTAT = 0;
+	CHECK(dmaCalls[0] == 1);
+	CHECK(dmaCalls[1] == 0);
+
+	Chip_DMA_ReleaseChannel(LPC_GPDMA, chA);
+	Chip_DMA_ReleaseChannel(LPC_GPDMA, dmaChB);
+}
+
+/* Calibration leaves the cycle counter as the application set it */
+static void Test_GPDMA_MemCalibrate(void)
+{
+	static uint8_t from[64], to[64];
+
+	Host_ResetPeriphRegs();
+	Chip_GPDMA_Init(LPC_GPDMA);
+	Chip_DMA_MemCalibrate(LPC_GPDMA, to, from, sizeof(to));
+	CHECK((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0);
+	CHECK((CoreDebug->DEMCR & CoreDebug_DEMCR_TRCENA_Msk) == 0);
+
+	CoreDebug->DEMCR = CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL = DWT_CTRL_CYCCNTENA_Msk;
+	Chip_DMA_MemCalibrate(LPC_GPDMA, to, from, sizeof(to));
+	CHECK((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) != 0);
+	CHECK((CoreDebug->DEMCR & CoreDebug_DEMCR_TRCENA_Msk) != 0);
+}
+
+/* Stream halves are only handed over once the GPDMA has left them */
+static void Test_GPDMA_Stream(void)
+{
+	static uint16_t bufA[8], bufB[8];
+	static DMA_Stream_t stream;
+	uint32_t runA, runB;
+	uint8_t ch;
+
+	Host_ResetPeriphRegs();
+	Chip_GPDMA_Init(LPC_GPDMA);
+	CHECK(Chip_DMA_StreamStart(LPC_GPDMA, &stream, GPDMA_CONN_DAC, GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA,
+							   (uint32_t) (uintptr_t) bufA, (uint32_t) (uintptr_t) bufB, 8,
+							   DMA_StreamHalf, NULL) == SUCCESS);
+	ch = stream.ChannelNum;
+	streamReports = 0;
+
+	/* LLI points at the descriptor after the running one */
+	runA = (uint32_t) (uintptr_t) &stream.desc[1];
+	runB = (uint32_t) (uintptr_t) &stream.desc[0];
+
+	/* A done, B running */
+	LPC_GPDMA->CH[ch].LLI = runB;
+	DMA_RaiseTC(ch);
+	CHECK((streamReports == 1) && (streamHalves[0] == 0));
+
+	/* Two TCs, one interrupt: B and A done, B running again */
+	DMA_RaiseTC(ch);
+	CHECK((streamReports == 2) && (streamHalves[1] == 0));
+	CHECK(stream.lost == 1);
+
+	/* B done, A running */
+	LPC_GPDMA->CH[ch].LLI = runA;
+	DMA_RaiseTC(ch);
+	CHECK((streamReports == 3) && (streamHalves[2] == 1));
+
+	/* TC after clear, before the LLI read: A done, then B done and A
+	   running again. Nothing is reported until the pending interrupt,
+	   which hands over B only. */
+	*(volatile uint32_t *) &LPC_GPDMA->RAWINTTCSTAT = 1UL << ch;
+	DMA_RaiseTC(ch);
+	CHECK(streamReports == 3);
+	*(volatile uint32_t *) &LPC_GPDMA->RAWINTTCSTAT = 0;
+	DMA_RaiseTC(ch);
+	CHECK((streamReports == 4) && (streamHalves[3] == 1));
+	CHECK(stream.lost == 2);
+
+	Chip_DMA_StreamStop(LPC_GPDMA, &stream);
+	CHECK(stream.ChannelNum == GPDMA_CHANNEL_NONE);
+}
+
+/* A GPDMA copy frees its channel before the callback, which is not told
+   the channel number any more */
+static void Test_GPDMA_MemDone(void)
+{
+	static uint32_t from[16], to[16];
+	uint8_t ch;
+
+	Host_ResetPeriphRegs();
+	Chip_GPDMA_Init(LPC_GPDMA);
+	Chip_DMA_SetMemThreshold(16);
+	memDoneCh = 0;
+	CHECK(Chip_DMA_Memcpy(LPC_GPDMA, to, from, sizeof(to), DMA_MemDone, NULL) == SUCCESS);
+	ch = Chip_DMA_AllocChannel(LPC_GPDMA, GPDMA_PRIO_LOW);
+	CHECK(ch == GPDMA_NUMBER_CHANNELS - 2);
+	Chip_DMA_ReleaseChannel(LPC_GPDMA, ch);
+
+	DMA_RaiseTC(GPDMA_NUMBER_CHANNELS - 1);
+	CHECK(memDoneCh == GPDMA_CHANNEL_NONE);
+	CHECK(Chip_DMA_AllocChannel(LPC_GPDMA, GPDMA_PRIO_LOW) == GPDMA_NUMBER_CHANNELS - 1);
+	Chip_DMA_ReleaseChannel(LPC_GPDMA, GPDMA_NUMBER_CHANNELS - 1);
+	Chip_DMA_SetMemThreshold(GPDMA_MEM_DMA_THRESHOLD);
+}
+
+/* A fill the GPDMA can only do narrower than a pixel falls back to the CPU */
+static void Test_GPDMA_BlitFillNarrow(void)
+{
+	static uint32_t fb[8];
+	uint8_t *line = (uint8_t *) fb + 2;
+	uint32_t pixel;
+
+	Host_ResetPeriphRegs();
+	Chip_GPDMA_Init(LPC_GPDMA);
+	memset(fb, 0, sizeof(fb));
+
+	/* Halfword aligned 32-bit pixels */
+	CHECK(Chip_DMA_BlitFill(LPC_GPDMA, line, 0x11223344, 2, 2, 10, 4, NULL, NULL) == SUCCESS);
+	memcpy(&pixel, line + 14, 4);
+	CHECK(pixel == 0x11223344);
+	CHECK(LPC_GPDMA->CH[0].CONFIG == 0);
+}
+
+/* UART receive DMA publishing, including a lap of the ring */
+static void Test_UART_RxDMA(void)
+{
+	uint8_t out[128];
+	uint8_t ch = 3;
+
+	Host_ResetPeriphRegs();
+	Chip_GPDMA_Init(LPC_GPDMA);
+	uartRxNotified = 0;
+	CHECK(Chip_UART_InitRingBuffer(LPC_USART0, &uartCtx, uartTxBuf, 64, uartRxBuf, 64) == SUCCESS);
+	CHECK(Chip_UART_DMA_RxStart(LPC_USART0, ch, UART_RxNotify) == SUCCESS);
+
+	memcpy(uartRxBuf, "hello world", 11);
+	LPC_GPDMA->CH[ch].DESTADDR = (uint32_t) (uintptr_t) uartRxBuf + 11;
+	CHECK(Chip_UART_DMA_RxSync(LPC_USART0) == 11);
+	CHECK(Chip_UART_Interrupt_Receive(LPC_USART0, out, sizeof(out)) == 11);
+	CHECK(memcmp(out, "hello world", 11) == 0);
+
+	/* Half done, then two more halves merged into one interrupt */
+	LPC_GPDMA->CH[ch].DESTADDR = (uint32_t) (uintptr_t) uartRxBuf + 40;
+	DMA_RaiseTC(ch);
+	CHECK(uartRxNotified == 40);
+	DMA_RaiseTC(ch);
+	CHECK(uartRxNotified == 104);
+	CHECK(uartCtx.rxDmaOverrun == 29);
+	CHECK(Chip_UART_Interrupt_Receive(LPC_USART0, out, sizeof(out)) == 64);
+
+	Chip_UART_DMA_RxStop(LPC_USART0);
+	CHECK(uartCtx.rxDmaCh == -1);
+	CHECK(Chip_UART_DMA_RxSync(LPC_USART0) == 0);
+}
+
+/* An SSP bus transaction waits for GPDMA channels instead of blocking */
+static void Test_SSP_BusWait(void)
+{
+	SSP_BUS_DEVICE_T dev = {1000000, SSP_BITS_8, SSP_CLOCK_MODE0, {1, 2}};
+	SSP_BUS_DEVICE_T dev1 = {1000000, SSP_BITS_8, SSP_CLOCK_MODE0, {1, 3}};
+	static SSP_BUS_XFER_T xfer, xfer1;
+	static SSP_BUS_T bus, bus1;
+	uint8_t held[7];
+	int i;
+
+	Host_ResetPeriphRegs();
+	Chip_GPDMA_Init(LPC_GPDMA);
+	Chip_SSP_Init(LPC_SSP0);
+	Chip_SSP_Init(LPC_SSP1);
+	Chip_SSP_Bus_Init(&bus, LPC_SSP0);
+	Chip_SSP_Bus_Init(&bus1, LPC_SSP1);
+	Chip_SSP_Bus_AddDevice(&dev);
+	Chip_SSP_Bus_AddDevice(&dev1);
+	sspDone = 0;
+
+	for (i = 0; i < 7; i++) {
+		held[i] = Chip_DMA_AllocChannel(LPC_GPDMA, GPDMA_PRIO_HIGH);
+	}
+	memset(&xfer, 0, sizeof(xfer));
+	xfer.pDev = &dev;
+	xfer.tx_data = sspBuf;
+	xfer.frames = 4;
+	xfer.callback = SSP_BusDone;
+	CHECK(Chip_SSP_Bus_Submit(&bus, &xfer) == SUCCESS);
+	CHECK(bus.stalled && (bus.active == &xfer));
+	CHECK(Chip_GPIO_ReadPortBit(LPC_GPIO_PORT, 1, 2) == true);
+
+	Chip_DMA_ReleaseChannel(LPC_GPDMA, held[3]);
+	CHECK(!bus.stalled);
+	CHECK(Chip_GPIO_ReadPortBit(LPC_GPIO_PORT, 1, 2) == false);
+	CHECK(sspDone == 0);
+
+	/* held[3] belongs to the first bus now, the second one waits for two
+	   more channels of its own */
+	xfer1 = xfer;
+	xfer1.pDev = &dev1;
+	CHECK(Chip_SSP_Bus_Submit(&bus1, &xfer1) == SUCCESS);
+	CHECK(bus1.stalled);
+	Chip_DMA_ReleaseChannel(LPC_GPDMA, held[0]);
+	CHECK(bus1.stalled);
+	Chip_DMA_ReleaseChannel(LPC_GPDMA, held[1]);
+	CHECK(!bus1.stalled);
+	CHECK(Chip_GPIO_ReadPortBit(LPC_GPIO_PORT, 1, 3) == false);
+
+	for (i = 2; i < 7; i++) {
+		if (i != 3) {
+			Chip_DMA_ReleaseChannel(LPC_GPDMA, held[i]);
+		}
+	}
+	Chip_SSP_Bus_DeInit(&bus);
+	Chip_SSP_Bus_DeInit(&bus1);
+}
+
+/* A clock profile goes stale with a clock change */
+static void Test_SSP_ClockProfile(void)
+{
+	SSP_CLOCK_PROFILE_T profile;
+
+	Host_ResetPeriphRegs();
+	Chip_Clock_SetBaseClock(CLK_BASE_MX, CLKIN_IRC, true, false);
+	Chip_Clock_EnableOpts(CLK_MX_SSP0, true, true, 1);
+
+	Chip_SSP_Calc_ClockProfile(LPC_SSP0, 1000000, &profile);
+	CHECK(profile.clkRate == 12000000);
+	CHECK(Chip_SSP_ClockProfileValid(&profile));
+	Chip_SSP_Set_ClockProfile(LPC_SSP0, &profile);
+	CHECK(LPC_SSP0->CPSR == profile.cpsr);
+
+	Chip_Clock_EnableOpts(CLK_MX_SSP0, true, true, 2);
+	CHECK(!Chip_SSP_ClockProfileValid(&profile));
+	Chip_SSP_Calc_ClockProfile(LPC_SSP0, 1000000, &profile);
+	CHECK(profile.clkRate == 6000000);
+	CHECK(Chip_SSP_ClockProfileValid(&profile));
+}
+
+/* A blocking transfer that overruns keeps the progress of each direction */
+static void Test_SSP_RWResume(void)
+{
+	Chip_SSP_DATA_SETUP_T xf;
+
+	Host_ResetPeriphRegs();
+	Chip_SSP_Init(LPC_SSP0);
+	memset(&xf, 0, sizeof(xf));
+	xf.tx_data = sspBuf;
+	xf.rx_data = sspBuf;
+	xf.length = 20;
+	xf.tx_cnt = 4;
+	xf.rx_cnt = 2;
+
+	/* Nothing is received, the overrun flag stops the kernel after one
+	   FIFO depth of frames */
+	*(volatile uint32_t *) &LPC_SSP0->RIS = SSP_RORRIS;
+	CHECK(Chip_SSP_RWFrames_Blocking(LPC_SSP0, &xf) == ERROR);
+	CHECK((xf.tx_cnt == 4 + 8) && (xf.rx_cnt == 2));
+}
+
+/* Blocking transfers fill a FIFO depth of frames before reading status */
+static void Test_SSP_Batching(void)
+{
+	static uint8_t tx8[20];
+	static uint16_t tx16[20];
+	int i;
+
+	Host_ResetPeriphRegs();
+	Chip_SSP_Init(LPC_SSP0);
+	for (i = 0; i < 20; i++) {
+		tx8[i] = (uint8_t) (0x30 + i);
+		tx16[i] = (uint16_t) (0x1230 + i);
+	}
+
+	/* DR holds the last frame written when the overrun stops the kernel */
+	*(volatile uint32_t *) &LPC_SSP0->RIS = SSP_RORRIS;
+	CHECK(Chip_SSP_WriteFrames_Blocking(LPC_SSP0, tx8, sizeof(tx8)) == ERROR);
+	CHECK(LPC_SSP0->DR == tx8[7]);
+
+	LPC_SSP0->CR0 = (LPC_SSP0->CR0 & ~0xF) | SSP_BITS_16;
+	CHECK(Chip_SSP_WriteFrames_Blocking(LPC_SSP0, (uint8_t *) tx16, sizeof(tx16)) == ERROR);
+	CHECK(LPC_SSP0->DR == tx16[7]);
+
+	/* Receive only clocks out all ones */
+	CHECK(Chip_SSP_ReadFrames_Blocking(LPC_SSP0, (uint8_t *) tx16, sizeof(tx16)) == ERROR);
+	CHECK(LPC_SSP0->DR == 0xFFFF);
+	CHECK(tx16[0] == 0x1230);
+}
+
+/* Full-duplex SSP DMA in loop back mode, run on the behaviour model */
+static void Test_SSP_DMALoopback(void)
+{
+	static uint8_t tx[300], rx[300];
+	static uint16_t tx16[20];
+	uint64_t start;
+	int i;
+
+	Host_ResetPeriphRegs();
+	Chip_GPDMA_Init(LPC_GPDMA);
+	Chip_SSP_Init(LPC_SSP1);
+	Chip_SSP_EnableLoopBack(LPC_SSP1);
+	Chip_SSP_Enable(LPC_SSP1);
+	NVIC_EnableIRQ(DMA_IRQn);
+	for (i = 0; i < (int) sizeof(tx); i++) {
+		tx[i] = (uint8_t) (i * 7 + 1);
+	}
+	memset(rx, 0, sizeof(rx));
+	sspDone = 0;
+
+	CHECK(Chip_SSP_DMA_Transfer(LPC_SSP1, tx, rx, sizeof(tx), SSP_DmaDone, NULL) == SUCCESS);
+	start = Host_Cycles();
+	while ((sspDone == 0) && (Host_Cycles() - start < 1000000)) {
+		Host_Tick(64);
+	}
+	CHECK((sspDone == 1) && (sspDmaResult == SUCCESS));
+	CHECK(memcmp(tx, rx, sizeof(tx)) == 0);
+	CHECK((LPC_GPDMA->ENBLDCHNS == 0) && (LPC_SSP1->DMACR == 0));
+	CHECK((LPC_SSP1->SR & SSP_STAT_TFE) && !(LPC_SSP1->SR & SSP_STAT_RNE));
+	CHECK(!(LPC_SSP1->RIS & SSP_RORRIS));
+
+	/* Transmit only, 16-bit frames: the receive side drains into the sink */
+	LPC_SSP1->CR0 = (LPC_SSP1->CR0 & ~0xF) | SSP_BITS_16;
+	for (i = 0; i < 20; i++) {
+		tx16[i] = (uint16_t) (0x8001 + i);
+	}
+	sspDone = 0;
+	CHECK(Chip_SSP_DMA_Transfer(LPC_SSP1, tx16, NULL, 20, SSP_DmaDone, NULL) == SUCCESS);
+	start = Host_Cycles();
+	while ((sspDone == 0) && (Host_Cycles() - start < 1000000)) {
+		Host_Tick(64);
+	}
+	CHECK((sspDone == 1) && (sspDmaResult == SUCCESS));
+	CHECK(LPC_GPDMA->ENBLDCHNS == 0);
+}
+
+/* SSP DMA transfers refuse bad requests, abort quietly and receive only */
+static void Test_SSP_DMAReceive(void)
+{
+	static uint8_t rx[40];
+	uint64_t start;
+
+	Host_ResetPeriphRegs();
+	Chip_GPDMA_Init(LPC_GPDMA);
+	Chip_SSP_Init(LPC_SSP0);
+	Chip_SSP_EnableLoopBack(LPC_SSP0);
+	Chip_SSP_Enable(LPC_SSP0);
+	NVIC_EnableIRQ(DMA_IRQn);
+	sspDone = 0;
+
+	CHECK(Chip_SSP_DMA_Transfer(LPC_SSP0, NULL, rx, 0, SSP_DmaDone, NULL) == ERROR);
+	CHECK(Chip_SSP_DMA_Transfer(LPC_SSP0, NULL, rx, SSP_DMA_MAXLEN + 1, SSP_DmaDone, NULL) == ERROR);
+
+	/* An aborted transfer frees its channels and never calls back */
+	CHECK(Chip_SSP_DMA_Transfer(LPC_SSP0, NULL, rx, sizeof(rx), SSP_DmaDone, NULL) == SUCCESS);
+	CHECK(Chip_SSP_DMA_Transfer(LPC_SSP0, NULL, rx, sizeof(rx), SSP_DmaDone, NULL) == ERROR);
+	Chip_SSP_DMA_Abort(LPC_SSP0);
+	CHECK(LPC_SSP0->DMACR == 0);
+	Host_Tick(2000);
+	CHECK((sspDone == 0) && (LPC_GPDMA->ENBLDCHNS == 0));
+
+	/* Receive only sends all ones, which come back in loop back mode */
+	memset(rx, 0, sizeof(rx));
+	CHECK(Chip_SSP_DMA_Transfer(LPC_SSP0, NULL, rx, sizeof(rx), SSP_DmaDone, NULL) == SUCCESS);
+	start = Host_Cycles();
+	while ((sspDone == 0) && (Host_Cycles() - start < 1000000)) {
+		Host_Tick(64);
+	}
+	CHECK((sspDone == 1) && (sspDmaResult == SUCCESS));
+	CHECK((rx[0] == 0xFF) && (rx[sizeof(rx) - 1] == 0xFF));
+	CHECK(Chip_DMA_AllocChannel(LPC_GPDMA, GPDMA_PRIO_HIGH) == 0);
+}
+
+/* Queued I2C transactions time out in interrupt mode and can be aborted */
+static void Test_I2C_QueueAbort(void)
+{
+	static I2C_XFER_T xfer[3];
+	static uint8_t data[2];
+	int i;
+
+	Host_ResetPeriphRegs();
+	Chip_I2C_Init(LPC_I2C0);
+	i2cFailed = 0;
+
+	for (i = 0; i < 3; i++) {
+		memset(&xfer[i], 0, sizeof(xfer[i]));
+		xfer[i].slaveAddr = 0x50;
+		xfer[i].tx_data = data;
+		xfer[i].tx_length = sizeof(data);
+		xfer[i].callback = I2C_XferDone;
+		xfer[i].timeout = 10;
+		CHECK(Chip_I2C_Queue_Submit(LPC_I2C0, &xfer[i]) == SUCCESS);
+	}
+
+	/* No interrupt ever comes, the first transaction times out */
+	Chip_I2C_Queue_CheckTimeout(LPC_I2C0, 100);
+	Chip_I2C_Queue_CheckTimeout(LPC_I2C0, 109);
+	CHECK(i2cFailed == 0);
+	Chip_I2C_Queue_CheckTimeout(LPC_I2C0, 110);
+	CHECK(i2cFailed == 1);
+	CHECK(Chip_I2C_Queue_Busy(LPC_I2C0));
+
+	CHECK(Chip_I2C_Queue_Abort(LPC_I2C0) == SUCCESS);
+	CHECK(i2cFailed == 3);
+	CHECK(!Chip_I2C_Queue_Busy(LPC_I2C0));
+	CHECK(xfer[1].next == NULL);
+
+	/* A callback resubmitting its transaction leaves the rest of the
+	   aborted list alone */
+	i2cFailed = 0;
+	xfer[0].callback = I2C_XferRetry;
+	for (i = 0; i < 3; i++) {
+		CHECK(Chip_I2C_Queue_Submit(LPC_I2C0, &xfer[i]) == SUCCESS);
+	}
+	CHECK(Chip_I2C_Queue_Abort(LPC_I2C0) == SUCCESS);
+	CHECK(i2cFailed == 3);
+	CHECK(Chip_I2C_Queue_Busy(LPC_I2C0));
+	CHECK(Chip_I2C_Queue_Abort(LPC_I2C0) == SUCCESS);
+	CHECK(i2cFailed == 4);
+	CHECK(!Chip_I2C_Queue_Busy(LPC_I2C0));
+}
+
+/* Play one master status event to the interrupt handler */
+static void I2C_MasterEvent(uint32_t stat, uint8_t data)
+{
+	*(volatile uint32_t *) &LPC_I2C0->STAT = stat;
+	LPC_I2C0->DAT = data;
+	LPC_I2C0->CONSET = 0;
+	Chip_I2C_Interrupt_MasterHandler(LPC_I2C0);
+}
+
+/* A finished transaction chains the next one with STOP and START together */
+static void Test_I2C_QueueChain(void)
+{
+	static const uint8_t wr[2] = {0x12, 0x34}, reg = 0x07;
+	static I2C_XFER_T xa, xb;
+	static uint8_t rd[2];
+
+	Host_ResetPeriphRegs();
+	Chip_I2C_Init(LPC_I2C0);
+	i2cFailed = i2cDone = 0;
+	memset(&xa, 0, sizeof(xa));
+	xa.slaveAddr = 0x50;
+	xa.tx_data = wr;
+	xa.tx_length = sizeof(wr);
+	xa.callback = I2C_XferDone;
+	xb = xa;
+	xb.slaveAddr = 0x51;
+	xb.tx_data = &reg;
+	xb.tx_length = 1;
+	xb.rx_data = rd;
+	xb.rx_length = sizeof(rd);
+
+	CHECK(Chip_I2C_Queue_Submit(LPC_I2C0, &xa) == SUCCESS);
+	CHECK(LPC_I2C0->CONSET == I2C_I2CONSET_STA);
+	LPC_I2C0->CONSET = 0;
+	CHECK(Chip_I2C_Queue_Submit(LPC_I2C0, &xb) == SUCCESS);
+	CHECK(LPC_I2C0->CONSET == 0);
+
+	I2C_MasterEvent(I2C_I2STAT_M_TX_START, 0);
+	CHECK(LPC_I2C0->DAT == 0xA0);
+	I2C_MasterEvent(I2C_I2STAT_M_TX_SLAW_ACK, 0);
+	CHECK(LPC_I2C0->DAT == 0x12);
+	I2C_MasterEvent(I2C_I2STAT_M_TX_DAT_ACK, 0);
+	CHECK(LPC_I2C0->DAT == 0x34);
+	I2C_MasterEvent(I2C_I2STAT_M_TX_DAT_ACK, 0);
+	CHECK(LPC_I2C0->CONSET == (I2C_I2CONSET_STO | I2C_I2CONSET_STA));
+	CHECK((i2cDone == 1) && (xa.tx_count == 2) && (xa.next == NULL));
+
+	/* Register read: write the index, repeated start, read two bytes */
+	I2C_MasterEvent(I2C_I2STAT_M_TX_START, 0);
+	CHECK(LPC_I2C0->DAT == 0xA2);
+	I2C_MasterEvent(I2C_I2STAT_M_TX_SLAW_ACK, 0);
+	CHECK(LPC_I2C0->DAT == 0x07);
+	I2C_MasterEvent(I2C_I2STAT_M_TX_DAT_ACK, 0);
+	CHECK(LPC_I2C0->CONSET == I2C_I2CONSET_STA);
+	I2C_MasterEvent(I2C_I2STAT_M_RX_RESTART, 0);
+	CHECK(LPC_I2C0->DAT == 0xA3);
+	I2C_MasterEvent(I2C_I2STAT_M_RX_SLAR_ACK, 0);
+	CHECK(LPC_I2C0->CONSET == I2C_I2CONSET_AA);
+	I2C_MasterEvent(I2C_I2STAT_M_RX_DAT_ACK, 0x5A);
+	CHECK(LPC_I2C0->CONCLR == I2C_I2CONCLR_SIC);
+	I2C_MasterEvent(I2C_I2STAT_M_RX_DAT_NACK, 0xA5);
+	CHECK(LPC_I2C0->CONSET == I2C_I2CONSET_STO);
+	CHECK((i2cDone == 2) && (i2cFailed == 0));
+	CHECK((rd[0] == 0x5A) && (rd[1] == 0xA5) && (xb.rx_count == 2));
+	CHECK(!Chip_I2C_Queue_Busy(LPC_I2C0));
+}
+
+/* Play one master status event to Chip_I2C_Queue_Step() */
+static bool I2C_StepEvent(uint32_t stat, uint32_t now)
+{
+	*(volatile uint32_t *) &LPC_I2C0->STAT = stat;
+	LPC_I2C0->CONSET = I2C_I2CONSET_SI;
+	return Chip_I2C_Queue_Step(LPC_I2C0, now);
+}
+
+/* Stepping runs the queue without the interrupt and expires stuck transactions */
+static void Test_I2C_QueueStep(void)
+{
+	static const uint8_t wr = 0x5C;
+	static I2C_XFER_T xa, xb;
+
+	Host_ResetPeriphRegs();
+	Chip_I2C_Init(LPC_I2C0);
+	i2cFailed = i2cDone = 0;
+	CHECK(!Chip_I2C_Queue_Step(LPC_I2C0, 0));
+
+	memset(&xa, 0, sizeof(xa));
+	xa.slaveAddr = 0x20;
+	xa.tx_data = &wr;
+	xa.tx_length = 1;
+	xa.callback = I2C_XferDone;
+	xa.timeout = 5;
+	xb = xa;
+	xb.slaveAddr = 0x21;
+	CHECK(Chip_I2C_Queue_Submit(LPC_I2C0, &xa) == SUCCESS);
+	CHECK(Chip_I2C_Queue_Submit(LPC_I2C0, &xb) == SUCCESS);
+
+	/* Without SI a step only starts the clock on the transaction */
+	LPC_I2C0->CONSET = 0;
+	CHECK(Chip_I2C_Queue_Step(LPC_I2C0, 100));
+	CHECK(LPC_I2C0->DAT == 0);
+	CHECK(I2C_StepEvent(I2C_I2STAT_M_TX_START, 101));
+	CHECK(LPC_I2C0->DAT == 0x40);
+
+	/* The slave stops answering: the transaction expires and the next starts */
+	LPC_I2C0->CONSET = 0;
+	CHECK(Chip_I2C_Queue_Step(LPC_I2C0, 104));
+	CHECK(i2cFailed == 0);
+	CHECK(Chip_I2C_Queue_Step(LPC_I2C0, 105));
+	CHECK((i2cFailed == 1) && (xa.status == I2C_I2STAT_M_TX_START));
+	CHECK(LPC_I2C0->CONSET == I2C_I2CONSET_STA);
+
+	CHECK(I2C_StepEvent(I2C_I2STAT_M_TX_START, 106));
+	CHECK(LPC_I2C0->DAT == 0x42);
+	CHECK(I2C_StepEvent(I2C_I2STAT_M_TX_SLAW_ACK, 107));
+	CHECK(LPC_I2C0->DAT == 0x5C);
+	CHECK(!I2C_StepEvent(I2C_I2STAT_M_TX_DAT_ACK, 108));
+	CHECK(LPC_I2C0->CONSET == I2C_I2CONSET_STO);
+	CHECK((i2cDone == 1) && (i2cFailed == 1));
+}
+
+/* A poll plan read that never completes fails after the plan timeout */
+static void Test_I2C_PollTimeout(void)
+{
+	static I2C_POLL_PLAN_T plan;
+	I2C_POLL_T poll;
+	uint8_t out[2];
+
+	Host_ResetPeriphRegs();
+	Chip_I2C_Init(LPC_I2C0);
+	memset(&plan, 0, sizeof(plan));
+	plan.slaveAddr = 0x48;
+	plan.length = 2;
+	plan.period = 100;
+	plan.timeout = 5;
+	Chip_I2C_Poll_Init(&poll, LPC_I2C0);
+	CHECK(Chip_I2C_Poll_AddPlan(&poll, &plan, 0) == SUCCESS);
+
+	CHECK(Chip_I2C_Poll_Run(&poll, 0) == 1);
+	Chip_I2C_Queue_CheckTimeout(LPC_I2C0, 0);
+	Chip_I2C_Queue_CheckTimeout(LPC_I2C0, 5);
+	CHECK(plan.errors == 1);
+	CHECK(!plan.busy);
+	CHECK(Chip_I2C_Poll_Read(&plan, out, NULL) == 0);
+}
+
+/* Play one slave receive event to the slave handler */
+static void I2C_SlaveRx(uint32_t stat, uint8_t data)
+{
+	*(volatile uint32_t *) &LPC_I2C0->STAT = stat;
+	LPC_I2C0->DAT = data;
+	Chip_I2C_Interrupt_SlaveHandler(LPC_I2C0);
+}
+
+/* Slave register files need a size and ignore general calls */
+static void Test_I2C_SlaveRegs(void)
+{
+	static uint8_t regs[4];
+	static I2C_SLAVE_REGS_T file;
+
+	Host_ResetPeriphRegs();
+	Chip_I2C_Init(LPC_I2C0);
+	memset(regs, 0, sizeof(regs));
+	memset(&file, 0, sizeof(file));
+	file.regs = regs;
+	CHECK(Chip_I2C_SlaveRegs_Attach(LPC_I2C0, &file) == ERROR);
+	file.size = sizeof(regs);
+	CHECK(Chip_I2C_SlaveRegs_Attach(LPC_I2C0, &file) == SUCCESS);
+
+	I2C_SlaveRx(I2C_I2STAT_S_RX_GENCALL_ACK, 0);
+	I2C_SlaveRx(I2C_I2STAT_S_RX_PRE_GENCALL_DAT_ACK, 2);
+	I2C_SlaveRx(I2C_I2STAT_S_RX_PRE_GENCALL_DAT_ACK, 0x55);
+	CHECK((regs[0] | regs[1] | regs[2] | regs[3]) == 0);
+	CHECK(file.ptr == 0);
+
+	I2C_SlaveRx(I2C_I2STAT_S_RX_SLAW_ACK, 0);
+	I2C_SlaveRx(I2C_I2STAT_S_RX_PRE_SLA_DAT_ACK, 2);
+	I2C_SlaveRx(I2C_I2STAT_S_RX_PRE_SLA_DAT_ACK, 0x55);
+	CHECK(regs[2] == 0x55);
+
+	CHECK(Chip_I2C_SlaveRegs_Attach(LPC_I2C0, NULL) == SUCCESS);
+}
+
+/* Transfers beyond the descriptors are split, a pool makes them one command */
+static void Test_SDMMC_Split(void)
+{
+	static mci_card_struct card;
+	static pSDMMC_DMA_T pool[80];
+	static uint8_t buf[300 * MMC_SECTOR_SIZE];
+	struct itimerval tick = {{0, 50}, {0, 50}};
+
+	Host_ResetPeriphRegs();
+	memset(&card, 0, sizeof(card));
+	card.evsetup_cb = SD_EventSetup;
+	card.waitfunc_cb = SD_CardWait;
+	card.msdelay_func = SD_Delay;
+	signal(SIGALRM, SD_Controller);
+	setitimer(ITIMER_REAL, &tick, NULL);
+
+	Chip_SDMMC_Init(LPC_SDMMC);
+	CHECK(Chip_SDMMC_Acquire(LPC_SDMMC, &card) != 0);
+	CHECK(Chip_SDMMC_GetDeviceBlocks(LPC_SDMMC) == 1024);
+
+	/* Out of range: rejected before any command */
+	sdDataCmds = 0;
+	CHECK(Chip_SDMMC_ReadBlocks(LPC_SDMMC, buf, 900, 300) == 0);
+	CHECK(sdDataCmds == 0);
+
+	/* Built-in descriptors cover 64K, 128 blocks */
+	CHECK(Chip_SDMMC_ReadBlocks(LPC_SDMMC, buf, 10, 300) == sizeof(buf));
+	CHECK(sdDataCmds == 3);
+	CHECK(sdData[0][0] == MMC_READ_MULTIPLE_BLOCK && sdData[0][1] == 10 && sdData[0][2] == 0x10000);
+	CHECK(sdData[1][0] == MMC_READ_MULTIPLE_BLOCK && sdData[1][1] == 138 && sdData[1][2] == 0x10000);
+	CHECK(sdData[2][0] == MMC_READ_MULTIPLE_BLOCK && sdData[2][1] == 266 && sdData[2][2] == 44 * MMC_SECTOR_SIZE);
+
+	/* A pool for the whole buffer: one multiple block write */
+	sdDataCmds = 0;
+	Chip_SDMMC_SetDmaPool(LPC_SDMMC, pool, 80);
+	CHECK(Chip_SDMMC_WriteBlocks(LPC_SDMMC, buf, 724, 300) == sizeof(buf));
+	CHECK(sdDataCmds == 1);
+	CHECK(sdData[0][0] == MMC_WRITE_MULTIPLE_BLOCK && sdData[0][1] == 724 && sdData[0][2] == sizeof(buf));
+	CHECK(LPC_SDMMC->DBADDR == (uint32_t) (uintptr_t) &pool[0]);
+	CHECK((pool[37].des0 & MCI_DMADES0_LD) != 0);
+	CHECK(pool[37].des2 == (uint32_t) (uintptr_t) &buf[37 * MCI_DMADES1_MAXTR]);
+
+	Chip_SDMMC_SetDmaPool(LPC_SDMMC, NULL, 0);
+	memset(&tick, 0, sizeof(tick));
+	setitimer(ITIMER_REAL, &tick, NULL);
+	signal(SIGALRM, SIG_DFL);
+}
+
+/*****************************************************************************
+ * Public functions
+ ****************************************************************************/
+
+int main(void)
+{
+	Test_RingBuffer();
+	Test_RingBufferSegments();
+	Test_RingBufferSpans();
+	Test_RingBufferOverwrite();
+	Test_CorePeripherals();
+	Test_GPDMA_SGTransfer();
+	Test_GPDMA_ChainSplit();
+	Test_GPDMA_Prepared();
+	Test_GPDMA_VChannels();
+	Test_GPDMA_BlitFillNarrow();
+	Test_GPDMA_HandOver();
+	Test_GPDMA_Stream();
+	Test_GPDMA_MemCalibrate();
+	Test_GPDMA_MemDone();
+	Test_UART_RxDMA();
+	Test_SSP_BusWait();
+	Test_SSP_ClockProfile();
+	Test_SSP_Batching();
+	Test_SSP_RWResume();
+	Test_SSP_DMALoopback();
+	Test_SSP_DMAReceive();
+	Test_I2C_QueueAbort();
+	Test_I2C_QueueChain();
+	Test_I2C_QueueStep();
+	Test_I2C_PollTimeout();
+	Test_I2C_SlaveRegs();
+	Test_SDMMC_Split();
+
+	printf("host tests: %d failure(s)\n", failures);
+	return (failures == 0) ? 0 : 1;
+}